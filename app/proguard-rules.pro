@@ -24,3 +24,35 @@
 -keep class com.raylib.raymob.NativeLoader {
     public <methods>;
 }
+
+# Keep the NativeLoader members raymob reaches through JNI.
+-keepclassmembers class com.raylib.raymob.NativeLoader {
+    public com.raylib.raymob.SoftKeyboard softKeyboard;
+    public com.raylib.raymob.DisplayManager displayManager;
+    public boolean initCallback;
+    public boolean nativeBridge;
+    native <methods>;
+}
+
+# Keep the names of the classes in the signatures of the fields above.
+-keepnames class com.raylib.raymob.SoftKeyboard
+-keepnames class com.raylib.raymob.DisplayManager
+
+# Keep the string resource IDs, raymob enumerates them to build its L10N table.
+-keepclassmembers class com.raylib.raymob.R$string {
+    public static <fields>;
+}
+
+# Keep the soft keyboard members raymob reaches through JNI.
+-keepclassmembers class com.raylib.raymob.SoftKeyboard {
+    public <methods>;
+    public boolean nativeQueue;
+    native <methods>;
+}
+
+# Keep the display manager members raymob reaches through JNI.
+-keepclassmembers class com.raylib.raymob.DisplayManager {
+    public <methods>;
+    public boolean nativeDisplay;
+    native <methods>;
+}
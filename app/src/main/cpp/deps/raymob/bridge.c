@@ -0,0 +1,284 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "bridge.h"
+#include <pthread.h>
+
+/* Static variables */
+
+// NOTE: The bridge is rebuilt when the activity is recreated, into the other slot,
+//       since a thread may still be reading the current one at that time
+static RaymobBridge bridges[2] = { 0 };
+static RaymobBridge *current = NULL;    // Atomic, only set once everything is resolved
+static pthread_mutex_t bridgeMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const JNINativeMethod nativeLoaderMethods[] = {
+    { "onLocaleChanged", "()V", (void *)OnLocaleChanged },
+};
+
+static const JNINativeMethod displayManagerMethods[] = {
+    { "onDisplayState", "(IFIIIIIIIII)V", (void *)OnDisplayState },
+};
+
+static const JNINativeMethod softKeyboardMethods[] = {
+    { "onKeyEvent", "(IICJ)V", (void *)OnSoftKeyEvent },
+    { "onTextInput", "([B[B)V", (void *)OnSoftTextInput },
+};
+
+/* Internal functions */
+
+static void ClearPendingException(JNIEnv *env)
+{
+    // NOTE: A failed lookup leaves a pending exception (e.g. NoClassDefFoundError),
+    //       which must be cleared before making any other JNI call
+    if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+}
+
+static jobject NewGlobalFromLocal(JNIEnv *env, jobject local)
+{
+    if (local == NULL) return NULL;
+
+    jobject global = (*env)->NewGlobalRef(env, local);
+    (*env)->DeleteLocalRef(env, local);
+
+    return global;
+}
+
+static jclass FindGlobalClass(JNIEnv *env, const char *name)
+{
+    jclass localClass = (*env)->FindClass(env, name);
+    ClearPendingException(env);
+
+    return (jclass)NewGlobalFromLocal(env, localClass);
+}
+
+static jmethodID FindMethod(JNIEnv *env, jclass clazz, const char *name, const char *sig)
+{
+    if (clazz == NULL) return NULL;
+
+    jmethodID method = (*env)->GetMethodID(env, clazz, name, sig);
+    ClearPendingException(env);
+
+    if (method == NULL) TraceLog(LOG_WARNING, "RAYMOB: Java method not found: %s%s", name, sig);
+
+    return method;
+}
+
+static jfieldID FindField(JNIEnv *env, jclass clazz, const char *name, const char *sig)
+{
+    if (clazz == NULL) return NULL;
+
+    jfieldID field = (*env)->GetFieldID(env, clazz, name, sig);
+    ClearPendingException(env);
+
+    if (field == NULL) TraceLog(LOG_WARNING, "RAYMOB: Java field not found: %s", name);
+
+    return field;
+}
+
+static void RegisterNativeMethods(JNIEnv *env, jclass clazz, const JNINativeMethod *methods, int count,
+                                  jobject instance, jfieldID readyField)
+{
+    if (clazz == NULL) return;
+
+    // NOTE: Java only calls the natives once told they are registered
+    if ((*env)->RegisterNatives(env, clazz, methods, count) == JNI_OK) {
+        if (readyField != NULL) (*env)->SetBooleanField(env, instance, readyField, JNI_TRUE);
+    }
+    else {
+        ClearPendingException(env);
+        TraceLog(LOG_WARNING, "RAYMOB: Failed to register native method: %s", methods[0].name);
+    }
+}
+
+// Resolves the classes and IDs, they stay valid for the whole lifetime of the process
+static void InitBridgeClasses(JNIEnv *env, RaymobBridge *bridge, jobject nativeLoader)
+{
+    // NativeLoader
+
+    bridge->nativeLoaderClass = (jclass)NewGlobalFromLocal(env, (*env)->GetObjectClass(env, nativeLoader));
+
+    bridge->softKeyboardField = FindField(env, bridge->nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
+    bridge->displayManagerField = FindField(env, bridge->nativeLoaderClass, "displayManager", "Lcom/raylib/raymob/DisplayManager;");
+    bridge->initCallbackField = FindField(env, bridge->nativeLoaderClass, "initCallback", "Z");
+    bridge->nativeBridgeField = FindField(env, bridge->nativeLoaderClass, "nativeBridge", "Z");
+
+    bridge->getSystemService = FindMethod(env, bridge->nativeLoaderClass, "getSystemService", "(Ljava/lang/String;)Ljava/lang/Object;");
+    bridge->getCacheDir = FindMethod(env, bridge->nativeLoaderClass, "getCacheDir", "()Ljava/io/File;");
+    bridge->getExternalFilesDir = FindMethod(env, bridge->nativeLoaderClass, "getExternalFilesDir", "(Ljava/lang/String;)Ljava/io/File;");
+    bridge->getPackedStrings = FindMethod(env, bridge->nativeLoaderClass, "getPackedStrings", "()[B");
+
+    // SoftKeyboard and DisplayManager (NOTE: Found through the field types, their
+    // class loader is the one of the activity, FindClass() would not see them)
+
+    if (bridge->softKeyboardField != NULL) {
+        jobject softKeyboard = (*env)->GetObjectField(env, nativeLoader, bridge->softKeyboardField);
+
+        if (softKeyboard != NULL) {
+            bridge->softKeyboardClass = (jclass)NewGlobalFromLocal(env, (*env)->GetObjectClass(env, softKeyboard));
+            (*env)->DeleteLocalRef(env, softKeyboard);
+        }
+    }
+
+    bridge->showKeyboard = FindMethod(env, bridge->softKeyboardClass, "showKeyboard", "()V");
+    bridge->hideKeyboard = FindMethod(env, bridge->softKeyboardClass, "hideKeyboard", "()V");
+    bridge->setTextInput = FindMethod(env, bridge->softKeyboardClass, "setTextInput", "(Z)V");
+    bridge->nativeQueueField = FindField(env, bridge->softKeyboardClass, "nativeQueue", "Z");
+
+    if (bridge->displayManagerField != NULL) {
+        jobject displayManager = (*env)->GetObjectField(env, nativeLoader, bridge->displayManagerField);
+
+        if (displayManager != NULL) {
+            bridge->displayManagerClass = (jclass)NewGlobalFromLocal(env, (*env)->GetObjectClass(env, displayManager));
+            (*env)->DeleteLocalRef(env, displayManager);
+        }
+    }
+
+    bridge->keepScreenOn = FindMethod(env, bridge->displayManagerClass, "keepScreenOn", "(Z)V");
+    bridge->getOrientation = FindMethod(env, bridge->displayManagerClass, "getOrientation", "()I");
+    bridge->startDisplayListening = FindMethod(env, bridge->displayManagerClass, "startListening", "()V");
+    bridge->getSupportedRefreshRates = FindMethod(env, bridge->displayManagerClass, "getSupportedRefreshRates", "()[F");
+    bridge->nativeDisplayField = FindField(env, bridge->displayManagerClass, "nativeDisplay", "Z");
+
+    // java.io.File
+
+    bridge->fileClass = FindGlobalClass(env, "java/io/File");
+    bridge->getPath = FindMethod(env, bridge->fileClass, "getPath", "()Ljava/lang/String;");
+    bridge->getAbsolutePath = FindMethod(env, bridge->fileClass, "getAbsolutePath", "()Ljava/lang/String;");
+
+    // Vibrator
+
+    bridge->vibratorService = (jstring)NewGlobalFromLocal(env, (*env)->NewStringUTF(env, "vibrator"));
+
+    bridge->vibratorClass = FindGlobalClass(env, "android/os/Vibrator");
+    bridge->hasVibrator = FindMethod(env, bridge->vibratorClass, "hasVibrator", "()Z");
+    bridge->vibrate = FindMethod(env, bridge->vibratorClass, "vibrate", "(J)V");
+    bridge->cancelVibration = FindMethod(env, bridge->vibratorClass, "cancel", "()V");
+    bridge->vibratePattern = FindMethod(env, bridge->vibratorClass, "vibrate", "([JI)V");
+
+    // NOTE: VibrationEffect only exists since API 26, the lookup is allowed to fail
+    bridge->vibrationEffectClass = FindGlobalClass(env, "android/os/VibrationEffect");
+
+    if (bridge->vibrationEffectClass != NULL) {
+        bridge->createOneShot = (*env)->GetStaticMethodID(env, bridge->vibrationEffectClass, "createOneShot", "(JI)Landroid/os/VibrationEffect;");
+        ClearPendingException(env);
+        bridge->vibrateEffect = FindMethod(env, bridge->vibratorClass, "vibrate", "(Landroid/os/VibrationEffect;)V");
+        bridge->createWaveform = (*env)->GetStaticMethodID(env, bridge->vibrationEffectClass, "createWaveform", "([J[II)Landroid/os/VibrationEffect;");
+        ClearPendingException(env);
+
+        // NOTE: Predefined effects only exist since API 29
+        bridge->createPredefined = (*env)->GetStaticMethodID(env, bridge->vibrationEffectClass, "createPredefined", "(I)Landroid/os/VibrationEffect;");
+        ClearPendingException(env);
+    }
+}
+
+// Gets the objects of an activity, and tells them the natives are registered
+static void InitBridgeInstances(JNIEnv *env, RaymobBridge *bridge, jobject nativeLoader)
+{
+    // NOTE: activity->clazz is already a global reference, owned by the activity
+    bridge->nativeLoader = nativeLoader;
+
+    RegisterNativeMethods(env, bridge->nativeLoaderClass, nativeLoaderMethods,
+                          sizeof(nativeLoaderMethods)/sizeof(nativeLoaderMethods[0]), nativeLoader, bridge->nativeBridgeField);
+
+    if (bridge->softKeyboardField != NULL) {
+        bridge->softKeyboard = NewGlobalFromLocal(env, (*env)->GetObjectField(env, nativeLoader, bridge->softKeyboardField));
+    }
+
+    if (bridge->softKeyboard != NULL) {
+        RegisterNativeMethods(env, bridge->softKeyboardClass, softKeyboardMethods,
+                              sizeof(softKeyboardMethods)/sizeof(softKeyboardMethods[0]), bridge->softKeyboard, bridge->nativeQueueField);
+    }
+
+    if (bridge->displayManagerField != NULL) {
+        bridge->displayManager = NewGlobalFromLocal(env, (*env)->GetObjectField(env, nativeLoader, bridge->displayManagerField));
+    }
+
+    if (bridge->displayManager != NULL) {
+        RegisterNativeMethods(env, bridge->displayManagerClass, displayManagerMethods,
+                              sizeof(displayManagerMethods)/sizeof(displayManagerMethods[0]), bridge->displayManager, bridge->nativeDisplayField);
+    }
+}
+
+static void ReleaseBridgeInstances(JNIEnv *env, RaymobBridge *bridge)
+{
+    if (bridge->softKeyboard != NULL) (*env)->DeleteGlobalRef(env, bridge->softKeyboard);
+    if (bridge->displayManager != NULL) (*env)->DeleteGlobalRef(env, bridge->displayManager);
+
+    bridge->nativeLoader = NULL;
+    bridge->softKeyboard = NULL;
+    bridge->displayManager = NULL;
+}
+
+// Must be called with the bridge mutex locked
+static RaymobBridge *BuildBridge(jobject nativeLoader)
+{
+    JNIEnv *env = GetThreadJNIEnv();
+
+    RaymobBridge *previous = current;
+    RaymobBridge *bridge = (previous == &bridges[0]) ? &bridges[1] : &bridges[0];
+
+    if (previous == NULL) {
+        InitBridgeClasses(env, bridge, nativeLoader);
+    } else {
+        // NOTE: The slot holds the bridge of the activity before the previous one,
+        //       which nothing reads anymore, classes and IDs are kept as they are
+        ReleaseBridgeInstances(env, bridge);
+        *bridge = *previous;
+        bridge->softKeyboard = NULL;
+        bridge->displayManager = NULL;
+        bridge->generation++;
+
+        TraceLog(LOG_INFO, "RAYMOB: Activity recreated, bridge rebuilt");
+    }
+
+    InitBridgeInstances(env, bridge, nativeLoader);
+
+    __atomic_store_n(&current, bridge, __ATOMIC_RELEASE);
+
+    return bridge;
+}
+
+/* Functions definition */
+
+const RaymobBridge *GetBridge(void)
+{
+    // NOTE: Nothing is resolved until the native loader exists, the next call tries again
+    jobject nativeLoader = GetNativeLoaderInstance();
+    if (nativeLoader == NULL) return NULL;
+
+    // The objects of a destroyed activity must not be used, the bridge
+    // is rebuilt as soon as the activity is not the same anymore
+    RaymobBridge *bridge = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+    if (bridge != NULL && bridge->nativeLoader == nativeLoader) return bridge;
+
+    pthread_mutex_lock(&bridgeMutex);
+
+    bridge = current;
+    if (bridge == NULL || bridge->nativeLoader != nativeLoader) bridge = BuildBridge(nativeLoader);
+
+    pthread_mutex_unlock(&bridgeMutex);
+
+    return bridge;
+}
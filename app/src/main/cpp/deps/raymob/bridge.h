@@ -0,0 +1,142 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef RAYMOB_BRIDGE_H
+#define RAYMOB_BRIDGE_H
+
+#include "raymob.h"
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * The bridge holds every Java class, field and method ID used by raymob.
+ * Everything is resolved once, the first time GetBridge() is called, so that
+ * the public functions only pay for the actual Java call.
+ *
+ * NOTE: jclass members are global references valid for the whole lifetime of
+ *       the process. The objects (the activity, its SoftKeyboard and its
+ *       DisplayManager) are those of the current activity, the bridge is
+ *       rebuilt when the activity is recreated, so never keep the pointer,
+ *       call GetBridge() again instead.
+ */
+
+typedef struct RaymobBridge {
+
+    unsigned int generation;    // Incremented each time the bridge is rebuilt for a new activity
+
+    /* NativeLoader (the activity) */
+
+    jobject nativeLoader;
+    jclass nativeLoaderClass;
+
+    jfieldID softKeyboardField;
+    jfieldID displayManagerField;
+    jfieldID initCallbackField;
+    jfieldID nativeBridgeField;
+
+    jmethodID getSystemService;
+    jmethodID getCacheDir;
+    jmethodID getExternalFilesDir;
+    jmethodID getPackedStrings;
+
+    /* SoftKeyboard */
+
+    jobject softKeyboard;
+    jclass softKeyboardClass;
+
+    jmethodID showKeyboard;
+    jmethodID hideKeyboard;
+    jmethodID setTextInput;
+    jfieldID nativeQueueField;
+
+    /* DisplayManager */
+
+    jobject displayManager;
+    jclass displayManagerClass;
+
+    jmethodID keepScreenOn;
+    jmethodID getOrientation;
+    jmethodID startDisplayListening;
+    jmethodID getSupportedRefreshRates;
+    jfieldID nativeDisplayField;
+
+    /* java.io.File */
+
+    jclass fileClass;
+    jmethodID getPath;
+    jmethodID getAbsolutePath;
+
+    /* Vibrator */
+
+    jstring vibratorService;    // "vibrator", used with getSystemService()
+
+    jclass vibratorClass;
+    jmethodID hasVibrator;
+    jmethodID vibrate;
+    jmethodID vibrateEffect;
+    jmethodID cancelVibration;
+    jmethodID vibratePattern;
+
+    jclass vibrationEffectClass;    // NULL below API 26
+    jmethodID createOneShot;
+    jmethodID createWaveform;
+    jmethodID createPredefined;     // NULL below API 29
+
+} RaymobBridge;
+
+/**
+ * @brief Returns the bridge, resolving all classes and IDs on the first call.
+ *
+ * Thread safe, only the first successful call and the first call after the
+ * activity is recreated cross into Java.
+ *
+ * @return Pointer to the bridge, or NULL if the native loader is not available yet,
+ *         in which case the next call tries again.
+ */
+const RaymobBridge *GetBridge(void);
+
+/*
+ * Native methods registered by the bridge. Java only calls them once
+ * the matching flag has been set to true ('nativeBridge' for NativeLoader,
+ * 'nativeQueue' for SoftKeyboard, 'nativeDisplay' for DisplayManager).
+ */
+
+void JNICALL OnLocaleChanged(JNIEnv *env, jobject obj);     // l10n.c
+
+void JNICALL OnSoftKeyEvent(JNIEnv *env, jobject obj, jint keyCode, jint unicode, jchar label, jlong eventTime);  // soft_keyboard.c
+void JNICALL OnSoftTextInput(JNIEnv *env, jobject obj, jbyteArray committed, jbyteArray composing);          // soft_keyboard.c
+
+void JNICALL OnDisplayState(JNIEnv *env, jobject obj, jint rotation, jfloat refreshRate,
+                            jint safeLeft, jint safeTop, jint safeRight, jint safeBottom,
+                            jint cutoutLeft, jint cutoutTop, jint cutoutRight, jint cutoutBottom,
+                            jint imeHeight);    // display.c
+
+/*
+ * Window lifecycle, both run on the game thread.
+ */
+
+void HookAppCommands(void);     // callback.c, chains raylib's handler of the android_app commands
+void OnWindowInit(void);        // frame_rate.c, called once a new window is ready (e.g. on resume)
+
+#endif //RAYMOB_BRIDGE_H
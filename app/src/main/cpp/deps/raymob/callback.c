@@ -1,10 +1,33 @@
 #include "raymob.h"
+#include "bridge.h"
+
+#define JOURNAL_PAUSE_TIMEOUT   1.0f    // Seconds, well below the ANR delay of the UI thread
 
 static Callback onStart = NULL;
 static Callback onPause = NULL;
 static Callback onResume = NULL;
 static Callback onStop = NULL;
 
+static void (*nextOnAppCmd)(struct android_app *app, int32_t cmd) = NULL;
+
+static void OnAppCommand(struct android_app *app, int32_t cmd){
+    if(nextOnAppCmd) nextOnAppCmd(app, cmd);
+    // The window is recreated on every resume, the settings made on the previous one are lost
+    if(cmd == APP_CMD_INIT_WINDOW) OnWindowInit();
+    // The process may be killed at any time once paused, the UI thread is already released
+    // at this point, but the game thread must not block on disk for long either
+    if(cmd == APP_CMD_PAUSE) FlushStorageJournalTimeout(JOURNAL_PAUSE_TIMEOUT);
+}
+
+void HookAppCommands(void){
+    // NOTE: Called from the game thread, after raylib has installed its own command handler
+    struct android_app *app = GetAndroidApp();
+    if(app->onAppCmd != OnAppCommand){
+        nextOnAppCmd = app->onAppCmd;
+        app->onAppCmd = OnAppCommand;
+    }
+}
+
 void SetOnStartCallBack(Callback callback){
     onStart = callback;
 }
@@ -43,18 +66,12 @@ static JNINativeMethod methods[] = {
 };
 
 void InitCallBacks(){
-    jobject nativeLoaderInst = GetNativeLoaderInstance();
-
-    if (nativeLoaderInst != NULL) {
-        JNIEnv* env = AttachCurrentThread();
-
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, nativeLoaderInst);
-
-        (*env)->RegisterNatives(env, nativeLoaderClass, methods, sizeof(methods) / sizeof(methods[0]));
+    const RaymobBridge *bridge = GetBridge();
 
-        jfieldID fieldId = (*env)->GetFieldID(env, nativeLoaderClass, "initCallback", "Z");
-        (*env)->SetBooleanField(env, nativeLoaderInst, fieldId, JNI_TRUE);
+    if (bridge != NULL) {
+        JNIEnv* env = GetThreadJNIEnv();
 
-        DetachCurrentThread();
+        (*env)->RegisterNatives(env, bridge->nativeLoaderClass, methods, sizeof(methods) / sizeof(methods[0]));
+        (*env)->SetBooleanField(env, bridge->nativeLoader, bridge->initCallbackField, JNI_TRUE);
     }
 }
\ No newline at end of file
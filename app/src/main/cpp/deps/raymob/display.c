@@ -22,53 +22,148 @@
  *  SOFTWARE.
  */
 
+
 #include "raymob.h"
+#include "bridge.h"
+#include "seqlock.h"
 
-void KeepScreenOn(bool keepOn)
-{
-    jobject nativeLoaderInst = GetNativeLoaderInstance();
+#include <pthread.h>
+#include <string.h>
+
+/* DEFINES */
+
+#define DISPLAY_VALUE_COUNT     11
+
+/* GLOBAL VARIABLES */
 
-    if (nativeLoaderInst != NULL) {
-        JNIEnv* env = AttachCurrentThread();
+// NOTE: Written by the UI thread through OnDisplayState(), read by any thread.
+//       The sequence is odd while the values are written, and its half is the
+//       generation returned to the readers (0 until the first state is pushed).
+
+static struct {
+    uint32_t sequence;
+    int32_t orientation;                        // Also readable on its own, with one load
+    int32_t values[DISPLAY_VALUE_COUNT];        // Same order as the arguments of OnDisplayState()
+} State = { 0 };
+
+// NOTE: Bridge generation plus one the listener was started for, 0 if not started yet,
+//       a recreated activity has a new DisplayManager, which has to be started too
+static unsigned int listeningGeneration = 0;
+static pthread_mutex_t listeningMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* INTERNAL FUNCTIONS */
+
+static void StartDisplayState(void)
+{
+    // NOTE: Retried on the next call while the bridge is not ready
+    const RaymobBridge *bridge = GetBridge();
+    if (bridge == NULL || bridge->displayManager == NULL || bridge->startDisplayListening == NULL) return;
 
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, nativeLoaderInst);
-        jfieldID displayManagerField = (*env)->GetFieldID(env, nativeLoaderClass, "displayManager", "Lcom/raylib/raymob/DisplayManager;");
-        jobject displayManager = (*env)->GetObjectField(env, nativeLoaderInst, displayManagerField);
+    if (__atomic_load_n(&listeningGeneration, __ATOMIC_ACQUIRE) == bridge->generation + 1) return;
 
-        if (displayManager != NULL) {
-            jclass displayManagerClass = (*env)->GetObjectClass(env, displayManager);
-            jmethodID method = (*env)->GetMethodID(env, displayManagerClass, "keepScreenOn", "(Z)V");
-            (*env)->CallVoidMethod(env, displayManager, method, (jboolean)keepOn);
-        }
+    pthread_mutex_lock(&listeningMutex);
 
-        DetachCurrentThread();
+    if (__atomic_load_n(&listeningGeneration, __ATOMIC_RELAXED) != bridge->generation + 1) {
+        JNIEnv* env = GetThreadJNIEnv();
+        (*env)->CallVoidMethod(env, bridge->displayManager, bridge->startDisplayListening);
+        __atomic_store_n(&listeningGeneration, bridge->generation + 1, __ATOMIC_RELEASE);
     }
+
+    pthread_mutex_unlock(&listeningMutex);
 }
 
-Orientation GetScreenOrientation()
+static uint32_t GetDisplaySequence(void)
+{
+    StartDisplayState();
+    return __atomic_load_n(&State.sequence, __ATOMIC_ACQUIRE);
+}
+
+static Orientation ToOrientation(int rotation)
 {
-    Orientation result = 0;
-    jobject nativeLoaderInst = GetNativeLoaderInstance();
+    // NOTE: Just sanity checking in case android API changes
+    return (rotation >= 0 && rotation < 4) ? (Orientation)rotation : ORIENTATION_OTHER;
+}
+
+/* NATIVE METHODS */
+
+void JNICALL OnDisplayState(JNIEnv *env, jobject obj, jint rotation, jfloat refreshRate,
+                            jint safeLeft, jint safeTop, jint safeRight, jint safeBottom,
+                            jint cutoutLeft, jint cutoutTop, jint cutoutRight, jint cutoutBottom,
+                            jint imeHeight)
+{
+    int32_t values[DISPLAY_VALUE_COUNT] = {
+        rotation, 0, safeLeft, safeTop, safeRight, safeBottom,
+        cutoutLeft, cutoutTop, cutoutRight, cutoutBottom, imeHeight
+    };
+
+    memcpy(&values[1], &refreshRate, sizeof(float));
+
+    // NOTE: Single writer, the UI thread
+    uint32_t current = BeginSeqlockWrite(&State.sequence);
 
-    if (nativeLoaderInst != NULL) {
-        JNIEnv* env = AttachCurrentThread();
+    for (int i = 0; i < DISPLAY_VALUE_COUNT; i++) __atomic_store_n(&State.values[i], values[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&State.orientation, rotation, __ATOMIC_RELAXED);
 
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, nativeLoaderInst);
-        jfieldID displayManagerField = (*env)->GetFieldID(env, nativeLoaderClass, "displayManager", "Lcom/raylib/raymob/DisplayManager;");
-        jobject displayManager = (*env)->GetObjectField(env, nativeLoaderInst, displayManagerField);
+    EndSeqlockWrite(&State.sequence, current);
+}
+
+/* PUBLIC API */
+
+void KeepScreenOn(bool keepOn)
+{
+    const RaymobBridge *bridge = GetBridge();
 
-        if (displayManager != NULL) {
-            jclass displayManagerClass = (*env)->GetObjectClass(env, displayManager);
-            jmethodID screenOrientationMethod = (*env)->GetMethodID(env, displayManagerClass, "getOrientation", "()I");
-            jint screenOrientation = (*env)->CallIntMethod(env, displayManager, screenOrientationMethod);
+    if (bridge != NULL && bridge->displayManager != NULL) {
+        JNIEnv* env = GetThreadJNIEnv();
+        (*env)->CallVoidMethod(env, bridge->displayManager, bridge->keepScreenOn, (jboolean)keepOn);
+    }
+}
+
+Orientation GetScreenOrientation()
+{
+    // Pushed by DisplayManager.java on every change, no JNI call
+    if (GetDisplaySequence() != 0) {
+        return ToOrientation(__atomic_load_n(&State.orientation, __ATOMIC_RELAXED));
+    }
 
-            if (result >= 0 && result < 4) { // just sanity checking in case android API changes
-                result = screenOrientation;
-            }
-        }
+    // Fallback until the first state is pushed
+    Orientation result = ORIENTATION_OTHER;
+    const RaymobBridge *bridge = GetBridge();
 
-        DetachCurrentThread();
+    if (bridge != NULL && bridge->displayManager != NULL) {
+        JNIEnv* env = GetThreadJNIEnv();
+        jint screenOrientation = (*env)->CallIntMethod(env, bridge->displayManager, bridge->getOrientation);
+        result = ToOrientation(screenOrientation);
     }
 
     return result;
 }
+
+unsigned int GetDisplayStateGeneration(void)
+{
+    return GetDisplaySequence()/2;
+}
+
+DisplayState GetDisplayState(void)
+{
+    int32_t values[DISPLAY_VALUE_COUNT] = { 0 };
+    uint32_t current = GetDisplaySequence();
+
+    // NOTE: Never blocks, a retry only happens if a state is pushed during the copy
+    do {
+        current = BeginSeqlockRead(&State.sequence);
+
+        for (int i = 0; i < DISPLAY_VALUE_COUNT; i++) values[i] = __atomic_load_n(&State.values[i], __ATOMIC_RELAXED);
+    } while (!EndSeqlockRead(&State.sequence, current));
+
+    DisplayState state = { 0 };
+
+    state.orientation = (current != 0) ? ToOrientation(values[0]) : GetScreenOrientation();
+    memcpy(&state.refreshRate, &values[1], sizeof(float));
+    state.safeArea = (DisplayInsets){ values[2], values[3], values[4], values[5] };
+    state.cutout = (DisplayInsets){ values[6], values[7], values[8], values[9] };
+    state.imeHeight = values[10];
+    state.generation = current/2;
+
+    return state;
+}
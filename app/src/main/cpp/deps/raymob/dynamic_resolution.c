@@ -0,0 +1,182 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "raymob.h"
+#include "resolution_governor.h"
+
+#include "rlgl.h"
+
+/* DEFINES */
+
+// NOTE: Set from 'display.dynamic_resolution' and 'display.min_resolution_scale'
+//       in gradle.properties, the mode is then enabled without calling InitDynamicResolution()
+#ifndef RAYMOB_MIN_RESOLUTION_SCALE
+    #define RAYMOB_MIN_RESOLUTION_SCALE 0.5f
+#endif
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    bool enabled;
+    bool active;                // Between BeginDynamicResolution() and EndDynamicResolution()
+
+    Governor governor;
+    RenderTexture2D target;     // Screen size, the scene only covers its scaled part
+
+    int width;                  // Size of the scaled part for the current frame
+    int height;
+
+    double lastBegin;
+    bool frozenLogged;
+
+} State = { 0 };
+
+/* INTERNAL FUNCTIONS */
+
+static float GetFrameBudget(void)
+{
+    // NOTE: The pacer interval is the actual budget, otherwise assume 60 FPS
+    return IsFramePacerReady() ? GetFramePacerInterval() : 1.0f/60.0f;
+}
+
+static float MeasureFrameTime(void)
+{
+    // NOTE: Without the pacer, the sleep of SetTargetFPS() happens inside
+    //       EndDrawing() and cannot be told apart from work, the governor is
+    //       then frozen rather than driven down by the wait
+    if (!IsFramePacerReady()) {
+        if (!State.frozenLogged) TraceLog(LOG_INFO, "RAYMOB: Dynamic resolution frozen, the frame pacer is not running");
+        State.frozenLogged = true;
+        State.lastBegin = 0.0;
+        return 0.0f;
+    }
+
+    double now = GetTime();
+    float frameTime = 0.0f;
+
+    // Time between two frames, minus the time the pacer slept, so that only
+    // the work of the frame is measured (including swap back-pressure)
+    if (State.lastBegin > 0.0) {
+        frameTime = (float)(now - State.lastBegin) - GetFramePacerWaitTime();
+    }
+
+    State.lastBegin = now;
+
+    return frameTime;
+}
+
+static bool PrepareTarget(void)
+{
+    int screenWidth = GetScreenWidth();
+    int screenHeight = GetScreenHeight();
+
+    if (State.target.id != 0 && State.target.texture.width == screenWidth && State.target.texture.height == screenHeight) {
+        return true;
+    }
+
+    // NOTE: Allocated at full size once, scale changes only change the viewport
+    if (State.target.id != 0) UnloadRenderTexture(State.target);
+
+    State.target = LoadRenderTexture(screenWidth, screenHeight);
+    if (State.target.id == 0) return false;
+
+    SetTextureFilter(State.target.texture, TEXTURE_FILTER_BILINEAR);
+
+    return true;
+}
+
+/* PUBLIC API */
+
+void InitDynamicResolution(float minScale, float maxScale)
+{
+    minScale = (minScale < 0.1f) ? 0.1f : ((minScale > 1.0f) ? 1.0f : minScale);
+    maxScale = (maxScale < minScale) ? minScale : ((maxScale > 1.0f) ? 1.0f : maxScale);
+
+    InitGovernor(&State.governor, GetDefaultGovernorConfig(minScale, maxScale, GetFrameBudget()));
+
+    State.lastBegin = 0.0;
+    State.enabled = true;
+}
+
+void CloseDynamicResolution(void)
+{
+    if (State.target.id != 0) UnloadRenderTexture(State.target);
+
+    State.target = (RenderTexture2D){ 0 };
+    State.enabled = false;
+}
+
+void BeginDynamicResolution(void)
+{
+#if defined(RAYMOB_DYNAMIC_RESOLUTION)
+    static bool defaultInit = false;
+    if (!defaultInit) {
+        defaultInit = true;
+        if (!State.enabled) InitDynamicResolution(RAYMOB_MIN_RESOLUTION_SCALE, 1.0f);
+    }
+#endif
+
+    if (!State.enabled || !PrepareTarget()) return;
+
+    // The budget follows the pacer, whose target can change at any time
+    State.governor.config.budget = GetFrameBudget();
+
+    float frameTime = MeasureFrameTime();
+    float scale = (frameTime > 0.0f) ? UpdateGovernor(&State.governor, frameTime) : State.governor.scale;
+
+    State.width = (int)(State.target.texture.width*scale);
+    State.height = (int)(State.target.texture.height*scale);
+    if (State.width < 1) State.width = 1;
+    if (State.height < 1) State.height = 1;
+
+    BeginTextureMode(State.target);
+
+    // NOTE: The projection stays in screen units, only the viewport is scaled,
+    //       so the scene is drawn with the same coordinates at any scale
+    rlViewport(0, 0, State.width, State.height);
+
+    State.active = true;
+}
+
+void EndDynamicResolution(void)
+{
+    if (!State.active) return;
+
+    EndTextureMode();
+
+    // Render textures are stored bottom-up, the scaled part is at the origin
+    Rectangle source = { 0.0f, 0.0f, (float)State.width, -(float)State.height };
+    Rectangle dest = { 0.0f, 0.0f, (float)GetScreenWidth(), (float)GetScreenHeight() };
+
+    DrawTexturePro(State.target.texture, source, dest, (Vector2){ 0 }, 0.0f, WHITE);
+
+    State.active = false;
+}
+
+float GetDynamicResolutionScale(void)
+{
+    return State.enabled ? State.governor.scale : 1.0f;
+}
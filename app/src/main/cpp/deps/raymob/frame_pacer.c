@@ -0,0 +1,271 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "raymob.h"
+#include "frame_schedule.h"
+
+#include <android/choreographer.h>
+#include <android/looper.h>
+
+#include <pthread.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <time.h>
+
+/* TYPES */
+
+typedef void (*PostFrameCallback64Func)(AChoreographer *choreographer, AChoreographer_frameCallback64 callback, void *data);
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    // NOTE: The vsync clock is updated by the pacer thread on every vsync,
+    //       the schedule is only touched by the game thread
+
+    pthread_mutex_t clockMutex;
+    VsyncClock clock;
+
+    FrameSchedule schedule;
+    int64_t present;                    // Predicted present time of the current frame
+    int64_t waited;                     // Time slept by the last WaitNextPacedFrame()
+    unsigned int displayGeneration;     // Display state the vsync clock was last seeded from
+
+    AChoreographer *choreographer;      // Owned by the pacer thread
+    PostFrameCallback64Func postFrameCallback64;    // NULL below API 29
+
+    pthread_t thread;
+    ALooper *looper;
+    bool running;
+    bool stopRequested;
+
+    pthread_mutex_t threadMutex;
+    pthread_cond_t threadCond;
+    bool threadReady;
+
+} State = {
+    .clockMutex = PTHREAD_MUTEX_INITIALIZER,
+    .threadMutex = PTHREAD_MUTEX_INITIALIZER,
+    .threadCond = PTHREAD_COND_INITIALIZER
+};
+
+/* INTERNAL FUNCTIONS */
+
+static int64_t GetMonotonicTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec*1000000000LL + now.tv_nsec;
+}
+
+static void PostFrameCallback(void);
+
+static void OnVsync(int64_t frameTimeNanos)
+{
+    pthread_mutex_lock(&State.clockMutex);
+    UpdateVsyncClock(&State.clock, frameTimeNanos);
+    pthread_mutex_unlock(&State.clockMutex);
+
+    // The callback only fires once, it is posted again for the next vsync
+    if (!__atomic_load_n(&State.stopRequested, __ATOMIC_ACQUIRE)) PostFrameCallback();
+}
+
+static void FrameCallback64(int64_t frameTimeNanos, void *data)
+{
+    OnVsync(frameTimeNanos);
+}
+
+static void FrameCallback(long frameTimeNanos, void *data)
+{
+    // NOTE: 'long' is 32bit on 32bit ABIs, the frame time is truncated there
+    OnVsync((sizeof(long) >= sizeof(int64_t)) ? (int64_t)frameTimeNanos : GetMonotonicTime());
+}
+
+static void PostFrameCallback(void)
+{
+    if (State.postFrameCallback64 != NULL) State.postFrameCallback64(State.choreographer, FrameCallback64, NULL);
+    else AChoreographer_postFrameCallback(State.choreographer, FrameCallback, NULL);
+}
+
+static void *PacerThread(void *arg)
+{
+    State.looper = ALooper_prepare(0);
+    ALooper_acquire(State.looper);
+
+    // NOTE: The choreographer instance is bound to the looper of the calling thread
+    State.choreographer = AChoreographer_getInstance();
+    if (State.choreographer != NULL) PostFrameCallback();
+
+    pthread_mutex_lock(&State.threadMutex);
+    State.threadReady = true;
+    pthread_cond_signal(&State.threadCond);
+    pthread_mutex_unlock(&State.threadMutex);
+
+    if (State.choreographer == NULL) return NULL;
+
+    while (!__atomic_load_n(&State.stopRequested, __ATOMIC_ACQUIRE)) {
+        ALooper_pollOnce(-1, NULL, NULL, NULL);
+    }
+
+    return NULL;
+}
+
+static void SleepUntil(int64_t time)
+{
+    struct timespec deadline = { (time_t)(time/1000000000LL), (long)(time%1000000000LL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+}
+
+/* PUBLIC API */
+
+bool InitFramePacer(int targetFPS)
+{
+    if (State.running) {
+        SetFramePacerTarget(targetFPS);
+        return true;
+    }
+
+    // Resolve the API 29 function, the frame time of the older one is a 'long'
+
+    void *libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_NOLOAD);
+    if (libandroid != NULL) {
+        State.postFrameCallback64 = (PostFrameCallback64Func)dlsym(libandroid, "AChoreographer_postFrameCallback64");
+        dlclose(libandroid);    // NOTE: Still loaded, we are linked against it
+    }
+
+    // Start from the refresh rate reported by the display, refined by the measured vsyncs
+
+    DisplayState display = GetDisplayState();
+    float refreshRate = display.refreshRate;
+    State.displayGeneration = display.generation;
+    InitVsyncClock(&State.clock, (refreshRate > 0.0f) ? (int64_t)(1e9f/refreshRate) : FRAME_DEFAULT_VSYNC_PERIOD);
+
+    State.schedule = (FrameSchedule){ 0 };
+    SetFrameScheduleTarget(&State.schedule, targetFPS);
+
+    State.stopRequested = false;
+    State.threadReady = false;
+
+    if (pthread_create(&State.thread, NULL, PacerThread, NULL) != 0) {
+        TraceLog(LOG_WARNING, "RAYMOB: Failed to create frame pacer thread");
+        return false;
+    }
+
+    pthread_setname_np(State.thread, "raymob-vsync");
+
+    pthread_mutex_lock(&State.threadMutex);
+    while (!State.threadReady) pthread_cond_wait(&State.threadCond, &State.threadMutex);
+    pthread_mutex_unlock(&State.threadMutex);
+
+    if (State.choreographer == NULL) {
+        TraceLog(LOG_WARNING, "RAYMOB: Choreographer not available, frames are not paced");
+        pthread_join(State.thread, NULL);
+        ALooper_release(State.looper);
+        return false;
+    }
+
+    // NOTE: Frames are now timed by the pacer, raylib must not wait on its own timer
+    SetTargetFPS(0);
+    State.running = true;
+
+    return true;
+}
+
+void CloseFramePacer(void)
+{
+    if (!State.running) return;
+
+    __atomic_store_n(&State.stopRequested, true, __ATOMIC_RELEASE);
+    ALooper_wake(State.looper);
+
+    pthread_join(State.thread, NULL);
+    ALooper_release(State.looper);
+
+    State.running = false;
+}
+
+void SetFramePacerTarget(int targetFPS)
+{
+    SetFrameScheduleTarget(&State.schedule, targetFPS);
+}
+
+void WaitNextPacedFrame(void)
+{
+    if (!State.running) return;
+
+    // NOTE: A refresh rate drop looks like missed vsyncs to the clock,
+    //       so it is seeded again from the rate reported by the display
+    unsigned int generation = GetDisplayStateGeneration();
+    float refreshRate = 0.0f;
+
+    if (generation != State.displayGeneration) {
+        State.displayGeneration = generation;
+        refreshRate = GetDisplayState().refreshRate;
+    }
+
+    pthread_mutex_lock(&State.clockMutex);
+    if (refreshRate > 0.0f) State.clock.period = (int64_t)(1e9f/refreshRate);
+    VsyncClock clock = State.clock;
+    pthread_mutex_unlock(&State.clockMutex);
+
+    int64_t now = GetMonotonicTime();
+    int64_t start = ScheduleNextFrame(&State.schedule, &clock, now);
+
+    // NOTE: Presented one vsync after its deadline, once latched by the compositor
+    State.present = State.schedule.deadline + clock.period;
+
+    State.waited = (start > now) ? start - now : 0;
+    SleepUntil(start);
+}
+
+double GetFramePresentTime(void)
+{
+    if (!State.running) return GetTime();
+
+    // Converted to the clock of GetTime(), whose origin is private to raylib
+    return GetTime() + (double)(State.present - GetMonotonicTime())*1e-9;
+}
+
+float GetFramePacerInterval(void)
+{
+    if (!State.running) return GetFrameTime();
+
+    pthread_mutex_lock(&State.clockMutex);
+    int64_t period = State.clock.period;
+    pthread_mutex_unlock(&State.clockMutex);
+
+    int divisor = (State.schedule.divisor > 0) ? State.schedule.divisor : 1;
+    return (float)((double)(divisor*period)*1e-9);
+}
+
+bool IsFramePacerReady(void)
+{
+    return State.running;
+}
+
+float GetFramePacerWaitTime(void)
+{
+    return State.running ? (float)((double)State.waited*1e-9) : 0.0f;
+}
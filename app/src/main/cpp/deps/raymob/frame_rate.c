@@ -0,0 +1,176 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "raymob.h"
+#include "bridge.h"
+
+#include <android/native_window.h>
+#include <dlfcn.h>
+
+/* DEFINES */
+
+#define FRAME_RATE_STATIC_DELAY     0.5     // Seconds a scene must stay static before the rate drops
+
+/* TYPES */
+
+typedef int32_t (*SetFrameRateFunc)(ANativeWindow *window, float frameRate, int8_t compatibility);
+
+/* GLOBAL VARIABLES */
+
+// NOTE: Only used from the game thread, which owns GetAndroidApp()->window
+
+static struct {
+
+    SetFrameRateFunc setFrameRate;      // NULL below API 30
+    bool resolved;
+
+    float preferredRate;                // 0 for no preference
+    FrameRateCompatibility compatibility;
+
+    float staticRate;                   // 0 if the static scene policy is disabled
+    bool sceneStatic;
+    double staticSince;
+
+    ANativeWindow *window;              // Window the rate was last set on
+    float appliedRate;
+    FrameRateCompatibility appliedCompatibility;
+
+} State = { 0 };
+
+/* INTERNAL FUNCTIONS */
+
+static bool ResolveSetFrameRate(void)
+{
+    if (State.resolved) return (State.setFrameRate != NULL);
+    State.resolved = true;
+
+    // NOTE: Resolved at runtime, ANativeWindow_setFrameRate only exists since API 30
+    void *libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_NOLOAD);
+    if (libandroid != NULL) {
+        State.setFrameRate = (SetFrameRateFunc)dlsym(libandroid, "ANativeWindow_setFrameRate");
+        dlclose(libandroid);    // NOTE: Still loaded, we are linked against it
+    }
+
+    if (State.setFrameRate == NULL) {
+        TraceLog(LOG_INFO, "RAYMOB: Preferred frame rate is not supported (API 30 required)");
+    }
+
+    return (State.setFrameRate != NULL);
+}
+
+static bool ApplyFrameRate(void)
+{
+    if (!ResolveSetFrameRate()) return false;
+
+    // NOTE: NULL while the app is paused, a new window is created on resume
+    ANativeWindow *window = GetAndroidApp()->window;
+    if (window == NULL) return false;
+
+    float rate = State.preferredRate;
+    FrameRateCompatibility compatibility = State.compatibility;
+
+    // The static rate only lowers the preferred one, it never raises it
+    bool useStaticRate = State.staticRate > 0.0f && State.sceneStatic &&
+                         (GetTime() - State.staticSince) >= FRAME_RATE_STATIC_DELAY;
+
+    if (useStaticRate && (rate == 0.0f || State.staticRate < rate)) {
+        rate = State.staticRate;
+        compatibility = FRAME_RATE_COMPATIBILITY_DEFAULT;
+    }
+
+    if (window == State.window && rate == State.appliedRate && compatibility == State.appliedCompatibility) {
+        return true;
+    }
+
+    // NOTE: Remembered even on failure, so that it is not retried every frame
+    State.window = window;
+    State.appliedRate = rate;
+    State.appliedCompatibility = compatibility;
+
+    if (State.setFrameRate(window, rate, (int8_t)compatibility) != 0) {
+        TraceLog(LOG_WARNING, "RAYMOB: Failed to set the frame rate of the window to %.2f", rate);
+        return false;
+    }
+
+    return true;
+}
+
+/* PUBLIC API */
+
+void OnWindowInit(void)
+{
+    // NOTE: A new window may get the address of the previous one, force the rate on it
+    State.window = NULL;
+    ApplyFrameRate();
+}
+
+bool SetPreferredFrameRate(float fps, FrameRateCompatibility compatibility)
+{
+    HookAppCommands();
+
+    State.preferredRate = (fps > 0.0f) ? fps : 0.0f;
+    State.compatibility = compatibility;
+
+    return ApplyFrameRate();
+}
+
+int GetSupportedFrameRates(float *rates, int maxCount)
+{
+    const RaymobBridge *bridge = GetBridge();
+    if (bridge == NULL || bridge->displayManager == NULL || bridge->getSupportedRefreshRates == NULL) return 0;
+
+    JNIEnv *env = GetThreadJNIEnv();
+
+    jfloatArray array = (jfloatArray)(*env)->CallObjectMethod(env, bridge->displayManager, bridge->getSupportedRefreshRates);
+    if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+    if (array == NULL) return 0;
+
+    int count = (int)(*env)->GetArrayLength(env, array);
+
+    if (rates != NULL && maxCount > 0) {
+        if (count > maxCount) count = maxCount;
+        (*env)->GetFloatArrayRegion(env, array, 0, count, rates);
+    }
+
+    (*env)->DeleteLocalRef(env, array);
+
+    return count;
+}
+
+void SetStaticFrameRate(float fps)
+{
+    HookAppCommands();
+
+    State.staticRate = (fps > 0.0f) ? fps : 0.0f;
+    ApplyFrameRate();
+}
+
+void SetSceneStatic(bool isStatic)
+{
+    if (isStatic && !State.sceneStatic) State.staticSince = GetTime();
+    State.sceneStatic = isStatic;
+
+    ApplyFrameRate();
+}
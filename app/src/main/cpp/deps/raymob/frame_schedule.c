@@ -0,0 +1,114 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "frame_schedule.h"
+
+/* INTERNAL FUNCTIONS */
+
+static int GetVsyncDivisor(int targetFPS, int64_t period)
+{
+    if (targetFPS <= 0 || period <= 0) return 1;
+
+    // NOTE: The smallest divisor that does not exceed the target (with 5% of tolerance),
+    //       e.g. 60 gives 2 on 120Hz (60 FPS), and also 2 on 90Hz (45 FPS)
+    int64_t interval = 1000000000LL*100/(targetFPS*105LL);
+    int64_t divisor = (interval + period - 1)/period;
+    return (divisor > 1) ? (int)divisor : 1;
+}
+
+/* FUNCTIONS */
+
+void InitVsyncClock(VsyncClock *clock, int64_t period)
+{
+    clock->time = 0;
+    clock->period = (period > 0) ? period : FRAME_DEFAULT_VSYNC_PERIOD;
+}
+
+void UpdateVsyncClock(VsyncClock *clock, int64_t vsyncTime)
+{
+    int64_t elapsed = vsyncTime - clock->time;
+
+    if (clock->time != 0 && elapsed > 0) {
+        int64_t periods = (elapsed + clock->period/2)/clock->period;
+
+        // Average over roughly 8 periods, the observed one is reliable
+        // enough to follow a refresh rate change within a few frames
+        if (periods >= 1) {
+            int64_t observed = elapsed/periods;
+            clock->period += (observed - clock->period)/8;
+        } else {
+            // Faster than the estimate by more than half, the refresh rate went up
+            clock->period = elapsed;
+        }
+    }
+
+    if (vsyncTime > clock->time) clock->time = vsyncTime;
+}
+
+int64_t GetNextVsync(const VsyncClock *clock, int64_t time)
+{
+    if (time <= clock->time) return clock->time;
+
+    int64_t periods = (time - clock->time + clock->period - 1)/clock->period;
+    return clock->time + periods*clock->period;
+}
+
+void SetFrameScheduleTarget(FrameSchedule *schedule, int targetFPS)
+{
+    schedule->targetFPS = targetFPS;
+}
+
+int64_t ScheduleNextFrame(FrameSchedule *schedule, const VsyncClock *clock, int64_t now)
+{
+    // The work estimate rises at once on a slow frame and decays slowly, so
+    // that it tracks the slowest recent frames rather than the average one
+    if (schedule->start != 0) {
+        int64_t work = now - schedule->start;
+        if (work > schedule->workEstimate) schedule->workEstimate = work;
+        else schedule->workEstimate += (work - schedule->workEstimate)/64;
+    }
+
+    schedule->divisor = GetVsyncDivisor(schedule->targetFPS, clock->period);
+
+    int64_t interval = schedule->divisor*clock->period;
+    int64_t lead = schedule->workEstimate + FRAME_SCHEDULE_MARGIN;
+    if (lead > interval) lead = interval;
+
+    // The deadline has to leave time for the work, and keep the frame interval,
+    // half a period of tolerance absorbs the jitter of the vsync estimate
+    int64_t earliest = now + lead;
+
+    if (schedule->deadline != 0) {
+        int64_t spaced = schedule->deadline + interval - clock->period/2;
+        if (spaced > earliest) earliest = spaced;
+    }
+
+    schedule->deadline = GetNextVsync(clock, earliest);
+
+    int64_t start = schedule->deadline - lead;
+    schedule->start = (start > now) ? start : now;
+
+    return schedule->start;
+}
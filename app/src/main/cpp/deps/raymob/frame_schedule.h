@@ -0,0 +1,92 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef RAYMOB_FRAME_SCHEDULE_H
+#define RAYMOB_FRAME_SCHEDULE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Vsync aligned frame scheduling. Plain C working on timestamps only, the
+ * vsync signal comes from the Choreographer on Android (frame_pacer.c), so
+ * the scheduling can be driven and checked on a host with a mock vsync clock.
+ * All times are in nanoseconds on CLOCK_MONOTONIC.
+ */
+
+#define FRAME_DEFAULT_VSYNC_PERIOD  16666667LL      // 60Hz, until the vsync period is measured
+#define FRAME_SCHEDULE_MARGIN       1000000LL       // Started 1ms ahead of the estimated work
+
+typedef struct VsyncClock {
+    int64_t time;           // Latest vsync seen
+    int64_t period;         // Estimated period between two vsyncs
+} VsyncClock;
+
+typedef struct FrameSchedule {
+    int targetFPS;          // 0 or less to present on every vsync
+    int divisor;            // Vsyncs per frame, derived from the target and the vsync period
+    int64_t workEstimate;   // Estimated duration of the work of a frame
+    int64_t start;          // Start of the current frame, 0 before the first one
+    int64_t deadline;       // Vsync the current frame has to be submitted for
+} FrameSchedule;
+
+/**
+ * @brief Resets a vsync clock, with an initial period estimate.
+ */
+void InitVsyncClock(VsyncClock *clock, int64_t period);
+
+/**
+ * @brief Adds a vsync timestamp, the period estimate follows refresh rate changes.
+ *
+ * Missed vsyncs are allowed, the time since the previous one is divided by
+ * the number of periods it spans before being averaged.
+ */
+void UpdateVsyncClock(VsyncClock *clock, int64_t vsyncTime);
+
+/**
+ * @brief Returns the first vsync at or after a time, according to the clock.
+ */
+int64_t GetNextVsync(const VsyncClock *clock, int64_t time);
+
+/**
+ * @brief Sets the target frame rate, the refresh rate divided by the smallest
+ *        divisor that does not exceed it.
+ */
+void SetFrameScheduleTarget(FrameSchedule *schedule, int targetFPS);
+
+/**
+ * @brief Schedules the next frame, called when the previous one is done.
+ *
+ * Picks the deadline of the next frame (a vsync, at least 'divisor' vsyncs
+ * after the previous deadline) and the latest start time that still leaves
+ * the estimated work time before it.
+ *
+ * @return Time the next frame should start at, never before 'now'.
+ */
+int64_t ScheduleNextFrame(FrameSchedule *schedule, const VsyncClock *clock, int64_t now);
+
+#endif //RAYMOB_FRAME_SCHEDULE_H
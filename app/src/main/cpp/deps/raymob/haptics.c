@@ -0,0 +1,183 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "raymob.h"
+#include "haptics.h"
+#include "ring_buffer.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+/* DEFINES */
+
+#define HAPTIC_BATCH_SIZE   16
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    RingBuffer queue;
+    pthread_mutex_t pushMutex;      // The ring has a single producer, pushes are serialized
+    sem_t pending;                  // Posted once per command pushed
+
+    HapticExecutor executor;
+    pthread_t worker;
+    bool running;
+
+} State = { .pushMutex = PTHREAD_MUTEX_INITIALIZER };
+
+static pthread_once_t hapticsOnce = PTHREAD_ONCE_INIT;
+
+/* INTERNAL FUNCTIONS */
+
+static int64_t GetMonotonicTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec*1000000000LL + now.tv_nsec;
+}
+
+static int GetAmplitudeStrength(int amplitude)
+{
+    // NOTE: The default amplitude is the full strength of most vibrators,
+    //       it must never lose against a weak explicit one
+    return (amplitude == HAPTIC_DEFAULT_AMPLITUDE) ? 255 : amplitude;
+}
+
+static bool IsStrongerOrLonger(const HapticCommand *a, const HapticCommand *b)
+{
+    return a->duration > b->duration || GetAmplitudeStrength(a->amplitude) > GetAmplitudeStrength(b->amplitude);
+}
+
+static void *HapticsWorker(void *arg)
+{
+    HapticCommand batch[HAPTIC_BATCH_SIZE];
+    HapticCommand last = { 0 };
+
+    for (;;) {
+        while (sem_wait(&State.pending) != 0);
+
+        // NOTE: One post per command, the posts of the other commands of the batch
+        //       are consumed right away, they come right after their push
+        int count = PopRingBuffer(&State.queue, batch, HAPTIC_BATCH_SIZE);
+        for (int i = 1; i < count; i++) while (sem_wait(&State.pending) != 0);
+
+        ExecuteHapticCommands(batch, count, &last, State.executor);
+    }
+
+    return NULL;
+}
+
+static void InitHaptics(void)
+{
+    if (!LoadRingBuffer(&State.queue, sizeof(HapticCommand), HAPTIC_QUEUE_CAPACITY)) {
+        TraceLog(LOG_WARNING, "RAYMOB: Failed to allocate haptics queue");
+        return;
+    }
+
+    sem_init(&State.pending, 0, 0);
+
+    if (pthread_create(&State.worker, NULL, HapticsWorker, NULL) != 0) {
+        TraceLog(LOG_WARNING, "RAYMOB: Failed to create haptics thread");
+        UnloadRingBuffer(&State.queue);
+        return;
+    }
+
+    pthread_setname_np(State.worker, "raymob-haptics");
+    pthread_detach(State.worker);
+
+    State.running = true;
+}
+
+/* FUNCTIONS */
+
+bool StartHaptics(HapticExecutor executor)
+{
+    // NOTE: Written before the worker is created, and never changed after
+    if (State.executor == NULL) State.executor = executor;
+
+    pthread_once(&hapticsOnce, InitHaptics);
+    return State.running;
+}
+
+bool PushHapticCommand(HapticCommand command)
+{
+    if (!State.running) return false;
+    if (command.timestamp == 0) command.timestamp = GetMonotonicTime();
+
+    pthread_mutex_lock(&State.pushMutex);
+    int pushed = PushRingBuffer(&State.queue, &command, 1);
+    pthread_mutex_unlock(&State.pushMutex);
+
+    if (pushed == 0) return false;
+
+    sem_post(&State.pending);
+    return true;
+}
+
+int ExecuteHapticCommands(const HapticCommand *commands, int count, HapticCommand *last, HapticExecutor executor)
+{
+    int executed = 0;
+
+    for (int i = 0; i < count; i++) {
+        HapticCommand command = commands[i];
+
+        if (command.type == HAPTIC_ONE_SHOT) {
+
+            // Merge the following one-shots of the window into this one, keeping
+            // the longest duration and the strongest amplitude of them
+            while (i + 1 < count && commands[i + 1].type == HAPTIC_ONE_SHOT &&
+                   commands[i + 1].timestamp - command.timestamp < HAPTIC_COALESCE_WINDOW_NS) {
+                i++;
+                if (commands[i].duration > command.duration) command.duration = commands[i].duration;
+                if (GetAmplitudeStrength(commands[i].amplitude) > GetAmplitudeStrength(command.amplitude)) {
+                    command.amplitude = commands[i].amplitude;
+                }
+            }
+
+            // Drop it if it adds nothing to the one-shot executed just before
+            if (last->type == HAPTIC_ONE_SHOT && last->timestamp != 0 &&
+                command.timestamp - last->timestamp < HAPTIC_COALESCE_WINDOW_NS &&
+                !IsStrongerOrLonger(&command, last)) {
+                continue;
+            }
+        } else if (command.type == HAPTIC_PATTERN) {
+
+            // Drop it if the same pattern was just started
+            if (last->type == HAPTIC_PATTERN && last->pattern == command.pattern &&
+                command.timestamp - last->timestamp < HAPTIC_COALESCE_WINDOW_NS) {
+                continue;
+            }
+        }
+
+        executor(&command);
+        executed++;
+
+        *last = command;
+    }
+
+    return executed;
+}
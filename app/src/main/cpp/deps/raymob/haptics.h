@@ -0,0 +1,98 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef RAYMOB_HAPTICS_H
+#define RAYMOB_HAPTICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Asynchronous haptics queue. Requests are pushed into a ring and executed
+ * in order by a worker thread, so the caller only pays for the enqueue.
+ * Redundant one-shot requests close in time are coalesced by the worker,
+ * and a pattern replayed within the same window is only played once.
+ * Plain C, the executor is provided by the platform (vibrator.c on Android),
+ * so the queue can also be built on a host with a stand-in executor.
+ */
+
+/* DEFINES */
+
+#define HAPTIC_QUEUE_CAPACITY       64
+#define HAPTIC_COALESCE_WINDOW_NS   20000000LL      // One-shots closer than 20ms are merged
+
+#define HAPTIC_DEFAULT_AMPLITUDE    -1      // Same value as VibrationEffect.DEFAULT_AMPLITUDE
+
+/* TYPES */
+
+typedef enum {
+    HAPTIC_ONE_SHOT,        // Vibrates for 'duration' milliseconds at 'amplitude'
+    HAPTIC_CANCEL,          // Stops the current vibration
+    HAPTIC_PATTERN,         // Plays the pattern 'pattern'
+} HapticCommandType;
+
+typedef struct HapticCommand {
+    HapticCommandType type;
+    int64_t timestamp;      // Time of the request in nanoseconds (CLOCK_MONOTONIC), set on push if zero
+    int64_t duration;       // Milliseconds
+    int amplitude;          // 1 to 255, or HAPTIC_DEFAULT_AMPLITUDE
+    unsigned int pattern;   // Handle of the pattern, resolved by the executor
+} HapticCommand;
+
+// Executes a command on the worker thread, may block (e.g. binder calls)
+typedef void (*HapticExecutor)(const HapticCommand *command);
+
+/* FUNCTIONS */
+
+/**
+ * @brief Starts the haptics worker, only the first call has an effect.
+ *
+ * @return true if the worker is running.
+ */
+bool StartHaptics(HapticExecutor executor);
+
+/**
+ * @brief Enqueues a command for the worker, never blocks on the executor.
+ *
+ * Thread safe, producers are serialized with a mutex held only for the copy.
+ *
+ * @return false if the worker is not running or the queue is full.
+ */
+bool PushHapticCommand(HapticCommand command);
+
+/**
+ * @brief Coalesces and executes a batch of commands, in order.
+ *
+ * Called by the worker with each batch it pops, exposed so that the
+ * coalescing rules can be checked without a thread. 'last' keeps the
+ * last executed one-shot between batches, zero-initialize it first.
+ *
+ * @return Number of commands executed.
+ */
+int ExecuteHapticCommands(const HapticCommand *commands, int count, HapticCommand *last, HapticExecutor executor);
+
+#endif //RAYMOB_HAPTICS_H
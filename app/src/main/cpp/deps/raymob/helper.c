@@ -23,357 +23,523 @@
  */
 
 #include "raymob.h"
+#include "bridge.h"
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /* Static variables */
 
 static jobject featuresInstance = NULL;
 
-/* Functions definition */
+static JavaVM *threadEnvVM = NULL;     // Atomic, set once raylib has received the android_app
+static pthread_key_t threadEnvKey;
+static pthread_once_t threadEnvOnce = PTHREAD_ONCE_INIT;
 
-JNIEnv* AttachCurrentThread(void)
+// NOTE: Each root is resolved once and never changes afterwards, it is only
+//       marked ready on success, so that a failed lookup is retried later
+static char appStorageRoot[PATH_MAX] = { 0 };
+static char cacheDirRoot[PATH_MAX] = { 0 };
+static bool appStorageReady = false;   // Atomic
+static bool cacheDirReady = false;     // Atomic
+static pthread_mutex_t storageRootsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Internal functions */
+
+static void DetachThreadEnv(void *env)
 {
-    JavaVM *vm = GetAndroidApp()->activity->vm;
-    JNIEnv *env = NULL;
+    // NOTE: Called by pthread on thread exit, only for threads attached by GetThreadJNIEnv()
+    (*threadEnvVM)->DetachCurrentThread(threadEnvVM);
+}
 
-    (*vm)->AttachCurrentThread(vm, &env, NULL);
-    return env;
+static void InitThreadEnvKey(void)
+{
+    pthread_key_create(&threadEnvKey, DetachThreadEnv);
 }
 
-void DetachCurrentThread(void)
+static JavaVM *GetJavaVM(void)
 {
-    JavaVM *vm = GetAndroidApp()->activity->vm;
-    (*vm)->DetachCurrentThread(vm);
+    JavaVM *vm = __atomic_load_n(&threadEnvVM, __ATOMIC_ACQUIRE);
+    if (vm != NULL) return vm;
+
+    // NOTE: The VM is the same for the whole process, only its first lookup may be too early
+    struct android_app *app = GetAndroidApp();
+    if (app == NULL || app->activity == NULL || app->activity->vm == NULL) return NULL;
+
+    __atomic_store_n(&threadEnvVM, app->activity->vm, __ATOMIC_RELEASE);
+    return app->activity->vm;
 }
 
-jobject GetNativeLoaderInstance(void)
+static bool ClearJavaException(JNIEnv *env)
 {
-    return GetAndroidApp()->activity->clazz;
+    // NOTE: e.g. a SecurityException, it must be cleared before any other JNI call
+    if (!(*env)->ExceptionCheck(env)) return false;
+
+    (*env)->ExceptionClear(env);
+    return true;
 }
 
-jobject GetFeaturesInstance(void)
+static bool CopyJavaFilePath(JNIEnv *env, jobject file, jmethodID getPathMethod, char *dst, size_t cap)
 {
-    if (featuresInstance == NULL)
-    {
-        JNIEnv *env = AttachCurrentThread();
-        jobject nativeLoaderInstance = GetNativeLoaderInstance();
+    if (file == NULL) return false;
 
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, nativeLoaderInstance);
-        jmethodID getFeaturesMethod = (*env)->GetMethodID(env, nativeLoaderClass, "getFeatures", "()Lcom/raylib/raymob/Features;");
+    bool copied = false;
+    jstring pathString = (jstring)(*env)->CallObjectMethod(env, file, getPathMethod);
 
-        if (getFeaturesMethod == NULL) return NULL; // Handle the case where the method is not found
+    if (!ClearJavaException(env) && pathString != NULL)
+    {
+        const char *pathChars = (*env)->GetStringUTFChars(env, pathString, NULL);
 
-        jobject localFeaturesInstance = (*env)->CallObjectMethod(env, nativeLoaderInstance, getFeaturesMethod);
-        featuresInstance = (*env)->NewGlobalRef(env, localFeaturesInstance);
+        if (pathChars != NULL && strlen(pathChars) < cap) {
+            strcpy(dst, pathChars);
+            copied = (dst[0] != '\0');
+        }
+        else if (pathChars != NULL) TraceLog(LOG_WARNING, "FILEIO: [%s] Path is too long", pathChars);
 
-        DetachCurrentThread();
+        if (pathChars != NULL) (*env)->ReleaseStringUTFChars(env, pathString, pathChars);
     }
 
-    return featuresInstance;
+    if (pathString != NULL) (*env)->DeleteLocalRef(env, pathString);
+
+    return copied;
 }
 
-char* GetCacheDir(void)
+// Must be called with the storage roots mutex locked
+static void InitStorageRoots(void)
 {
-    struct android_app *app = GetAndroidApp();
+    const RaymobBridge *bridge = GetBridge();
+    if (bridge == NULL) return;
 
-    JavaVM* vm = app->activity->vm;
-    JNIEnv* env = NULL;
-    (*vm)->AttachCurrentThread(vm, &env, NULL);
+    JNIEnv *env = GetThreadJNIEnv();
 
-    // Get the activity object and its class
-    jobject activity = app->activity->clazz;
-    jclass activityClass = (*env)->GetObjectClass(env, activity);
+    // NOTE: Either directory is null while its storage is not available (e.g. unmounted)
 
-    // Get the method ID for the getCacheDir() method of the activity
-    jmethodID getCacheDirMethod = (*env)->GetMethodID(env, activityClass, "getCacheDir", "()Ljava/io/File;");
+    if (!__atomic_load_n(&appStorageReady, __ATOMIC_RELAXED)) {
+        // Call getExternalFilesDir(null) to get the root external files directory
+        jobject filesDir = (*env)->CallObjectMethod(env, bridge->nativeLoader, bridge->getExternalFilesDir, NULL);
+        if (ClearJavaException(env)) filesDir = NULL;
 
-    // Call the getCacheDir() method to get the cache directory
-    jobject cacheDir = (*env)->CallObjectMethod(env, activity, getCacheDirMethod);
+        if (CopyJavaFilePath(env, filesDir, bridge->getAbsolutePath, appStorageRoot, sizeof(appStorageRoot))) {
+            __atomic_store_n(&appStorageReady, true, __ATOMIC_RELEASE);
+        }
 
-    // Get the class object for java.io.File
-    jclass fileClass = (*env)->GetObjectClass(env, cacheDir);
+        if (filesDir != NULL) (*env)->DeleteLocalRef(env, filesDir);
+    }
 
-    // Get the method ID for the getPath() method of java.io.File
-    jmethodID getPathMethod = (*env)->GetMethodID(env, fileClass, "getPath", "()Ljava/lang/String;");
+    if (!__atomic_load_n(&cacheDirReady, __ATOMIC_RELAXED)) {
+        // Call the getCacheDir() method to get the cache directory
+        jobject cacheDir = (*env)->CallObjectMethod(env, bridge->nativeLoader, bridge->getCacheDir);
+        if (ClearJavaException(env)) cacheDir = NULL;
 
-    // Call the getPath() method to get the path of the cache directory
-    jstring pathString = (jstring)(*env)->CallObjectMethod(env, cacheDir, getPathMethod);
+        if (CopyJavaFilePath(env, cacheDir, bridge->getPath, cacheDirRoot, sizeof(cacheDirRoot))) {
+            __atomic_store_n(&cacheDirReady, true, __ATOMIC_RELEASE);
+        }
 
-    // Get the UTF-8 encoded string from the Java string
-    const char *pathChars = (*env)->GetStringUTFChars(env, pathString, NULL);
+        if (cacheDir != NULL) (*env)->DeleteLocalRef(env, cacheDir);
+    }
+}
 
-    // Allocate memory for the cache path
-    size_t len = strlen(pathChars) + 1; // NOTE: +1 for the null terminator
-    char* cachePath = RL_MALLOC(len);
+static const char *GetStorageRoot(const char *root, bool *ready)
+{
+    // NOTE: Retried on every call until it succeeds, the roots are empty until then
+    if (!__atomic_load_n(ready, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&storageRootsMutex);
+        if (!__atomic_load_n(ready, __ATOMIC_RELAXED)) InitStorageRoots();
+        pthread_mutex_unlock(&storageRootsMutex);
+    }
 
-    // Copy the string to the allocated memory
-    if (cachePath)
-    {
-        strncpy(cachePath, pathChars, len);
-        cachePath[len - 1] = '\0'; // NOTE: just for security
+    return __atomic_load_n(ready, __ATOMIC_ACQUIRE) ? root : "";
+}
+
+static const char *GetAppStorageRoot(void)
+{
+    return GetStorageRoot(appStorageRoot, &appStorageReady);
+}
+
+static const char *GetCacheDirRoot(void)
+{
+    return GetStorageRoot(cacheDirRoot, &cacheDirReady);
+}
+
+static int JoinPath(char *dst, size_t cap, const char *root, const char *filepath)
+{
+    if (root[0] == '\0') return -1;
+
+    int len = snprintf(dst, cap, "%s/%s", root, filepath);
+
+    if (len < 0 || (size_t)len >= cap) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Path is too long", filepath);
+        return -1;
     }
 
-    // Release the UTF-8 encoded string
-    (*env)->ReleaseStringUTFChars(env, pathString, pathChars);
+    return len;
+}
 
-    // Clean up local references
-    (*env)->DeleteLocalRef(env, pathString);
-    (*env)->DeleteLocalRef(env, fileClass);
-    (*env)->DeleteLocalRef(env, cacheDir);
-    (*env)->DeleteLocalRef(env, activityClass);
+static int CopyString(char *dst, size_t cap, const char *src)
+{
+    size_t len = strlen(src);
 
-    // Detach the current thread from the JavaVM
-    (*vm)->DetachCurrentThread(vm);
+    if (dst != NULL && cap > 0) {
+        size_t count = (len < cap) ? len : cap - 1;
+        memcpy(dst, src, count);
+        dst[count] = '\0';
+    }
 
-    // Return the cache path
-    return cachePath;
+    return (int)len;
 }
 
-char* LoadCacheFile(const char* fileName)
+static int ReadFileInto(const char *path, void *dst, size_t cap)
 {
-    char *text = NULL;
-    char *cacheDir = GetCacheDir();
-    size_t len1 = strlen(cacheDir);
-    size_t len2 = strlen(fileName);
-    size_t len = len1 + len2 + 1;
-    char *filePath = RL_MALLOC(len);
-    strncpy(filePath, cacheDir, len1);
-    filePath[len1] = '/';
-    strncpy(filePath + len1 + 1, fileName, len2);
-    filePath[len] = '\0';
-
-    FILE * file = fopen(filePath, "rt");
-    if (file != NULL)
-    {
-        // WARNING: When reading a file as 'text' file,
-        // text mode causes carriage return-linefeed translation...
-        // ...but using fseek() should return correct byte-offset
-        fseek(file, 0, SEEK_END);
-        unsigned int size = (unsigned int)ftell(file);
-        fseek(file, 0, SEEK_SET);
-
-        if (size > 0)
-        {
-            text = (char *)RL_MALLOC((size + 1)*sizeof(char));
-
-            if (text != NULL)
-            {
-                unsigned int count = (unsigned int)fread(text, sizeof(char), size, file);
-
-                // WARNING: \r\n is converted to \n on reading, so,
-                // read bytes count gets reduced by the number of lines
-                if (count < size) text = RL_REALLOC(text, count + 1);
-
-                // Zero-terminate the string
-                text[count] = '\0';
-
-                TraceLog(LOG_INFO, "FILEIO: [%s] Text file loaded successfully", fileName);
-            }
-            else TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocated memory for file reading", fileName);
-        }
-        else TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to read text file", fileName);
+    // NOTE: Plain file descriptors are used here, fopen() would allocate a FILE on the heap
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
 
-        fclose(file);
+    if (fd < 0) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to open file", path);
+        return -1;
     }
-    else TraceLog(LOG_WARNING, "FILEIO: File name provided is not valid");
 
-    RL_FREE(filePath);
-    RL_FREE(cacheDir);
+    struct stat st;
 
-    return text;
+    if (fstat(fd, &st) != 0) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to read file", path);
+        close(fd);
+        return -1;
+    }
+
+    // NOTE: Sizes are unified along raylib as 'int', so files > INT_MAX (2147483647 bytes) are rejected
+    if (st.st_size > INT_MAX) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] File is bigger than 2147483647 bytes, use a StorageStream instead", path);
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    size_t toRead = (size < cap) ? size : cap;
+    size_t total = 0;
+
+    while (dst != NULL && total < toRead) {
+        ssize_t count = read(fd, (unsigned char *)dst + total, toRead - total);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        total += (size_t)count;
+    }
+
+    close(fd);
+
+    // The file may have shrunk since fstat(), report what was actually read in that case
+    if (dst != NULL && total < toRead) return (int)total;
+
+    return (int)size;
 }
 
-char* GetL10NString(const char* value)
+static MappedFile MapFile(const char *path, MapAccess access)
 {
-    jobject nativeInstance = GetNativeLoaderInstance();
+    MappedFile file = { 0 };
 
-    if (nativeInstance != NULL)
-    {
-        JNIEnv* env = AttachCurrentThread();
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to open file", path);
+        return file;
+    }
 
-        // Get the native context class (nativeInstance)
-        jclass nativeClass = (*env)->GetObjectClass(env, nativeInstance);
+    struct stat st;
 
-        // Get the native instance's getResources method
-        jmethodID getResourcesMethod = (*env)->GetMethodID(env, nativeClass, "getResources", "()Landroid/content/res/Resources;");
-        jobject resources = (*env)->CallObjectMethod(env, nativeInstance, getResourcesMethod);
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to read file", path);
+        close(fd);
+        return file;
+    }
 
-        // Get the getIdentifier method of the Resources class
-        jclass resourcesClass = (*env)->GetObjectClass(env, resources);
-        jmethodID getIdentifierMethod = (*env)->GetMethodID(env, resourcesClass, "getIdentifier",
-                                                            "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)I");
+    // NOTE: On 32bit devices files larger than the address space cannot be mapped at once
+#if SIZE_MAX < UINT64_MAX
+    if ((uint64_t)st.st_size > SIZE_MAX) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] File is too large to be mapped", path);
+        close(fd);
+        return file;
+    }
+#endif
 
-        // Convert string name passed as parameter to jstring
-        jstring resourceName = (*env)->NewStringUTF(env, value);
-        jstring defType = (*env)->NewStringUTF(env, "string");
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // NOTE: The mapping keeps its own reference on the file
 
-        // Get the package name of the native instance
-        jmethodID getPackageNameMethod = (*env)->GetMethodID(env, nativeClass, "getPackageName", "()Ljava/lang/String;");
-        jstring packageName = (jstring)(*env)->CallObjectMethod(env, nativeInstance, getPackageNameMethod);
+    if (data == MAP_FAILED) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to map file", path);
+        return file;
+    }
 
-        // Call getIdentifier to get the resource identifier
-        jint resId = (*env)->CallIntMethod(env, resources, getIdentifierMethod, resourceName, defType, packageName);
+    switch (access) {
+        case MAP_ACCESS_SEQUENTIAL: madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL); break;
+        case MAP_ACCESS_RANDOM: madvise(data, (size_t)st.st_size, MADV_RANDOM); break;
+        default: break;
+    }
 
-        // Clean up used local references
-        (*env)->DeleteLocalRef(env, resourceName);
-        (*env)->DeleteLocalRef(env, defType);
+    file.data = data;
+    file.size = (size_t)st.st_size;
 
-        if (resId == 0) {
-            // No identifier found for this resource
-            DetachCurrentThread();
-            return NULL;
-        }
+    TraceLog(LOG_INFO, "FILEIO: [%s] File mapped successfully", path);
 
-        // Call getString with the obtained identifier
-        jmethodID getStringMethod = (*env)->GetMethodID(env, nativeClass, "getString", "(I)Ljava/lang/String;");
-        jstring rv = (jstring)(*env)->CallObjectMethod(env, nativeInstance, getStringMethod, resId);
+    return file;
+}
 
-        if (rv == NULL) {
-            DetachCurrentThread();
-            return NULL;
-        }
+static void UnmapFile(MappedFile file)
+{
+    if (file.data != NULL) munmap((void *)file.data, file.size);
+}
 
-        // Convert jstring to char*
-        const char* strReturn = (*env)->GetStringUTFChars(env, rv, NULL);
+/* Functions definition */
 
-        // Allocate memory for returned string
-        size_t len = strlen(strReturn) + 1;
-        char* stringValue = RL_MALLOC(len);
+JNIEnv* GetThreadJNIEnv(void)
+{
+    pthread_once(&threadEnvOnce, InitThreadEnvKey);
 
-        if (stringValue) {
-            strncpy(stringValue, strReturn, len);
-            stringValue[len - 1] = '\0'; // Just for security: end with '\0'
-        }
+    JNIEnv *env = pthread_getspecific(threadEnvKey);
+    if (env != NULL) return env;
 
-        // Free UTF string and clean local references
-        (*env)->ReleaseStringUTFChars(env, rv, strReturn);
-        (*env)->DeleteLocalRef(env, rv);
+    JavaVM *vm = GetJavaVM();
 
-        DetachCurrentThread();
-        return stringValue;
+    if (vm == NULL) {
+        TraceLog(LOG_WARNING, "RAYMOB: No Java VM yet, the android_app is not available");
+        return NULL;
+    }
+
+    // The thread may already be attached by someone else (e.g. the JVM main thread),
+    // in which case it is not ours to detach and we simply use its environment
+    if ((*vm)->GetEnv(vm, (void**)&env, JNI_VERSION_1_6) == JNI_OK) {
+        return env;
+    }
+
+    JavaVMAttachArgs args = { JNI_VERSION_1_6, "raymob", NULL };
+
+    if ((*vm)->AttachCurrentThread(vm, &env, &args) != JNI_OK) {
+        TraceLog(LOG_ERROR, "RAYMOB: Failed to attach thread to the Java VM");
+        return NULL;
     }
 
-    return NULL;
+    // Remember the environment, the key destructor will detach the thread on exit
+    pthread_setspecific(threadEnvKey, env);
+
+    return env;
 }
 
-char* GetAppStoragePath(){
+JNIEnv* AttachCurrentThread(void)
+{
+    return GetThreadJNIEnv();
+}
+
+void DetachCurrentThread(void)
+{
+    // NOTE: Threads are now detached automatically when they exit (see GetThreadJNIEnv),
+    //       detaching here would only force the next call to attach the thread again
+}
 
-    jobject nativeInstance = GetNativeLoaderInstance();
+jobject GetNativeLoaderInstance(void)
+{
+    // NOTE: NULL until raylib has received the android_app
+    struct android_app *app = GetAndroidApp();
+    return (app != NULL && app->activity != NULL) ? app->activity->clazz : NULL;
+}
 
-    if (nativeInstance != NULL)
+jobject GetFeaturesInstance(void)
+{
+    if (featuresInstance == NULL)
     {
-        JNIEnv* env = AttachCurrentThread();
-        
-        // Get the native context class (nativeInstance)
-        jclass nativeClass = (*env)->GetObjectClass(env, nativeInstance);
+        JNIEnv *env = GetThreadJNIEnv();
+        jobject nativeLoaderInstance = GetNativeLoaderInstance();
 
-        // Get the getExternalFilesDir method ID
-        jmethodID getExternalFilesDirMethod = (*env)->GetMethodID(env, nativeClass, "getExternalFilesDir", "(Ljava/lang/String;)Ljava/io/File;");
+        jclass nativeLoaderClass = (*env)->GetObjectClass(env, nativeLoaderInstance);
+        jmethodID getFeaturesMethod = (*env)->GetMethodID(env, nativeLoaderClass, "getFeatures", "()Lcom/raylib/raymob/Features;");
 
-        // Call getExternalFilesDir(null) to get the root external files directory
-        jobject fileObj = (*env)->CallObjectMethod(env, nativeInstance, getExternalFilesDirMethod, NULL);
+        if (getFeaturesMethod == NULL) return NULL; // Handle the case where the method is not found
+
+        jobject localFeaturesInstance = (*env)->CallObjectMethod(env, nativeLoaderInstance, getFeaturesMethod);
+        featuresInstance = (*env)->NewGlobalRef(env, localFeaturesInstance);
+
+        (*env)->DeleteLocalRef(env, localFeaturesInstance);
+        (*env)->DeleteLocalRef(env, nativeLoaderClass);
+    }
+
+    return featuresInstance;
+}
+
+char* GetCacheDir(void)
+{
+    int len = GetCacheDirInto(NULL, 0);
+    if (len < 0) return NULL;
+
+    // Allocate memory for the cache path
+    char* cachePath = RL_MALLOC(len + 1); // NOTE: +1 for the null terminator
+
+    // Copy the cached path to the allocated memory
+    if (cachePath) GetCacheDirInto(cachePath, len + 1);
+
+    return cachePath;
+}
+
+int GetCacheDirInto(char *dst, size_t cap)
+{
+    const char *root = GetCacheDirRoot();
+    if (root[0] == '\0') return -1;
+
+    return CopyString(dst, cap, root);
+}
+
+int JoinCacheDirPath(char *dst, size_t cap, const char *fileName)
+{
+    return JoinPath(dst, cap, GetCacheDirRoot(), fileName);
+}
+
+char* LoadCacheFile(const char* fileName)
+{
+    int size = LoadCacheFileInto(fileName, NULL, 0);
 
-        // Get the java.io.File class
-        jclass fileClass = (*env)->GetObjectClass(env, fileObj);
+    if (size <= 0) {
+        if (size == 0) TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to read text file", fileName);
+        return NULL;
+    }
+
+    char *text = (char *)RL_MALLOC((size + 1)*sizeof(char));
+
+    if (text == NULL) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocated memory for file reading", fileName);
+        return NULL;
+    }
+
+    if (LoadCacheFileInto(fileName, text, size + 1) < 0) {
+        RL_FREE(text);
+        return NULL;
+    }
 
-        // Get the getAbsolutePath() method ID
-        jmethodID getAbsolutePathMethod = (*env)->GetMethodID(env, fileClass, "getAbsolutePath", "()Ljava/lang/String;");
+    TraceLog(LOG_INFO, "FILEIO: [%s] Text file loaded successfully", fileName);
 
-        // Call getAbsolutePath() to get the Java string
-        jstring jFilePath = (jstring)(*env)->CallObjectMethod(env, fileObj, getAbsolutePathMethod);
+    return text;
+}
 
-        // Convert Java string to C string
-        const char *cFilePath = (*env)->GetStringUTFChars(env, jFilePath, NULL);
+int LoadCacheFileInto(const char *fileName, char *dst, size_t cap)
+{
+    char filePath[PATH_MAX];
 
-        char *filepath = strdup(cFilePath);
+    if (JoinCacheDirPath(filePath, sizeof(filePath), fileName) < 0) return -1;
 
-        (*env)->ReleaseStringUTFChars(env, jFilePath, cFilePath);
-        (*env)->DeleteLocalRef(env, jFilePath);
-        (*env)->DeleteLocalRef(env, fileClass);
-        (*env)->DeleteLocalRef(env, fileObj);
-        (*env)->DeleteLocalRef(env, nativeClass);
-        
-        DetachCurrentThread();
+    // NOTE: One byte is kept for the null terminator
+    int size = ReadFileInto(filePath, dst, (cap > 0) ? cap - 1 : 0);
 
-        return filepath;
+    if (size >= 0 && dst != NULL && cap > 0) {
+        dst[((size_t)size < cap) ? (size_t)size : cap - 1] = '\0';
     }
 
-    return NULL;
+    return size;
 }
 
-void* ReadFromAppStorage(const char *filepath, int *dataSize){
+MappedFile MapCacheFile(const char *fileName, MapAccess access)
+{
+    char filePath[PATH_MAX];
 
-    char *appStoragePath = GetAppStoragePath();
+    if (JoinCacheDirPath(filePath, sizeof(filePath), fileName) < 0) {
+        return (MappedFile){ 0 };
+    }
+
+    return MapFile(filePath, access);
+}
+
+void UnmapCacheFile(MappedFile file)
+{
+    UnmapFile(file);
+}
+
+char* GetAppStoragePath(){
+
+    int len = GetAppStoragePathInto(NULL, 0);
+    if (len < 0) return NULL;
 
-    size_t pathLen = strlen(appStoragePath) + strlen(filepath) + 2;
-    char *path = RL_MALLOC(sizeof(char)*pathLen);
-    snprintf(path, pathLen, "%s/%s", appStoragePath, filepath);
+    char *filepath = RL_MALLOC(len + 1);
+    if (filepath) GetAppStoragePathInto(filepath, len + 1);
+
+    return filepath;
+}
+
+int GetAppStoragePathInto(char *dst, size_t cap)
+{
+    const char *root = GetAppStorageRoot();
+    if (root[0] == '\0') return -1;
+
+    return CopyString(dst, cap, root);
+}
+
+int JoinAppStoragePath(char *dst, size_t cap, const char *filepath)
+{
+    return JoinPath(dst, cap, GetAppStorageRoot(), filepath);
+}
+
+void* ReadFromAppStorage(const char *filepath, int *dataSize){
 
-    unsigned char *data = NULL;
     *dataSize = 0;
 
-    FILE *file = fopen(path, "rb");
+    int size = ReadFromAppStorageInto(filepath, NULL, 0);
 
-    if (file == NULL){
-        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to open file", path);
-        RL_FREE(appStoragePath);
-        RL_FREE(path);
+    if (size <= 0) {
+        if (size == 0) TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to read file", filepath);
         return NULL;
     }
 
-    // WARNING: On binary streams SEEK_END could not be found,
-    // using fseek() and ftell() could not work in some (rare) cases
-    fseek(file, 0, SEEK_END);
-    int size = ftell(file);     // WARNING: ftell() returns 'long int', maximum size returned is INT_MAX (2147483647 bytes)
-    fseek(file, 0, SEEK_SET);
+    unsigned char *data = RL_MALLOC(size*sizeof(unsigned char));
 
-    if (size > 0)
-    {
-        data = RL_MALLOC(size*sizeof(unsigned char));
-
-        if (data != NULL)
-        {
-            // NOTE: fread() returns number of read elements instead of bytes, so we read [1 byte, size elements]
-            size_t count = fread(data, sizeof(unsigned char), size, file);
-
-            // WARNING: fread() returns a size_t value, usually 'unsigned int' (32bit compilation) and 'unsigned long long' (64bit compilation)
-            // dataSize is unified along raylib as a 'int' type, so, for file-sizes > INT_MAX (2147483647 bytes) we have a limitation
-            if (count > 2147483647)
-            {
-                TraceLog(LOG_WARNING, "FILEIO: [%s] File is bigger than 2147483647 bytes, avoid using LoadFileData()", path);
-
-                RL_FREE(data);
-                data = NULL;
-            }
-            else
-            {
-                *dataSize = (int)count;
-
-                if ((*dataSize) != size) TraceLog(LOG_WARNING, "FILEIO: [%s] File partially loaded (%i bytes out of %i)", path, dataSize, count);
-                else TraceLog(LOG_INFO, "FILEIO: [%s] File loaded successfully", path);
-            }
-        }
-        else TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocated memory for file reading", path);
+    if (data == NULL) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocated memory for file reading", filepath);
+        return NULL;
+    }
+
+    int count = ReadFromAppStorageInto(filepath, data, size);
+
+    if (count <= 0) {
+        RL_FREE(data);
+        return NULL;
     }
-    else TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to read file", path);
 
-    fclose(file);
+    *dataSize = (count < size) ? count : size;
 
-    RL_FREE(appStoragePath);
-    RL_FREE(path);
+    if (count < size) TraceLog(LOG_WARNING, "FILEIO: [%s] File partially loaded (%i bytes out of %i)", filepath, count, size);
+    else TraceLog(LOG_INFO, "FILEIO: [%s] File loaded successfully", filepath);
 
     return data;
 }
 
+int ReadFromAppStorageInto(const char *filepath, void *dst, size_t cap)
+{
+    char path[PATH_MAX];
+
+    if (JoinAppStoragePath(path, sizeof(path), filepath) < 0) return -1;
+
+    return ReadFileInto(path, dst, cap);
+}
+
+MappedFile MapAppStorageFile(const char *filepath, MapAccess access)
+{
+    char path[PATH_MAX];
+
+    if (JoinAppStoragePath(path, sizeof(path), filepath) < 0) {
+        return (MappedFile){ 0 };
+    }
+
+    return MapFile(path, access);
+}
+
+void UnmapAppStorageFile(MappedFile file)
+{
+    UnmapFile(file);
+}
+
 bool WriteToAppStorage(const char *filepath, void *data, unsigned int dataSize){
 
-    char *appStoragePath = GetAppStoragePath();
+    char path[PATH_MAX];
 
-    size_t pathLen = strlen(appStoragePath) + strlen(filepath) + 2;
-    char *path = RL_MALLOC(sizeof(char)*pathLen);
-    snprintf(path, pathLen, "%s/%s", appStoragePath, filepath);
+    if (JoinAppStoragePath(path, sizeof(path), filepath) < 0) return false;
 
     bool success = false;
 
@@ -386,7 +552,7 @@ bool WriteToAppStorage(const char *filepath, void *data, unsigned int dataSize){
         int count = (int)fwrite(data, sizeof(unsigned char), dataSize, file);
 
         if (count == 0) TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to write file", path);
-        else if (count != dataSize) TraceLog(LOG_WARNING, "FILEIO: [%s] File partially written", path);
+        else if ((unsigned int)count != dataSize) TraceLog(LOG_WARNING, "FILEIO: [%s] File partially written", path);
         else TraceLog(LOG_INFO, "FILEIO: [%s] File saved successfully", path);
 
         int result = fclose(file);
@@ -394,38 +560,93 @@ bool WriteToAppStorage(const char *filepath, void *data, unsigned int dataSize){
     }
     else TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to open file", path);
 
-    RL_FREE(appStoragePath);
-    RL_FREE(path);
-
     return success;
 }
 
+bool WriteToAppStorageAtomic(const char *filepath, const void *data, unsigned int dataSize)
+{
+    char path[PATH_MAX];
+    char tempPath[PATH_MAX];
+
+    if (JoinAppStoragePath(path, sizeof(path), filepath) < 0) return false;
+
+    // NOTE: Unique per call, concurrent writers of the same file (journal,
+    //       async or direct writes) never share a temporary file, the last rename wins
+    if (snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", path) >= (int)sizeof(tempPath)) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Path is too long", filepath);
+        return false;
+    }
+
+    int fd = mkostemp(tempPath, O_CLOEXEC);
+
+    if (fd < 0) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to open file", tempPath);
+        return false;
+    }
+
+    fchmod(fd, 0644);   // mkostemp() creates the file as 0600
+
+    const unsigned char *bytes = data;
+    unsigned int written = 0;
+
+    while (written < dataSize) {
+        ssize_t count = write(fd, bytes + written, dataSize - written);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        written += (unsigned int)count;
+    }
+
+    // NOTE: The data must reach the disk before the rename, otherwise a crash
+    //       could leave a renamed but empty file behind
+    bool success = (written == dataSize) && (fsync(fd) == 0);
+    success = (close(fd) == 0) && success;
+
+    if (!success) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to write file", tempPath);
+        unlink(tempPath);
+        return false;
+    }
+
+    if (rename(tempPath, path) != 0) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to replace file", path);
+        unlink(tempPath);
+        return false;
+    }
+
+    // Sync the parent directory so that the rename itself is durable
+    char *separator = strrchr(path, '/');
+
+    if (separator != NULL) {
+        *separator = '\0';
+        int dirFd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+        *separator = '/';
+    }
+
+    TraceLog(LOG_INFO, "FILEIO: [%s] File saved successfully", path);
+
+    return true;
+}
+
 bool IsFileExistsInAppStorage(const char *filepath){
 
-    char *appStoragePath = GetAppStoragePath();
+    char path[PATH_MAX];
 
-    size_t pathLen = strlen(appStoragePath) + strlen(filepath) + 2;
-    char *path = RL_MALLOC(sizeof(char)*pathLen);
-    snprintf(path, pathLen, "%s/%s", appStoragePath, filepath);
+    if (JoinAppStoragePath(path, sizeof(path), filepath) < 0) return false;
 
     bool success = (access(path, F_OK) != -1);
 
-    RL_FREE(appStoragePath);
-    RL_FREE(path);
-
     return success;
 }
 
 void RemoveFileInAppStorage(const char *filepath){
 
-    char *appStoragePath = GetAppStoragePath();
+    char path[PATH_MAX];
 
-    size_t pathLen = strlen(appStoragePath) + strlen(filepath) + 2;
-    char *path = RL_MALLOC(sizeof(char)*pathLen);
-    snprintf(path, pathLen, "%s/%s", appStoragePath, filepath);
+    if (JoinAppStoragePath(path, sizeof(path), filepath) < 0) return;
 
     remove(path);
-
-    RL_FREE(appStoragePath);
-    RL_FREE(path);
 }
@@ -0,0 +1,322 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "input_record.h"
+#include "ring_buffer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+/* DEFINES */
+
+#define INPUT_RECORD_INITIAL_CAPACITY   (64*1024)
+#define INPUT_RECORD_RING_CAPACITY      4096    // Sensor records between two drains
+#define INPUT_RECORD_DRAIN_PERIOD       50      // In ms, the ring holds ~4 s of events at 1 kHz
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    // NOTE: Sensor records are pushed without lock by the thread running SensorCallback(),
+    //       the recorder thread encodes them, so that thread never waits nor allocates
+    RingBuffer sensorRing;
+    int producers;              // Threads inside RecordInput() with a sensor record
+    int droppedRecords;         // Sensor records lost because the ring was full
+
+    pthread_mutex_t mutex;      // Encoded data, written by the recorder thread and by key records
+    pthread_cond_t cond;
+
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    int64_t lastTimestamp;
+
+    pthread_t thread;
+    bool stopping;              // Under the mutex, tells the recorder thread to leave
+
+    char *filepath;
+    bool recording;             // Atomic, checked before taking the lock
+
+} State = { .mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+/* INTERNAL FUNCTIONS */
+
+// Appends an encoded record, must be called with the mutex locked
+static void AppendInputRecord(const InputRecord *record)
+{
+    if (State.size + INPUT_RECORD_MAX_SIZE > State.capacity) {
+        size_t capacity = 2*State.capacity;
+        unsigned char *data = RL_REALLOC(State.data, capacity);
+
+        if (data != NULL) {
+            State.data = data;
+            State.capacity = capacity;
+        }
+    }
+
+    // NOTE: If the buffer could not grow the record is dropped, the recording stays valid
+    if (State.size + INPUT_RECORD_MAX_SIZE <= State.capacity) {
+        State.size += EncodeInputRecord(record, State.lastTimestamp, State.data + State.size);
+        State.lastTimestamp = record->timestamp;
+    }
+}
+
+// Moves the queued sensor records to the encoded data, recorder thread or after it is joined
+static void DrainSensorRecords(void)
+{
+    InputRecord records[32];
+    int count = 0;
+
+    while ((count = PopRingBuffer(&State.sensorRing, records, 32)) > 0) {
+        pthread_mutex_lock(&State.mutex);
+        for (int i = 0; i < count; i++) AppendInputRecord(&records[i]);
+        pthread_mutex_unlock(&State.mutex);
+    }
+}
+
+static void *RecorderThread(void *arg)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    while (!State.stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+
+        long long ns = deadline.tv_nsec + INPUT_RECORD_DRAIN_PERIOD*1000000LL;
+        deadline.tv_sec += (time_t)(ns/1000000000LL);
+        deadline.tv_nsec = (long)(ns%1000000000LL);
+
+        pthread_cond_timedwait(&State.cond, &State.mutex, &deadline);
+
+        pthread_mutex_unlock(&State.mutex);
+        DrainSensorRecords();
+        pthread_mutex_lock(&State.mutex);
+    }
+
+    pthread_mutex_unlock(&State.mutex);
+
+    return NULL;
+}
+
+void RecordInput(const InputRecord *record)
+{
+    // Sensor records, lock free and without allocation
+    if (record->kind == INPUT_RECORD_SENSOR) {
+        __atomic_add_fetch(&State.producers, 1, __ATOMIC_SEQ_CST);
+
+        // NOTE: Checked again once counted, StopInputRecording() waits for the
+        //       producers that saw the recording running before unloading the ring
+        if (__atomic_load_n(&State.recording, __ATOMIC_SEQ_CST) && PushRingBuffer(&State.sensorRing, record, 1) == 0) {
+            __atomic_add_fetch(&State.droppedRecords, 1, __ATOMIC_RELAXED);
+        }
+
+        __atomic_sub_fetch(&State.producers, 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    // Soft key records, rare and never from the sensor thread
+    pthread_mutex_lock(&State.mutex);
+    if (__atomic_load_n(&State.recording, __ATOMIC_RELAXED)) AppendInputRecord(record);
+    pthread_mutex_unlock(&State.mutex);
+}
+
+bool IsInputRecording(void)
+{
+    return __atomic_load_n(&State.recording, __ATOMIC_RELAXED);
+}
+
+// Records are appended as they arrive, but batched sensor events are older than a key
+// recorded meanwhile, the replay stops at the first record past its cursor so they are
+// sorted by timestamp before saving. Returns the sorted recording, or 'data' if already
+// sorted or out of memory (still a valid recording, only replayed in arrival order)
+static unsigned char *SortInputRecords(unsigned char *data, size_t *size)
+{
+    InputRecord record;
+    int64_t previous = 0;
+    int count = 0;
+    bool sorted = true;
+
+    for (size_t offset = INPUT_RECORD_HEADER_SIZE; offset < *size; count++) {
+        int recordSize = DecodeInputRecord(data + offset, *size - offset, previous, &record);
+        if (recordSize < 0) return data;
+
+        if (count > 0 && record.timestamp < previous) sorted = false;
+        previous = record.timestamp;
+        offset += recordSize;
+    }
+
+    if (sorted) return data;
+
+    InputRecord *records = RL_MALLOC(count*sizeof(InputRecord));
+    unsigned char *result = RL_MALLOC(INPUT_RECORD_HEADER_SIZE + (size_t)count*INPUT_RECORD_MAX_SIZE);
+
+    if (records == NULL || result == NULL) {
+        TraceLog(LOG_WARNING, "REPLAY: Not enough memory to sort the input recording, saved in arrival order");
+        RL_FREE(records);
+        RL_FREE(result);
+        return data;
+    }
+
+    previous = 0;
+
+    for (size_t offset = INPUT_RECORD_HEADER_SIZE, i = 0; offset < *size; i++) {
+        offset += DecodeInputRecord(data + offset, *size - offset, previous, &records[i]);
+        previous = records[i].timestamp;
+    }
+
+    // NOTE: Insertion sort, stable and linear when nearly sorted, records are
+    //       only displaced by the batch latency of the sensors
+    for (int i = 1; i < count; i++) {
+        InputRecord current = records[i];
+        int j = i;
+        for (; j > 0 && records[j - 1].timestamp > current.timestamp; j--) records[j] = records[j - 1];
+        records[j] = current;
+    }
+
+    memcpy(result, data, INPUT_RECORD_HEADER_SIZE);
+    *size = INPUT_RECORD_HEADER_SIZE;
+    previous = 0;
+
+    for (int i = 0; i < count; i++) {
+        *size += EncodeInputRecord(&records[i], previous, result + *size);
+        previous = records[i].timestamp;
+    }
+
+    RL_FREE(records);
+    RL_FREE(data);
+
+    return result;
+}
+
+/* PUBLIC API */
+
+bool StartInputRecording(const char *filepath)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    // NOTE: The data is only released once the previous recording is saved
+    if (State.recording || State.data != NULL) {
+        pthread_mutex_unlock(&State.mutex);
+        TraceLog(LOG_WARNING, "REPLAY: [%s] An input recording is already running", filepath);
+        return false;
+    }
+
+    size_t length = strlen(filepath);
+
+    State.data = RL_MALLOC(INPUT_RECORD_INITIAL_CAPACITY);
+    State.filepath = RL_MALLOC(length + 1);
+
+    if (State.data == NULL || State.filepath == NULL
+        || !LoadRingBuffer(&State.sensorRing, sizeof(InputRecord), INPUT_RECORD_RING_CAPACITY)) {
+        RL_FREE(State.data);
+        RL_FREE(State.filepath);
+        State.data = NULL;
+        State.filepath = NULL;
+        pthread_mutex_unlock(&State.mutex);
+        TraceLog(LOG_WARNING, "REPLAY: [%s] Failed to allocate input recording buffer", filepath);
+        return false;
+    }
+
+    memcpy(State.filepath, filepath, length + 1);
+    memcpy(State.data, INPUT_RECORD_MAGIC, 4);
+    State.data[4] = INPUT_RECORD_VERSION;
+    memset(State.data + 5, 0, INPUT_RECORD_HEADER_SIZE - 5);
+
+    State.size = INPUT_RECORD_HEADER_SIZE;
+    State.capacity = INPUT_RECORD_INITIAL_CAPACITY;
+    State.lastTimestamp = 0;
+    State.droppedRecords = 0;
+    State.stopping = false;
+
+    if (pthread_create(&State.thread, NULL, RecorderThread, NULL) != 0) {
+        UnloadRingBuffer(&State.sensorRing);
+        RL_FREE(State.data);
+        RL_FREE(State.filepath);
+        State.data = NULL;
+        State.filepath = NULL;
+        pthread_mutex_unlock(&State.mutex);
+        TraceLog(LOG_ERROR, "REPLAY: [%s] Failed to create input recorder thread", filepath);
+        return false;
+    }
+
+    pthread_setname_np(State.thread, "raymob-record");
+
+    __atomic_store_n(&State.recording, true, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_unlock(&State.mutex);
+
+    return true;
+}
+
+bool StopInputRecording(void)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    if (!State.recording) {
+        pthread_mutex_unlock(&State.mutex);
+        return false;
+    }
+
+    __atomic_store_n(&State.recording, false, __ATOMIC_SEQ_CST);
+
+    State.stopping = true;
+    pthread_cond_signal(&State.cond);
+    pthread_mutex_unlock(&State.mutex);
+
+    pthread_join(State.thread, NULL);
+
+    // NOTE: A sensor record may still be pushed by a producer that saw the recording running
+    while (__atomic_load_n(&State.producers, __ATOMIC_ACQUIRE) > 0) sched_yield();
+
+    DrainSensorRecords();
+    UnloadRingBuffer(&State.sensorRing);
+
+    int dropped = __atomic_load_n(&State.droppedRecords, __ATOMIC_RELAXED);
+    if (dropped > 0) TraceLog(LOG_WARNING, "REPLAY: %i sensor records dropped, input recording is incomplete", dropped);
+
+    pthread_mutex_lock(&State.mutex);
+
+    unsigned char *data = State.data;
+    size_t size = State.size;
+    char *filepath = State.filepath;
+
+    State.data = NULL;
+    State.filepath = NULL;
+
+    pthread_mutex_unlock(&State.mutex);
+
+    data = SortInputRecords(data, &size);
+
+    // NOTE: The file is only written here, recording never touches the disk
+    bool success = WriteToAppStorageAtomic(filepath, data, (unsigned int)size);
+
+    if (success) TraceLog(LOG_INFO, "REPLAY: [%s] Input recording saved (%i bytes)", filepath, (int)size);
+
+    RL_FREE(data);
+    RL_FREE(filepath);
+
+    return success;
+}
@@ -0,0 +1,93 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef RAYMOB_INPUT_RECORD_H
+#define RAYMOB_INPUT_RECORD_H
+
+#include "raymob.h"
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Binary format of input recordings, shared by the recorder (Android only)
+ * and the replay (Android and host builds).
+ *
+ * File: "RMIR", version byte, 3 padding bytes, then records until the end:
+ *
+ *     u8 kind, u8 id, u8 count,
+ *     timestamp delta to the previous record in ns (zigzag LEB128 varint),
+ *     count float values (little endian)
+ *
+ * Sensor records use the Sensor as id, soft keyboard records store the key
+ * code, unicode and label as values (all exactly representable as floats).
+ * Records are sorted by timestamp when the recording is saved.
+ */
+
+#define INPUT_RECORD_MAGIC          "RMIR"
+#define INPUT_RECORD_VERSION        1
+#define INPUT_RECORD_HEADER_SIZE    8
+#define INPUT_RECORD_MAX_VALUES     16
+#define INPUT_RECORD_MAX_SIZE       (3 + 10 + 4*INPUT_RECORD_MAX_VALUES)
+
+typedef enum {
+    INPUT_RECORD_SENSOR     = 1,
+    INPUT_RECORD_SOFT_KEY   = 2,
+} InputRecordKind;
+
+typedef struct InputRecord {
+    unsigned char kind;
+    unsigned char id;
+    unsigned char count;
+    int64_t timestamp;                          // In ns, CLOCK_BOOTTIME on Android
+    float values[INPUT_RECORD_MAX_VALUES];
+} InputRecord;
+
+/**
+ * @brief Encodes a record, 'out' must hold INPUT_RECORD_MAX_SIZE bytes.
+ *
+ * @return Number of bytes written.
+ */
+int EncodeInputRecord(const InputRecord *record, int64_t previousTimestamp, unsigned char *out);
+
+/**
+ * @brief Decodes a record.
+ *
+ * @return Number of bytes read, -1 if the data is truncated or invalid.
+ */
+int DecodeInputRecord(const unsigned char *data, size_t size, int64_t previousTimestamp, InputRecord *record);
+
+/* Recorder, called by the input modules (input_record.c) */
+
+// NOTE: Sensor records are pushed without lock nor allocation, they must come from a
+//       single thread at a time (the one running SensorCallback()), other kinds from any thread
+bool IsInputRecording(void);
+void RecordInput(const InputRecord *record);
+
+/* Replay sinks, implemented by the input modules of each platform */
+
+void ReplaySensorEvent(Sensor sensor, int64_t timestamp, const float *values, int count);
+void FlushReplayedSensorEvents(void);   // Waits until the replayed samples are visible to the game
+void ReplaySoftKey(int keyCode, int unicode, int label, int64_t timestamp);
+
+#endif //RAYMOB_INPUT_RECORD_H
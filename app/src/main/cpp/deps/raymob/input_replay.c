@@ -0,0 +1,238 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "input_record.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    unsigned char *data;
+    int size;
+    int offset;             // Offset of the next record
+
+    int64_t firstTimestamp;
+    int64_t lastTimestamp;  // Timestamp of the previously decoded record
+    int64_t cursor;         // Replayed time since the first record, in ns
+
+    bool active;            // Atomic, also read by the sensor thread
+
+} State = { 0 };
+
+/* INTERNAL FUNCTIONS */
+
+static unsigned char *LoadReplayFile(const char *filepath, int *size)
+{
+#if defined(PLATFORM_ANDROID)
+    return ReadFromAppStorage(filepath, size);
+#else
+    // NOTE: On host builds the path is used as is
+    FILE *file = fopen(filepath, "rb");
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = (length > 0) ? RL_MALLOC(length) : NULL;
+
+    if (data != NULL && fread(data, 1, length, file) != (size_t)length) {
+        RL_FREE(data);
+        data = NULL;
+    }
+
+    fclose(file);
+    *size = (data != NULL) ? (int)length : 0;
+
+    return data;
+#endif
+}
+
+/* FORMAT */
+
+int EncodeInputRecord(const InputRecord *record, int64_t previousTimestamp, unsigned char *out)
+{
+    int count = (record->count < INPUT_RECORD_MAX_VALUES) ? record->count : INPUT_RECORD_MAX_VALUES;
+    int size = 0;
+
+    out[size++] = record->kind;
+    out[size++] = record->id;
+    out[size++] = (unsigned char)count;
+
+    // NOTE: Sensors are batched independently, deltas can be negative, hence zigzag
+    int64_t delta = record->timestamp - previousTimestamp;
+    uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+
+    do {
+        unsigned char byte = zigzag & 0x7F;
+        zigzag >>= 7;
+        out[size++] = byte | (zigzag ? 0x80 : 0);
+    } while (zigzag);
+
+    // NOTE: Android and the supported hosts are little endian, floats are stored as is
+    memcpy(out + size, record->values, count*sizeof(float));
+
+    return size + count*(int)sizeof(float);
+}
+
+int DecodeInputRecord(const unsigned char *data, size_t size, int64_t previousTimestamp, InputRecord *record)
+{
+    if (size < 4) return -1;
+
+    record->kind = data[0];
+    record->id = data[1];
+    record->count = data[2];
+
+    if (record->count > INPUT_RECORD_MAX_VALUES) return -1;
+
+    size_t offset = 3;
+    uint64_t zigzag = 0;
+
+    for (int shift = 0; ; shift += 7) {
+        if (offset >= size || shift > 63) return -1;
+        unsigned char byte = data[offset++];
+        zigzag |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+
+    int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+    record->timestamp = previousTimestamp + delta;
+
+    size_t valuesSize = record->count*sizeof(float);
+    if (offset + valuesSize > size) return -1;
+
+    memcpy(record->values, data + offset, valuesSize);
+
+    return (int)(offset + valuesSize);
+}
+
+/* PUBLIC API */
+
+bool LoadInputReplay(const char *filepath)
+{
+    UnloadInputReplay();
+
+    int size = 0;
+    unsigned char *data = LoadReplayFile(filepath, &size);
+
+    if (data == NULL) {
+        TraceLog(LOG_WARNING, "REPLAY: [%s] Failed to load input recording", filepath);
+        return false;
+    }
+
+    if (size < INPUT_RECORD_HEADER_SIZE || memcmp(data, INPUT_RECORD_MAGIC, 4) != 0 || data[4] != INPUT_RECORD_VERSION) {
+        TraceLog(LOG_WARNING, "REPLAY: [%s] Invalid input recording", filepath);
+        RL_FREE(data);
+        return false;
+    }
+
+    State.data = data;
+    State.size = size;
+    State.offset = INPUT_RECORD_HEADER_SIZE;
+
+    // Peek the first record, replay time is relative to it
+
+    InputRecord first;
+    if (DecodeInputRecord(data + State.offset, size - State.offset, 0, &first) > 0) {
+        State.firstTimestamp = first.timestamp;
+    }
+
+    State.cursor = 0;
+    State.lastTimestamp = 0;
+
+    // NOTE: From now on, live sensor and keyboard input is ignored
+    __atomic_store_n(&State.active, true, __ATOMIC_RELEASE);
+
+    TraceLog(LOG_INFO, "REPLAY: [%s] Input recording loaded (%i bytes)", filepath, size);
+
+    return true;
+}
+
+void UnloadInputReplay(void)
+{
+    __atomic_store_n(&State.active, false, __ATOMIC_RELEASE);
+
+    RL_FREE(State.data);
+
+    State.data = NULL;
+    State.size = 0;
+    State.offset = 0;
+}
+
+int UpdateInputReplay(float seconds)
+{
+    if (!IsInputReplayActive()) return 0;
+
+    State.cursor += (int64_t)((double)seconds*1e9);
+
+    int count = 0;
+
+    while (State.offset < State.size) {
+        InputRecord record;
+        int size = DecodeInputRecord(State.data + State.offset, State.size - State.offset, State.lastTimestamp, &record);
+
+        if (size < 0) {
+            TraceLog(LOG_WARNING, "REPLAY: Truncated input recording, stopping");
+            State.offset = State.size;
+            break;
+        }
+
+        if (record.timestamp - State.firstTimestamp > State.cursor) break;
+
+        State.offset += size;
+        State.lastTimestamp = record.timestamp;
+
+        switch (record.kind) {
+            case INPUT_RECORD_SENSOR:
+                ReplaySensorEvent((Sensor)record.id, record.timestamp, record.values, record.count);
+                break;
+            case INPUT_RECORD_SOFT_KEY:
+                ReplaySoftKey((int)record.values[0], (int)record.values[1], (int)record.values[2], record.timestamp);
+                break;
+            default:
+                break;
+        }
+
+        count++;
+    }
+
+    // NOTE: Sensor samples may be dispatched by the sensor thread, the game
+    //       must read them in the frame they were replayed for
+    if (count > 0) FlushReplayedSensorEvents();
+
+    return count;
+}
+
+bool IsInputReplayActive(void)
+{
+    return __atomic_load_n(&State.active, __ATOMIC_ACQUIRE);
+}
+
+bool IsInputReplayFinished(void)
+{
+    return !IsInputReplayActive() || State.offset >= State.size;
+}
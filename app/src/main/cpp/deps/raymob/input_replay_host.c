@@ -0,0 +1,181 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+/*
+ * Host backend of the input replay, for desktop builds (without PLATFORM_ANDROID).
+ *
+ * Provides the sensor and soft keyboard functions of raymob.h from the
+ * replayed input only, so that game code can run under a recording on a
+ * desktop host. Build it with 'input_replay.c' and link raylib, e.g:
+ *
+ *     cc -I<raylib/src> -I<raymob> game.c input_replay.c input_replay_host.c -lraylib
+ *
+ * NOTE: Never built for Android, sensor.c and soft_keyboard.c are used there.
+ */
+
+#include "input_record.h"
+
+#include <string.h>
+
+#if !defined(PLATFORM_ANDROID)
+
+/* DEFINES */
+
+#define SENSOR_MAX_VALUES   16
+#define SENSOR_MAX_COUNT    64
+
+#define SOFT_KEY_QUEUE_CAPACITY     64
+
+#define KEYCODE_ENTER       66
+#define KEYCODE_DEL         67
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    float values[SENSOR_MAX_COUNT][SENSOR_MAX_VALUES];
+    int valueCounts[SENSOR_MAX_COUNT];      // 0 until the sensor appears in the recording
+
+    int keyCode;
+    int unicode;
+    int label;
+
+    SoftKeyEvent keyQueue[SOFT_KEY_QUEUE_CAPACITY];
+    int keyQueueCount;
+
+} State = { 0 };
+
+/* REPLAY SINKS */
+
+void ReplaySensorEvent(Sensor sensor, int64_t timestamp, const float *values, int count)
+{
+    if ((int)sensor < 0 || (int)sensor >= SENSOR_MAX_COUNT) return;
+    if (count > SENSOR_MAX_VALUES) count = SENSOR_MAX_VALUES;
+
+    memcpy(State.values[sensor], values, count*sizeof(float));
+    State.valueCounts[sensor] = count;
+}
+
+void FlushReplayedSensorEvents(void)
+{
+    // Nothing to wait for, samples are stored right away on the host
+}
+
+void ReplaySoftKey(int keyCode, int unicode, int label, int64_t timestamp)
+{
+    State.keyCode = keyCode;
+    State.unicode = unicode;
+    State.label = label;
+
+    // NOTE: Same as on Android, a recorded clear is not a key event
+    if (keyCode != 0 && State.keyQueueCount < SOFT_KEY_QUEUE_CAPACITY) {
+        State.keyQueue[State.keyQueueCount++] = (SoftKeyEvent){ keyCode, unicode, (unsigned short)label, timestamp };
+    }
+}
+
+/* PUBLIC API */
+
+bool IsSensorAvailable(Sensor sensor)
+{
+    return (int)sensor >= 0 && (int)sensor < SENSOR_MAX_COUNT && State.valueCounts[sensor] > 0;
+}
+
+Vector3 GetAccelerotmerAxis(void)
+{
+    const float *v = State.values[SENSOR_ACCELEROMETER];
+    return (Vector3){ v[0], v[1], v[2] };
+}
+
+Vector3 GetGyroscopeAxis(void)
+{
+    const float *v = State.values[SENSOR_GYROSCOPE];
+    return (Vector3){ v[0], v[1], v[2] };
+}
+
+int GetSensorValues(Sensor sensor, float *values, int maxValues)
+{
+    if (!IsSensorAvailable(sensor) || values == NULL) return 0;
+
+    int count = (State.valueCounts[sensor] < maxValues) ? State.valueCounts[sensor] : maxValues;
+    if (count > 0) memcpy(values, State.values[sensor], count*sizeof(float));
+
+    return (count > 0) ? count : 0;
+}
+
+int PollSoftKeyEvents(SoftKeyEvent *events, int maxEvents)
+{
+    if (events == NULL || maxEvents <= 0) return 0;
+
+    int count = (State.keyQueueCount < maxEvents) ? State.keyQueueCount : maxEvents;
+
+    memcpy(events, State.keyQueue, count*sizeof(SoftKeyEvent));
+    memmove(State.keyQueue, State.keyQueue + count, (State.keyQueueCount - count)*sizeof(SoftKeyEvent));
+    State.keyQueueCount -= count;
+
+    return count;
+}
+
+const char *GetSoftKeyboardCommittedText(void)
+{
+    return "";      // Input method text is not recorded
+}
+
+const char *GetSoftKeyboardComposingText(void)
+{
+    return "";
+}
+
+int GetLastSoftKeyCode(void)
+{
+    return State.keyCode;
+}
+
+unsigned short GetLastSoftKeyLabel(void)
+{
+    return (unsigned short)State.label;
+}
+
+int GetLastSoftKeyUnicode(void)
+{
+    return State.unicode;
+}
+
+char GetLastSoftKeyChar(void)
+{
+    switch (State.keyCode) {
+        case 0: return '\0';
+        case KEYCODE_ENTER: return '\n';
+        case KEYCODE_DEL: return '\b';
+        default: break;
+    }
+
+    return (State.unicode > 0xFF) ? '?' : (char)State.unicode;
+}
+
+void ClearLastSoftKey(void)
+{
+    State.keyCode = State.unicode = State.label = 0;
+}
+
+#endif //!PLATFORM_ANDROID
@@ -0,0 +1,299 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "bridge.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <stdint.h>
+
+/* TYPES */
+
+typedef struct {
+    uint32_t hash;
+    const char *name;       // NULL when the slot is empty
+    const char *value;
+} L10NEntry;
+
+typedef struct {
+    char *arena;            // Packed "name\0value\0" pairs, entries point into it
+    L10NEntry *entries;
+    uint32_t mask;          // Capacity - 1, the capacity is a power of two
+    int count;
+} L10NTable;
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    pthread_rwlock_t lock;
+    pthread_mutex_t loadMutex;
+
+    L10NTable current;
+
+    // NOTE: Strings returned by LookupL10NString() point into the arenas, the ones
+    //       of previous tables are never freed so that they stay valid for good
+    char **retiredArenas;
+    int retiredCount;
+
+    // Atomics, the table is up to date when both are equal. The UI thread only
+    // bumps the requested generation, so a load in flight can never hide it
+    uint32_t requestedGeneration;
+    uint32_t loadedGeneration;
+
+} State = {
+    .lock = PTHREAD_RWLOCK_INITIALIZER,
+    .loadMutex = PTHREAD_MUTEX_INITIALIZER,
+    .requestedGeneration = 1
+};
+
+/* INTERNAL FUNCTIONS */
+
+static uint32_t HashL10NName(const char *name)
+{
+    // FNV-1a, resource names are short identifiers
+    uint32_t hash = 2166136261u;
+    while (*name) hash = (hash ^ (unsigned char)*name++)*16777619u;
+    return hash;
+}
+
+static void FreeL10NTable(L10NTable *table)
+{
+    RL_FREE(table->arena);
+    RL_FREE(table->entries);
+    *table = (L10NTable){ 0 };
+}
+
+static void RetireL10NTable(L10NTable *table)
+{
+    // NOTE: Locale changes are rare, a few arenas at most are kept
+    if (table->arena != NULL) {
+        char **arenas = RL_REALLOC(State.retiredArenas, (State.retiredCount + 1)*sizeof(char *));
+        if (arenas == NULL) {
+            TraceLog(LOG_WARNING, "RAYMOB: Failed to retire the L10N table, its strings are leaked");
+        }
+        else {
+            arenas[State.retiredCount++] = table->arena;
+            State.retiredArenas = arenas;
+        }
+    }
+
+    RL_FREE(table->entries);
+    *table = (L10NTable){ 0 };
+}
+
+static bool BuildL10NTable(L10NTable *table, char *arena, size_t size)
+{
+    // Count the pairs first, a trailing name without value is ignored
+
+    int count = 0;
+    for (size_t i = 0, fields = 0; i < size; i++) {
+        if (arena[i] == '\0' && (++fields%2) == 0) count++;
+    }
+
+    // NOTE: At most half full, probe sequences stay short
+    uint32_t capacity = 16;
+    while (capacity < 2*(uint32_t)count) capacity <<= 1;
+
+    L10NEntry *entries = RL_CALLOC(capacity, sizeof(L10NEntry));
+    if (entries == NULL) return false;
+
+    const char *end = arena + size;
+    const char *cursor = arena;
+
+    for (int i = 0; i < count; i++) {
+        const char *name = cursor;
+        const char *value = name + strlen(name) + 1;
+        cursor = value + strlen(value) + 1;
+        if (cursor > end) break;
+
+        uint32_t hash = HashL10NName(name);
+        uint32_t slot = hash & (capacity - 1);
+
+        while (entries[slot].name != NULL && strcmp(entries[slot].name, name) != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        entries[slot] = (L10NEntry){ hash, name, value };
+    }
+
+    *table = (L10NTable){ arena, entries, capacity - 1, count };
+
+    return true;
+}
+
+static bool FetchL10NTable(L10NTable *table)
+{
+    const RaymobBridge *bridge = GetBridge();
+
+    if (bridge == NULL || bridge->getPackedStrings == NULL) return false;
+
+    JNIEnv* env = GetThreadJNIEnv();
+
+    // NOTE: One Java call for all strings, then one copy out of the byte array
+    jbyteArray packed = (jbyteArray)(*env)->CallObjectMethod(env, bridge->nativeLoader, bridge->getPackedStrings);
+
+    if ((*env)->ExceptionCheck(env)) {
+        (*env)->ExceptionClear(env);
+        packed = NULL;
+    }
+
+    if (packed == NULL) return false;
+
+    jsize size = (*env)->GetArrayLength(env, packed);
+    char *arena = RL_MALLOC(size + 1);
+
+    if (arena == NULL) {
+        (*env)->DeleteLocalRef(env, packed);
+        return false;
+    }
+
+    (*env)->GetByteArrayRegion(env, packed, 0, size, (jbyte *)arena);
+    (*env)->DeleteLocalRef(env, packed);
+
+    arena[size] = '\0';     // Guards the last string if the blob is not terminated
+
+    if (!BuildL10NTable(table, arena, (size_t)size)) {
+        RL_FREE(arena);
+        return false;
+    }
+
+    return true;
+}
+
+static bool IsL10NTableCurrent(void)
+{
+    return __atomic_load_n(&State.loadedGeneration, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&State.requestedGeneration, __ATOMIC_ACQUIRE);
+}
+
+static void EnsureL10NTable(void)
+{
+    if (IsL10NTableCurrent()) return;
+
+    pthread_mutex_lock(&State.loadMutex);
+
+    uint32_t generation = 0;
+
+    while ((generation = __atomic_load_n(&State.requestedGeneration, __ATOMIC_ACQUIRE)) !=
+           __atomic_load_n(&State.loadedGeneration, __ATOMIC_ACQUIRE)) {
+        L10NTable table = { 0 };
+        bool fetched = FetchL10NTable(&table);
+
+        // The locale changed during the fetch, the table may come from the old one
+        if (generation != __atomic_load_n(&State.requestedGeneration, __ATOMIC_ACQUIRE)) {
+            FreeL10NTable(&table);
+            continue;
+        }
+
+        if (fetched) {
+            pthread_rwlock_wrlock(&State.lock);
+            RetireL10NTable(&State.current);
+            State.current = table;
+            pthread_rwlock_unlock(&State.lock);
+
+            TraceLog(LOG_INFO, "RAYMOB: L10N table loaded (%i strings)", table.count);
+        }
+        else TraceLog(LOG_WARNING, "RAYMOB: Failed to load the L10N table");
+
+        // NOTE: Also set on failure, otherwise every lookup would retry the Java call
+        __atomic_store_n(&State.loadedGeneration, generation, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&State.loadMutex);
+}
+
+/* NATIVE METHODS */
+
+void JNICALL OnLocaleChanged(JNIEnv *env, jobject obj)
+{
+    // NOTE: Called on the UI thread, the table is reloaded on the next lookup
+    __atomic_add_fetch(&State.requestedGeneration, 1, __ATOMIC_ACQ_REL);
+}
+
+/* PUBLIC API */
+
+const char *LookupL10NString(const char *value)
+{
+    if (value == NULL) return NULL;
+
+    EnsureL10NTable();
+
+    const char *result = NULL;
+    uint32_t hash = HashL10NName(value);
+
+    pthread_rwlock_rdlock(&State.lock);
+
+    const L10NTable *table = &State.current;
+
+    if (table->entries != NULL) {
+        for (uint32_t slot = hash & table->mask; table->entries[slot].name != NULL; slot = (slot + 1) & table->mask) {
+            const L10NEntry *entry = &table->entries[slot];
+            if (entry->hash == hash && strcmp(entry->name, value) == 0) {
+                result = entry->value;
+                break;
+            }
+        }
+    }
+
+    pthread_rwlock_unlock(&State.lock);
+
+    return result;
+}
+
+char* GetL10NString(const char* value)
+{
+    const char *string = LookupL10NString(value);
+    if (string == NULL) return NULL;
+
+    size_t size = strlen(string) + 1;
+
+    // Allocate memory for returned string
+    char* stringValue = RL_MALLOC(size);
+    if (stringValue != NULL) memcpy(stringValue, string, size);
+
+    return stringValue;
+}
+
+int GetL10NStringInto(const char *value, char *dst, size_t cap)
+{
+    const char *string = LookupL10NString(value);
+    if (string == NULL) return -1;
+
+    size_t len = strlen(string);
+
+    if (dst != NULL && cap > 0) {
+        size_t copied = (len < cap) ? len : cap - 1;
+
+        // NOTE: Like snprintf(), but never cuts a UTF-8 sequence in half
+        if (copied < len) {
+            while (copied > 0 && ((unsigned char)string[copied] & 0xC0) == 0x80) copied--;
+        }
+
+        memcpy(dst, string, copied);
+        dst[copied] = '\0';
+    }
+
+    return (int)len;
+}
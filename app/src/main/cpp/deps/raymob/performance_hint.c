@@ -0,0 +1,327 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "raymob.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#if defined(PLATFORM_ANDROID)
+    #include <dlfcn.h>
+    #include <unistd.h>
+#endif
+
+// NOTE: The drawing hooks of raymob.h must not replace the raylib functions they call
+#undef BeginDrawing
+#undef EndDrawing
+
+/* DEFINES */
+
+#define PERFORMANCE_HINT_MAX_THREADS    16
+#define PERFORMANCE_HINT_DEFAULT_TARGET 16666667LL     // 60 FPS, in nanoseconds
+
+/* TYPES */
+
+// NOTE: Resolved at runtime, APerformanceHint only exists since API 33,
+//       the manager and session are opaque so their types are not needed
+
+typedef void *(*GetManagerFunc)(void);
+typedef void *(*CreateSessionFunc)(void *manager, const int32_t *threadIds, size_t size, int64_t initialTargetWorkDurationNanos);
+typedef int (*UpdateTargetWorkDurationFunc)(void *session, int64_t targetDurationNanos);
+typedef int (*ReportActualWorkDurationFunc)(void *session, int64_t actualDurationNanos);
+typedef void (*CloseSessionFunc)(void *session);
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    GetManagerFunc getManager;
+    CreateSessionFunc createSession;
+    UpdateTargetWorkDurationFunc updateTargetWorkDuration;
+    ReportActualWorkDurationFunc reportActualWorkDuration;
+    CloseSessionFunc closeSession;
+
+    void *session;              // NULL if no session is open
+
+    int64_t target;             // Last target reported to the session
+    int64_t fixedTarget;        // Set by SetPerformanceHintTarget(), 0 to follow the pacer
+
+    int64_t frameStart;
+    bool frameStarted;
+    bool startedAtEnd;          // Frame started by EndHintedDrawing(), the pacer wait is inside it
+
+} State = { 0 };
+
+/* INTERNAL FUNCTIONS */
+
+static int64_t GetMonotonicTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec*1000000000LL + now.tv_nsec;
+}
+
+#if defined(PLATFORM_ANDROID)
+
+static bool LoadPerformanceHintFunctions(void)
+{
+    if (State.createSession != NULL) return true;
+
+    void *libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_NOLOAD);
+    if (libandroid == NULL) return false;
+
+    State.getManager = (GetManagerFunc)dlsym(libandroid, "APerformanceHint_getManager");
+    State.createSession = (CreateSessionFunc)dlsym(libandroid, "APerformanceHint_createSession");
+    State.updateTargetWorkDuration = (UpdateTargetWorkDurationFunc)dlsym(libandroid, "APerformanceHint_updateTargetWorkDuration");
+    State.reportActualWorkDuration = (ReportActualWorkDurationFunc)dlsym(libandroid, "APerformanceHint_reportActualWorkDuration");
+    State.closeSession = (CloseSessionFunc)dlsym(libandroid, "APerformanceHint_closeSession");
+
+    dlclose(libandroid);    // NOTE: Still loaded, we are linked against it
+
+    if (State.getManager == NULL || State.createSession == NULL || State.updateTargetWorkDuration == NULL ||
+        State.reportActualWorkDuration == NULL || State.closeSession == NULL) {
+        State.createSession = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static int32_t GetCallingThreadId(void)
+{
+    return (int32_t)gettid();
+}
+
+static int64_t GetPacerWait(void)
+{
+    return (int64_t)((double)GetFramePacerWaitTime()*1e9);
+}
+
+#else
+
+// Stand-in for host builds, without the NDK the reports are only logged
+
+static void *HostGetManager(void)
+{
+    static int manager = 0;
+    return &manager;
+}
+
+static void *HostCreateSession(void *manager, const int32_t *threadIds, size_t size, int64_t initialTargetWorkDurationNanos)
+{
+    static int session = 0;
+    TraceLog(LOG_DEBUG, "RAYMOB: Performance hint session created (%i threads, target %.3f ms)",
+             (int)size, (double)initialTargetWorkDurationNanos*1e-6);
+    return &session;
+}
+
+static int HostUpdateTargetWorkDuration(void *session, int64_t targetDurationNanos)
+{
+    TraceLog(LOG_DEBUG, "RAYMOB: Performance hint target %.3f ms", (double)targetDurationNanos*1e-6);
+    return 0;
+}
+
+static int HostReportActualWorkDuration(void *session, int64_t actualDurationNanos)
+{
+    TraceLog(LOG_DEBUG, "RAYMOB: Performance hint actual %.3f ms", (double)actualDurationNanos*1e-6);
+    return 0;
+}
+
+static void HostCloseSession(void *session)
+{
+    TraceLog(LOG_DEBUG, "RAYMOB: Performance hint session closed");
+}
+
+static bool LoadPerformanceHintFunctions(void)
+{
+    State.getManager = HostGetManager;
+    State.createSession = HostCreateSession;
+    State.updateTargetWorkDuration = HostUpdateTargetWorkDuration;
+    State.reportActualWorkDuration = HostReportActualWorkDuration;
+    State.closeSession = HostCloseSession;
+
+    return true;
+}
+
+static int32_t GetCallingThreadId(void)
+{
+    return 0;
+}
+
+static int64_t GetPacerWait(void)
+{
+    return 0;   // No frame pacer on the host
+}
+
+#endif
+
+static int64_t GetWantedTarget(void)
+{
+    if (State.fixedTarget > 0) return State.fixedTarget;
+
+#if defined(PLATFORM_ANDROID)
+    // NOTE: The pacer interval is the actual frame budget, otherwise assume 60 FPS
+    if (IsFramePacerReady()) {
+        int64_t interval = (int64_t)((double)GetFramePacerInterval()*1e9);
+        if (interval > 0) return interval;
+    }
+#endif
+
+    return PERFORMANCE_HINT_DEFAULT_TARGET;
+}
+
+static void UpdateTarget(void)
+{
+    int64_t target = GetWantedTarget();
+
+    // The pacer interval is refined on every vsync, ignore changes under 1%
+    int64_t delta = (target > State.target) ? target - State.target : State.target - target;
+    if (delta*100 <= State.target) return;
+
+    if (State.updateTargetWorkDuration(State.session, target) == 0) {
+        State.target = target;
+    }
+}
+
+static void ReportFrame(int64_t end, int64_t excluded)
+{
+    int64_t actual = end - State.frameStart - excluded;
+    State.frameStarted = false;
+
+    if (State.session == NULL) return;
+
+    UpdateTarget();
+
+    // NOTE: The session rejects durations that are not positive
+    if (actual > 0) State.reportActualWorkDuration(State.session, actual);
+}
+
+/* PUBLIC API */
+
+bool InitPerformanceHint(const int *threadIds, int count)
+{
+    if (State.session != NULL) ClosePerformanceHint();
+
+    if (!LoadPerformanceHintFunctions()) {
+        TraceLog(LOG_INFO, "RAYMOB: Performance hints are not supported (API 33 required)");
+        return false;
+    }
+
+    void *manager = State.getManager();
+    if (manager == NULL) {
+        TraceLog(LOG_INFO, "RAYMOB: Performance hints are not supported by this device");
+        return false;
+    }
+
+    // The calling thread (the render thread) is always part of the session
+
+    int32_t threads[PERFORMANCE_HINT_MAX_THREADS] = { GetCallingThreadId() };
+    int threadCount = 1;
+
+    for (int i = 0; i < count && threadCount < PERFORMANCE_HINT_MAX_THREADS; i++) {
+        if (threadIds[i] > 0 && threadIds[i] != threads[0]) threads[threadCount++] = (int32_t)threadIds[i];
+    }
+
+    if (count > PERFORMANCE_HINT_MAX_THREADS - 1) {
+        TraceLog(LOG_WARNING, "RAYMOB: Performance hint session limited to %i threads", PERFORMANCE_HINT_MAX_THREADS);
+    }
+
+    State.target = GetWantedTarget();
+    State.session = State.createSession(manager, threads, (size_t)threadCount, State.target);
+
+    if (State.session == NULL) {
+        TraceLog(LOG_WARNING, "RAYMOB: Failed to create performance hint session");
+        return false;
+    }
+
+    State.frameStarted = false;
+
+    return true;
+}
+
+void ClosePerformanceHint(void)
+{
+    if (State.session == NULL) return;
+
+    State.closeSession(State.session);
+    State.session = NULL;
+    State.frameStarted = false;
+}
+
+bool IsPerformanceHintReady(void)
+{
+    return (State.session != NULL);
+}
+
+void SetPerformanceHintTarget(float seconds)
+{
+    State.fixedTarget = (seconds > 0.0f) ? (int64_t)((double)seconds*1e9) : 0;
+}
+
+void BeginPerformanceHintFrame(void)
+{
+    State.frameStart = GetMonotonicTime();
+    State.frameStarted = true;
+    State.startedAtEnd = false;
+}
+
+void EndPerformanceHintFrame(void)
+{
+    if (State.frameStarted) ReportFrame(GetMonotonicTime(), 0);
+}
+
+void BeginHintedDrawing(void)
+{
+#if defined(RAYMOB_PERFORMANCE_HINT)
+    static bool defaultInit = false;
+    if (!defaultInit) {
+        defaultInit = true;
+        if (State.session == NULL) InitPerformanceHint(NULL, 0);
+    }
+#endif
+
+    // NOTE: Normally already started when the previous frame ended,
+    //       so that the update before BeginDrawing() is measured too
+    if (!State.frameStarted) BeginPerformanceHintFrame();
+
+    BeginDrawing();
+}
+
+void EndHintedDrawing(void)
+{
+    if (State.frameStarted) {
+        // The pacer slept between the previous EndDrawing() and this frame
+        int64_t waited = State.startedAtEnd ? GetPacerWait() : 0;
+        ReportFrame(GetMonotonicTime(), waited);
+    }
+
+    // NOTE: Swapping buffers and the wait of SetTargetFPS() are not work,
+    //       the next frame starts once they are done
+    EndDrawing();
+
+    BeginPerformanceHintFrame();
+    State.startedAtEnd = true;
+}
@@ -25,15 +25,52 @@
 #ifndef RAYMOB_H
 #define RAYMOB_H
 
-#include "android_native_app_glue.h"
+// NOTE: Without PLATFORM_ANDROID only the platform independent declarations
+//       remain, so that game code can be built on a host (see input replay)
+#if defined(PLATFORM_ANDROID)
+    #include "android_native_app_glue.h"
+    #include "jni.h"
+#endif
+
 #include "raylib.h"
-#include "jni.h"
+#include <stddef.h>
+#include <stdint.h>
 
 /* ENUMS */
 
 typedef enum {
-    SENSOR_ACCELEROMETER    = 0,
-    SENSOR_GYROSCOPE        = 1,
+    SENSOR_ACCELEROMETER                            = 0,
+    SENSOR_GYROSCOPE                                = 1,
+    SENSOR_MAGNETIC_FIELD                           = 2,
+    SENSOR_LIGHT                                    = 3,
+    SENSOR_PRESSURE                                 = 4,
+    SENSOR_PROXIMITY                                = 5,
+    SENSOR_GRAVITY                                  = 6,
+    SENSOR_LINEAR_ACCELERATION                      = 7,
+    SENSOR_ROTATION_VECTOR                          = 8,
+    SENSOR_RELATIVE_HUMIDITY                        = 9,
+    SENSOR_AMBIENT_TEMPERATURE                      = 10,
+    SENSOR_MAGNETIC_FIELD_UNCALIBRATED              = 11,
+    SENSOR_GAME_ROTATION_VECTOR                     = 12,
+    SENSOR_GYROSCOPE_UNCALIBRATED                   = 13,
+    SENSOR_SIGNIFICANT_MOTION                       = 14,
+    SENSOR_STEP_DETECTOR                            = 15,
+    SENSOR_STEP_COUNTER                             = 16,
+    SENSOR_GEOMAGNETIC_ROTATION_VECTOR              = 17,
+    SENSOR_HEART_RATE                               = 18,
+    SENSOR_POSE_6DOF                                = 19,
+    SENSOR_STATIONARY_DETECT                        = 20,
+    SENSOR_MOTION_DETECT                            = 21,
+    SENSOR_HEART_BEAT                               = 22,
+    SENSOR_LOW_LATENCY_OFFBODY_DETECT               = 23,
+    SENSOR_ACCELEROMETER_UNCALIBRATED               = 24,
+    SENSOR_HINGE_ANGLE                              = 25,
+    SENSOR_HEAD_TRACKER                             = 26,
+    SENSOR_ACCELEROMETER_LIMITED_AXES               = 27,
+    SENSOR_GYROSCOPE_LIMITED_AXES                   = 28,
+    SENSOR_ACCELEROMETER_LIMITED_AXES_UNCALIBRATED  = 29,
+    SENSOR_GYROSCOPE_LIMITED_AXES_UNCALIBRATED      = 30,
+    SENSOR_HEADING                                  = 31,
 } Sensor;
 
 typedef enum {
@@ -44,11 +81,97 @@ typedef enum {
     ORIENTATION_OTHER              = -1,
 } Orientation;
 
+typedef enum {
+    MAP_ACCESS_NORMAL       = 0,    // No particular access pattern
+    MAP_ACCESS_SEQUENTIAL   = 1,    // Read from start to end, aggressive read-ahead
+    MAP_ACCESS_RANDOM       = 2,    // Scattered reads, no read-ahead
+} MapAccess;
+
+
+typedef enum {
+    STREAM_READ     = 0,    // Read from the start of an existing file
+    STREAM_WRITE    = 1,    // Create or truncate the file, then write
+    STREAM_APPEND   = 2,    // Create the file if needed, writes always go to the end
+} StreamMode;
+
+typedef enum {
+    STORAGE_PRIORITY_LOW    = 0,
+    STORAGE_PRIORITY_NORMAL = 1,
+    STORAGE_PRIORITY_HIGH   = 2,
+} StoragePriority;
+
+typedef enum {
+    STORAGE_REQUEST_INVALID    = -1,    // Unknown handle, or already dispatched
+    STORAGE_REQUEST_PENDING    = 0,
+    STORAGE_REQUEST_RUNNING    = 1,
+    STORAGE_REQUEST_DONE       = 2,
+    STORAGE_REQUEST_FAILED     = 3,
+    STORAGE_REQUEST_CANCELLED  = 4,
+} StorageRequestStatus;
+
+typedef enum {
+    HAPTIC_EFFECT_CLICK         = 0,    // Same values as VibrationEffect.EFFECT_*
+    HAPTIC_EFFECT_DOUBLE_CLICK  = 1,
+    HAPTIC_EFFECT_TICK          = 2,
+    HAPTIC_EFFECT_HEAVY_CLICK   = 5,
+} HapticEffect;
+
+typedef enum {
+    FRAME_RATE_COMPATIBILITY_DEFAULT        = 0,    // Same values as ANATIVEWINDOW_FRAME_RATE_COMPATIBILITY_*
+    FRAME_RATE_COMPATIBILITY_FIXED_SOURCE   = 1,    // Content with a fixed rate (e.g. video), avoids pull-down
+} FrameRateCompatibility;
+
+
+/* STRUCTS */
+
+typedef struct StorageStream StorageStream;    // Opaque handle of an open file stream
+typedef struct TextBuffer TextBuffer;          // Opaque editable UTF-8 text, see text_buffer.c
+
+typedef struct SensorEvent {
+    int64_t timestamp;              // Time of the sample in nanoseconds (CLOCK_BOOTTIME)
+    float x, y, z;                  // First three sensor values, unused ones are zero
+} SensorEvent;
+
+typedef struct SoftKeyEvent {
+    int keyCode;                    // Android key code (KEYCODE_*)
+    int unicode;                    // Unicode character produced by the key, zero if none
+    unsigned short label;           // Primary character displayed on the key
+    int64_t timestamp;              // Time of the key release in nanoseconds (CLOCK_BOOTTIME)
+} SoftKeyEvent;
+
+typedef struct DisplayInsets {
+    int left, top, right, bottom;   // In pixels
+} DisplayInsets;
+
+typedef struct DisplayState {
+    Orientation orientation;
+    float refreshRate;              // In Hz, 0 until the first state is received
+    DisplayInsets safeArea;         // Area covered by the system bars and the display cutout
+    DisplayInsets cutout;           // Area covered by the display cutout only (API 28+)
+    int imeHeight;                  // Height of the soft keyboard, 0 when hidden (API 30+)
+    unsigned int generation;        // Incremented on every change, 0 until the first state is received
+} DisplayState;
+
+typedef struct MappedFile {
+    const unsigned char *data;      // Read-only view of the file content, NULL on failure
+    size_t size;                    // Size of the view in bytes
+} MappedFile;
+
 
 /* Callback define */
 
 typedef void (*Callback)();
 
+/* Asynchronous storage request handle, 0 is never a valid request */
+
+typedef unsigned int StorageRequest;
+
+/* Haptic pattern handle, 0 is never a valid pattern */
+
+typedef unsigned int HapticPattern;
+
+typedef void (*StorageCallback)(StorageRequest request, StorageRequestStatus status, void *data, int dataSize, void *userData);
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -63,20 +186,42 @@ extern "C" {
  *
  * @return Pointer to the Android application object.
  */
+#if defined(PLATFORM_ANDROID)
 struct android_app *GetAndroidApp(void);
+#endif
 
 
 /* Helper functions */
 
+#if defined(PLATFORM_ANDROID)
+
+/**
+ * @brief Returns the JNIEnv of the calling thread, attaching it to the Java VM if needed.
+ *
+ * The thread is attached only once, on its first call, and is automatically
+ * detached when it exits. Threads already attached elsewhere are never detached.
+ * This makes it safe to call raymob functions from your own worker threads.
+ *
+ * @note Since the thread may never return to Java, local references are not freed
+ * automatically, delete them with DeleteLocalRef() once you are done with them.
+ *
+ * @return Pointer to the JNIEnv structure, NULL if the thread could not be attached.
+ */
+JNIEnv* GetThreadJNIEnv(void);
+
 /**
  * @brief Attaches the current native thread to the Java VM environment.
  *
+ * Same as GetThreadJNIEnv(), kept for compatibility.
+ *
  * @return Pointer to the JNIEnv structure.
  */
 JNIEnv* AttachCurrentThread(void);
 
 /**
  * @brief Detaches the current native thread from the Java VM environment.
+ *
+ * @deprecated Does nothing, threads are now detached automatically when they exit.
  */
 void DetachCurrentThread(void);
 
@@ -87,6 +232,8 @@ void DetachCurrentThread(void);
  */
 jobject GetNativeLoaderInstance(void);
 
+#endif //PLATFORM_ANDROID
+
 /**
  * @brief Gets the cache directory path of the Android application.
  *
@@ -97,6 +244,30 @@ jobject GetNativeLoaderInstance(void);
  */
 char* GetCacheDir(void);
 
+/**
+ * @brief Copies the cache directory path into a caller-provided buffer.
+ *
+ * Allocation-free variant of GetCacheDir(), the path is truncated if it does not fit.
+ *
+ * @param dst Buffer receiving the null-terminated path, can be NULL to query the length.
+ * @param cap Capacity of the buffer in bytes.
+ * @return Length of the full path (without null terminator), or -1 if unavailable.
+ */
+int GetCacheDirInto(char *dst, size_t cap);
+
+/**
+ * @brief Builds the full path of a file in the cache directory.
+ *
+ * The cache directory is resolved only once, this function makes no JNI call
+ * and no allocation, the path is written into the buffer provided.
+ *
+ * @param dst Buffer receiving the null-terminated path.
+ * @param cap Capacity of the buffer in bytes (PATH_MAX is always enough).
+ * @param fileName Name of the file relative to the cache directory.
+ * @return Length of the path written, or -1 if the buffer is too small or the directory is unavailable.
+ */
+int JoinCacheDirPath(char *dst, size_t cap, const char *fileName);
+
 /**
  * @brief Read file from cache directory, the readFile from raylib is reserved to read in Assets folder.
  *
@@ -105,6 +276,38 @@ char* GetCacheDir(void);
  */
 char* LoadCacheFile(const char* fileName);
 
+/**
+ * @brief Reads a text file from cache directory into a caller-provided buffer.
+ *
+ * Allocation-free variant of LoadCacheFile(), the text is always null-terminated
+ * and truncated if it does not fit.
+ *
+ * @param fileName Name of the file relative to the cache directory.
+ * @param dst Buffer receiving the text, can be NULL to query the size.
+ * @param cap Capacity of the buffer in bytes, null terminator included.
+ * @return Size of the file in bytes (truncated if >= cap), or -1 on failure.
+ */
+int LoadCacheFileInto(const char *fileName, char *dst, size_t cap);
+
+/**
+ * @brief Maps a file of the cache directory into memory, read-only.
+ *
+ * The content is not copied, pages are loaded by the kernel when accessed.
+ * Prefer this to LoadCacheFile() for large files that are consumed in place.
+ *
+ * @param fileName Name of the file relative to the cache directory.
+ * @param access Expected access pattern, given to the kernel as a hint.
+ * @return The mapped file, 'data' is NULL on failure or if the file is empty.
+ */
+MappedFile MapCacheFile(const char *fileName, MapAccess access);
+
+/**
+ * @brief Unmaps a file mapped with MapCacheFile().
+ *
+ * @param file The mapped file to release.
+ */
+void UnmapCacheFile(MappedFile file);
+
 /**
  * @brief Get localized string resource by name L10N.
  *
@@ -118,9 +321,41 @@ char* LoadCacheFile(const char* fileName);
  */
 char* GetL10NString(const char* value);
 
+/**
+ * @brief Looks up a localized string resource by name L10N, without any copy.
+ *
+ * All string resources are loaded into a native table by the first lookup,
+ * and reloaded after a locale change, so lookups never cross into Java.
+ *
+ * @warning The returned string is owned by raymob and must not be freed.
+ * It remains valid for the lifetime of the process, even after a locale change.
+ *
+ * @param value string resource name
+ * @return localized string, or NULL if not found
+ */
+const char *LookupL10NString(const char *value);
+
+/**
+ * @brief Copies a localized string resource into a caller-provided buffer.
+ *
+ * Allocation-free variant of GetL10NString(), with snprintf() semantics: if the
+ * string does not fit, it is truncated (at a UTF-8 character boundary) and
+ * null-terminated, and the full length is returned.
+ *
+ * @param value string resource name
+ * @param dst Buffer receiving the null-terminated string, can be NULL to query the length.
+ * @param cap Capacity of the buffer in bytes.
+ * @return Length of the string in bytes (without null terminator), or -1 if not found.
+ */
+int GetL10NStringInto(const char *value, char *dst, size_t cap);
+
 
 /* Vibrator functions */
 
+// NOTE: Vibrations are queued and executed by a background thread, the calls
+//       below never block. One-shots requested within 20ms of each other are
+//       merged into one, with the longest duration and strongest intensity.
+
 /**
  * @brief Initiates device vibration for the specified duration in seconds.
  *
@@ -151,6 +386,51 @@ void VibrateEx(float seconds, float intensity);
  */
 void VibrateExMS(uint64_t ms, float intensity);
 
+/**
+ * @brief Stops the current vibration, after the vibrations queued before.
+ */
+void CancelVibration(void);
+
+/**
+ * @brief Creates a vibration waveform once, to be played later in a single call.
+ *
+ * Alternates off and on segments, starting with off, like Vibrator.vibrate(long[]).
+ * Call it at load time, not every frame, the waveform is built through JNI.
+ *
+ * @param timings Durations of the segments in milliseconds.
+ * @param amplitudes Amplitudes of the segments (0 to 255, -1 for the device default),
+ *                   NULL to alternate between off and the device default.
+ *                   Ignored below Android 8.0 (API 26).
+ * @param count Number of segments.
+ * @return Pattern handle, 0 on failure.
+ */
+HapticPattern LoadHapticPattern(const int64_t *timings, const int *amplitudes, int count);
+
+/**
+ * @brief Creates a predefined haptic effect, played like a pattern.
+ *
+ * Uses the effect tuned by the device on Android 10 (API 29) and above, and an
+ * equivalent short one-shot on older versions.
+ *
+ * @param effect Predefined effect.
+ * @return Pattern handle, 0 on failure.
+ */
+HapticPattern LoadHapticEffect(HapticEffect effect);
+
+/**
+ * @brief Releases a pattern, it can no longer be played.
+ *
+ * @param pattern Pattern handle.
+ */
+void UnloadHapticPattern(HapticPattern pattern);
+
+/**
+ * @brief Plays a pattern, queued like the other vibrations.
+ *
+ * @param pattern Pattern handle.
+ */
+void PlayHapticPattern(HapticPattern pattern);
+
 
 /* Sensor functions */
 
@@ -159,6 +439,31 @@ void VibrateExMS(uint64_t ms, float intensity);
  */
 void InitSensorManager(void);
 
+/**
+ * @brief Initializes the sensor manager, optionally on a dedicated thread.
+ *
+ * By default, sensor events are dispatched when raylib polls the looper of
+ * the calling thread, once per frame, so they arrive in bursts when a frame
+ * is slow. With a dedicated thread, events are handled as soon as they are
+ * delivered, on a high priority thread with its own looper.
+ *
+ * In both modes GetAccelerotmerAxis() and GetGyroscopeAxis() never block,
+ * and return the latest complete reading. Calling it again has no effect
+ * until CloseSensorManager() is called.
+ *
+ * @param dedicatedThread Handle sensor events on a dedicated thread.
+ */
+void InitSensorManagerEx(bool dedicatedThread);
+
+/**
+ * @brief Closes the sensor manager, disabling all sensors.
+ *
+ * Must be called from the thread that initialized it. With a dedicated
+ * thread, that thread is woken up and joined. The manager can then be
+ * initialized again, in either mode.
+ */
+void CloseSensorManager(void);
+
 /**
  * @brief Enables the specified sensor.
  *
@@ -166,6 +471,21 @@ void InitSensorManager(void);
  */
 void EnableSensor(Sensor sensor);
 
+/**
+ * @brief Enables the specified sensor with a sampling rate and hardware batching.
+ *
+ * With batching, the sensor hub stores events in its FIFO and delivers them
+ * together at most 'maxBatchLatencyUs' later, letting the CPU sleep meanwhile.
+ * Both values are clamped to what the sensor supports, see GetSensorMinDelay()
+ * and GetSensorFifoMaxEventCount(). Batching requires Android 8.0 (API 26),
+ * below that only the sampling period is applied.
+ *
+ * @param sensor The sensor to be enabled.
+ * @param samplingPeriodUs Delay between two samples in microseconds, 0 for the default (20ms).
+ * @param maxBatchLatencyUs Maximum delivery delay in microseconds, 0 to disable batching.
+ */
+void EnableSensorEx(Sensor sensor, int samplingPeriodUs, int64_t maxBatchLatencyUs);
+
 /**
  * @brief Disables the specified sensor.
  *
@@ -175,9 +495,30 @@ void DisableSensor(Sensor sensor);
 
 /**
  * Get screen orientation.
+ *
+ * Pushed by Java on every change, reading it makes no JNI call.
  */
 Orientation GetScreenOrientation();
 
+/**
+ * @brief Returns the display state, updated by Java on every display or insets change.
+ *
+ * Reading it never makes a JNI call, it is cheap enough to be called every frame.
+ *
+ * @return Latest display state, with a zero generation until the first one is received.
+ */
+DisplayState GetDisplayState(void);
+
+/**
+ * @brief Returns the generation of the display state, with a single atomic load.
+ *
+ * Compare it with the generation of a previous DisplayState to know if the
+ * layout depending on it must be updated.
+ *
+ * @return Generation of the latest display state, 0 until the first one is received.
+ */
+unsigned int GetDisplayStateGeneration(void);
+
 /**
  * @brief Retrieves the current accelerometer axis values.
  *
@@ -192,6 +533,90 @@ Vector3 GetAccelerotmerAxis(void);
  */
 Vector3 GetGyroscopeAxis(void);
 
+/**
+ * @brief Retrieves the latest values of any sensor.
+ *
+ * The layout is the one of the Android SensorEvent.values array for this
+ * sensor type, e.g. 4 values (x, y, z, w) for SENSOR_GAME_ROTATION_VECTOR,
+ * 1 value for SENSOR_LIGHT. Never blocks, values are never torn.
+ *
+ * @param sensor The sensor to read.
+ * @param values Array receiving the values, up to 16 are used.
+ * @param maxValues Capacity of the array.
+ * @return Number of values written, 0 if the sensor is unknown.
+ */
+int GetSensorValues(Sensor sensor, float *values, int maxValues);
+
+/**
+ * @brief Retrieves the device orientation, fused from the gyroscope and accelerometer.
+ *
+ * A Madgwick filter runs on every sensor event, at the full sensor rate, so
+ * both sensors must be enabled. The quaternion rotates vectors from the device
+ * frame into the earth frame, whose Z axis points up (the heading drifts,
+ * there is no magnetometer correction).
+ *
+ * @return The orientation, identity until the first events are received.
+ */
+Quaternion GetDeviceOrientation(void);
+
+/**
+ * @brief Retrieves the accelerometer values with gravity removed.
+ *
+ * @return The linear acceleration in m/s^2, in the device frame.
+ */
+Vector3 GetLinearAcceleration(void);
+
+/**
+ * @brief Sets the gain of the orientation filter, 0.1 by default.
+ *
+ * Higher values converge faster towards the accelerometer, but let more of
+ * its noise through. Lower values trust the gyroscope more.
+ *
+ * @param beta The filter gain.
+ */
+void SetSensorFusionGain(float beta);
+
+/**
+ * @brief Gets the minimum delay between two events of a sensor.
+ *
+ * @param sensor The sensor to query.
+ * @return Delay in microseconds, 0 if the sensor only reports on change, -1 if unsupported.
+ */
+int GetSensorMinDelay(Sensor sensor);
+
+/**
+ * @brief Gets the maximum number of events the hardware FIFO of a sensor can hold.
+ *
+ * @param sensor The sensor to query.
+ * @return Number of events, 0 if the sensor does not support batching.
+ */
+int GetSensorFifoMaxEventCount(Sensor sensor);
+
+/**
+ * @brief Gets the number of FIFO events reserved to a sensor, guaranteed to be available.
+ *
+ * @param sensor The sensor to query.
+ * @return Number of events, 0 if nothing is reserved.
+ */
+int GetSensorFifoReservedEventCount(Sensor sensor);
+
+/**
+ * @brief Retrieves every event received from a sensor since the last call.
+ *
+ * Unlike GetAccelerotmerAxis() and GetGyroscopeAxis(), which only return
+ * the latest value, no sample is lost between two frames. Events are
+ * returned oldest first, call it again if it returns 'maxEvents'.
+ *
+ * @note Events are buffered once the sensor is enabled, up to 1024 per
+ * sensor, newer events are dropped until the buffer is drained.
+ *
+ * @param sensor The sensor to drain.
+ * @param events Array receiving the events.
+ * @param maxEvents Capacity of the array.
+ * @return Number of events written to 'events'.
+ */
+int DrainSensorEvents(Sensor sensor, SensorEvent *events, int maxEvents);
+
 
 /* Soft Keyboard functions */
 
@@ -205,6 +630,54 @@ void ShowSoftKeyboard(void);
  */
 void HideSoftKeyboard(void);
 
+/**
+ * @brief Retrieves the soft keyboard key events received since the last call.
+ *
+ * Events are pushed by the UI thread as keys are released, so no key is lost
+ * when several are typed within one frame. The queue holds 64 events, older
+ * events are kept and newer ones dropped when it is full.
+ *
+ * @param events Array receiving the events, oldest first.
+ * @param maxEvents Capacity of the array.
+ * @return Number of events written to the array.
+ */
+int PollSoftKeyEvents(SoftKeyEvent *events, int maxEvents);
+
+/**
+ * @brief Enables text input through the input method, instead of key events only.
+ *
+ * When enabled, ShowSoftKeyboard() connects the input method to raymob, so
+ * that paste, swipe typing, autocompletion and composition (e.g. CJK) are
+ * received as whole strings. Typed text is then no longer reported as key
+ * events, read it with GetSoftKeyboardCommittedText() instead.
+ *
+ * @param enabled true to enable text input, false to only receive key events.
+ */
+void SetSoftKeyboardTextInput(bool enabled);
+
+/**
+ * @brief Returns the text committed by the input method since the last call.
+ *
+ * The text may contain '\b' for each UTF-16 unit deleted before the cursor,
+ * and '\x7f' for each one deleted after it, in the order they happened. A
+ * character outside of the BMP (e.g. an emoji) takes two of them, as counted
+ * by the input method. SoftKeyboardEditTextBuffer() takes care of it.
+ * A whole paste is received at once, in a single transfer from Java.
+ *
+ * @return UTF-8 text, valid until the next call. Never NULL.
+ */
+const char *GetSoftKeyboardCommittedText(void);
+
+/**
+ * @brief Returns the text being composed by the input method.
+ *
+ * This text is not committed yet, and is usually displayed underlined at the
+ * cursor. It is replaced as the user types, and cleared once committed.
+ *
+ * @return UTF-8 text, valid until the next call. Never NULL.
+ */
+const char *GetSoftKeyboardComposingText(void);
+
 /**
  * @brief Returns the code of the last key pressed on the soft keyboard.
  *
@@ -241,6 +714,9 @@ void ClearLastSoftKey(void);
 /**
  * @brief Allows editing the text displayed in the soft keyboard.
  *
+ * Only appends or removes the last character, and only Latin-1 characters.
+ * Use a TextBuffer with SoftKeyboardEditTextBuffer() for anything longer.
+ *
  * @param text Pointer to the text to be edited.
  * @param size Size of the text buffer.
  */
@@ -253,6 +729,373 @@ void SoftKeyboardEditText(char* text, unsigned int size);
  */
 void KeepScreenOn(bool keepOn);
 
+/* Text editing functions */
+
+/**
+ * @brief Creates an editable text, with the cursor at its end.
+ *
+ * Inserting and deleting at the cursor is O(1) amortized. Offsets are byte
+ * offsets in the UTF-8 text, and are always kept on code point boundaries.
+ *
+ * @param text Initial UTF-8 text, can be NULL.
+ * @return The text buffer, or NULL on allocation failure.
+ */
+TextBuffer *LoadTextBuffer(const char *text);
+
+/**
+ * @brief Releases a text buffer.
+ *
+ * @param buffer Text buffer to release, can be NULL.
+ */
+void UnloadTextBuffer(TextBuffer *buffer);
+
+/**
+ * @brief Inserts text at the cursor, replacing the selection if any.
+ *
+ * @param buffer Text buffer to edit.
+ * @param text Valid UTF-8 text to insert.
+ * @return true if the text changed.
+ */
+bool InsertTextBufferString(TextBuffer *buffer, const char *text);
+
+/**
+ * @brief Inserts a character at the cursor, replacing the selection if any.
+ *
+ * @param buffer Text buffer to edit.
+ * @param codepoint Unicode code point, invalid ones are ignored.
+ * @return true if the text changed.
+ */
+bool InsertTextBufferCodepoint(TextBuffer *buffer, int codepoint);
+
+/**
+ * @brief Deletes the selection, or else the character before the cursor.
+ *
+ * @param buffer Text buffer to edit.
+ * @return true if the text changed.
+ */
+bool DeleteTextBufferBackward(TextBuffer *buffer);
+
+/**
+ * @brief Deletes the selection, or else the character after the cursor.
+ *
+ * @param buffer Text buffer to edit.
+ * @return true if the text changed.
+ */
+bool DeleteTextBufferForward(TextBuffer *buffer);
+
+/**
+ * @brief Moves the cursor by a number of characters.
+ *
+ * @param buffer Text buffer to edit.
+ * @param codepoints Number of code points to move, negative to move backward.
+ * @param select If true, extends the selection instead of clearing it.
+ */
+void MoveTextBufferCursor(TextBuffer *buffer, int codepoints, bool select);
+
+/**
+ * @brief Sets the cursor position.
+ *
+ * @param buffer Text buffer to edit.
+ * @param offset Byte offset, clamped to the text and moved back to a code point boundary.
+ * @param select If true, extends the selection instead of clearing it.
+ */
+void SetTextBufferCursor(TextBuffer *buffer, size_t offset, bool select);
+
+/**
+ * @brief Selects a range of the text, the cursor ends up at 'end'.
+ *
+ * @param buffer Text buffer to edit.
+ * @param start Byte offset where the selection starts.
+ * @param end Byte offset where the selection ends, can be lower than 'start'.
+ */
+void SelectTextBufferRange(TextBuffer *buffer, size_t start, size_t end);
+
+/**
+ * @brief Returns the cursor position.
+ *
+ * @param buffer Text buffer.
+ * @return Byte offset of the cursor in the text.
+ */
+size_t GetTextBufferCursor(const TextBuffer *buffer);
+
+/**
+ * @brief Retrieves the selected range.
+ *
+ * @param buffer Text buffer.
+ * @param start Receives the byte offset where the selection starts, can be NULL.
+ * @param end Receives the byte offset where the selection ends, can be NULL.
+ * @return true if the selection is not empty.
+ */
+bool GetTextBufferSelection(const TextBuffer *buffer, size_t *start, size_t *end);
+
+/**
+ * @brief Returns the length of the text.
+ *
+ * @param buffer Text buffer.
+ * @return Length of the text in bytes, terminator excluded.
+ */
+size_t GetTextBufferLength(const TextBuffer *buffer);
+
+/**
+ * @brief Returns the text as a null-terminated UTF-8 string.
+ *
+ * Costs nothing if the text did not change since the last call. The pointer
+ * is valid until the next edit of the buffer.
+ *
+ * @param buffer Text buffer.
+ * @return The text, owned by the buffer.
+ */
+const char *GetTextBufferText(TextBuffer *buffer);
+
+/**
+ * @brief Applies the pending soft keyboard key events to a text buffer.
+ *
+ * Drains PollSoftKeyEvents(), inserting the typed characters and handling
+ * delete, forward delete, enter, left, right, home and end keys, then
+ * applies GetSoftKeyboardCommittedText(). The composing text is left to
+ * the caller, see GetSoftKeyboardComposingText().
+ *
+ * @param buffer Text buffer to edit.
+ * @return true if the text changed.
+ */
+bool SoftKeyboardEditTextBuffer(TextBuffer *buffer);
+
+
+/* Frame pacing functions */
+
+/**
+ * @brief Starts pacing frames on the display vsync, using the Choreographer.
+ *
+ * Replaces SetTargetFPS(), which sleeps on a timer unaligned with vsync.
+ * Call WaitNextPacedFrame() at the start of each frame. Frames are paced at
+ * the refresh rate divided by the smallest divisor that does not exceed the
+ * target, e.g. 60 gives 60 FPS on 120Hz, 45 FPS on 90Hz, and 30 gives 30 FPS on 60Hz.
+ *
+ * @param targetFPS Target frame rate, 0 to present on every vsync.
+ * @return false if the Choreographer is not available, frames are then not paced.
+ */
+bool InitFramePacer(int targetFPS);
+
+/**
+ * @brief Stops pacing frames.
+ */
+void CloseFramePacer(void);
+
+/**
+ * @brief Checks if the pacer is running.
+ *
+ * @return true if InitFramePacer() succeeded and CloseFramePacer() was not called.
+ */
+bool IsFramePacerReady(void);
+
+/**
+ * @brief Changes the target frame rate of the pacer.
+ *
+ * @param targetFPS Target frame rate, 0 to present on every vsync.
+ */
+void SetFramePacerTarget(int targetFPS);
+
+/**
+ * @brief Waits until the next frame should start.
+ *
+ * The frame starts as late as possible before the vsync it is scheduled for,
+ * according to the time the previous frames took, which keeps the input
+ * latency low. Does nothing if the pacer is not running.
+ */
+void WaitNextPacedFrame(void);
+
+/**
+ * @brief Returns the time at which the current frame is expected to be displayed.
+ *
+ * Useful to extrapolate animations to the time they are actually seen.
+ *
+ * @return Predicted present time, on the same clock as GetTime().
+ */
+double GetFramePresentTime(void);
+
+/**
+ * @brief Returns the time between two paced frames.
+ *
+ * Stable from frame to frame, unlike GetFrameTime(), so it can be used as a
+ * fixed simulation step.
+ *
+ * @return Frame interval in seconds, or GetFrameTime() if the pacer is not running.
+ */
+float GetFramePacerInterval(void);
+
+/**
+ * @brief Returns the time slept by the last call to WaitNextPacedFrame().
+ *
+ * The frame time minus this wait is the time actually spent on the frame.
+ *
+ * @return Wait time in seconds, 0 if the pacer is not running.
+ */
+float GetFramePacerWaitTime(void);
+
+/* Dynamic resolution functions */
+
+/**
+ * @brief Enables rendering the scene at a variable resolution.
+ *
+ * The scene drawn between BeginDynamicResolution() and EndDynamicResolution()
+ * is rendered to a texture at a fraction of the screen size, then stretched to
+ * the screen. The scale goes down when the 90th percentile of the frame time
+ * exceeds the frame budget and back up once there is headroom, with hysteresis
+ * so that it does not oscillate. The budget is GetFramePacerInterval() when the
+ * pacer is running, 1/60s otherwise.
+ *
+ * NOTE: The frame time is measured between two calls to BeginDynamicResolution(),
+ *       minus the time slept by the pacer. Without the pacer, the wait of
+ *       SetTargetFPS() cannot be measured, so the scale stays where it is
+ *       (maxScale) until InitFramePacer() succeeds.
+ *
+ * Also enabled at startup with 'display.dynamic_resolution' in gradle.properties.
+ *
+ * @param minScale Lowest scale of the resolution, per axis (at least 0.1).
+ * @param maxScale Highest scale of the resolution, per axis (at most 1.0).
+ */
+void InitDynamicResolution(float minScale, float maxScale);
+
+/**
+ * @brief Disables dynamic resolution and frees its render texture.
+ */
+void CloseDynamicResolution(void);
+
+/**
+ * @brief Starts drawing the scene at the current resolution scale.
+ *
+ * Call it after BeginDrawing(). Coordinates stay in screen units at any
+ * scale, except for BeginScissorMode() which expects scaled coordinates.
+ * Draw the UI after EndDynamicResolution() to keep it sharp.
+ * Does nothing if dynamic resolution is disabled.
+ */
+void BeginDynamicResolution(void);
+
+/**
+ * @brief Stops drawing the scene and stretches it to the screen.
+ */
+void EndDynamicResolution(void);
+
+/**
+ * @brief Returns the current resolution scale.
+ *
+ * @return Scale per axis, 1.0 if dynamic resolution is disabled.
+ */
+float GetDynamicResolutionScale(void);
+
+/* Performance hint functions */
+
+/**
+ * @brief Opens a performance hint session (ADPF) for the render thread.
+ *
+ * Reporting the work of each frame lets the system raise the CPU clocks
+ * before frames get late, instead of lowering them once the game has run for
+ * a while. Call it from the render thread, which is always part of the session.
+ * The target work duration follows GetFramePacerInterval() when the pacer is
+ * running, otherwise 1/60s unless set with SetPerformanceHintTarget().
+ *
+ * NOTE: Threads cannot be added afterwards, call it again to change them.
+ *
+ * Also opened by the first BeginDrawing() with 'performance.hint' in gradle.properties.
+ *
+ * @param threadIds Kernel IDs (gettid()) of worker threads doing frame work, can be NULL.
+ * @param count Number of worker threads (at most 15 are used).
+ * @return false if not supported (API 33 required) or if the session could not be created.
+ */
+bool InitPerformanceHint(const int *threadIds, int count);
+
+/**
+ * @brief Closes the performance hint session.
+ */
+void ClosePerformanceHint(void);
+
+/**
+ * @brief Checks if a performance hint session is open.
+ */
+bool IsPerformanceHintReady(void);
+
+/**
+ * @brief Sets the target work duration of a frame.
+ *
+ * @param seconds Target duration, 0 to follow the frame pacer (default).
+ */
+void SetPerformanceHintTarget(float seconds);
+
+/**
+ * @brief Starts measuring the work of a frame.
+ */
+void BeginPerformanceHintFrame(void);
+
+/**
+ * @brief Stops measuring the work of a frame and reports it to the session.
+ *
+ * The target work duration is reported too when it has changed.
+ */
+void EndPerformanceHintFrame(void);
+
+/**
+ * @brief BeginDrawing() that also measures the work of the frame.
+ *
+ * Replaces BeginDrawing() in the game code when 'performance.hint' is enabled.
+ * The frame is measured from the end of the previous EndHintedDrawing(),
+ * so the update done before drawing counts as work.
+ */
+void BeginHintedDrawing(void);
+
+/**
+ * @brief EndDrawing() that also reports the work of the frame.
+ *
+ * Buffer swap and the waits of SetTargetFPS() or the frame pacer are not
+ * counted as work.
+ */
+void EndHintedDrawing(void);
+
+/* Frame rate functions */
+
+/**
+ * @brief Tells the system the frame rate the game renders at.
+ *
+ * The display may then switch its refresh rate, e.g. 60Hz for menus and
+ * 120Hz for gameplay, without restarting anything. The switch only happens
+ * if it is seamless on this display. Requires API 30.
+ *
+ * NOTE: The window is recreated after a resume, the rate is set again
+ *       on the new window automatically.
+ *
+ * @param fps Preferred frame rate, 0 to remove the preference.
+ * @param compatibility How the content behaves at other rates.
+ * @return false if not supported, or if there is no window (e.g. app paused).
+ */
+bool SetPreferredFrameRate(float fps, FrameRateCompatibility compatibility);
+
+/**
+ * @brief Gets the refresh rates supported by the display at its current resolution.
+ *
+ * @param rates Array to fill in ascending order, can be NULL to only get the count.
+ * @param maxCount Size of the array.
+ * @return Number of rates written, or the total number of rates if 'rates' is NULL.
+ */
+int GetSupportedFrameRates(float *rates, int maxCount);
+
+/**
+ * @brief Enables lowering the frame rate while the scene is static.
+ *
+ * Once SetSceneStatic(true) has been reported for half a second, the
+ * preferred frame rate is lowered to this one, and restored as soon as the
+ * scene is no longer static.
+ *
+ * @param fps Frame rate of static scenes (e.g. 30), 0 to disable the policy.
+ */
+void SetStaticFrameRate(float fps);
+
+/**
+ * @brief Reports whether the scene currently changes, call it every frame.
+ *
+ * @param isStatic true if nothing moves on screen (e.g. idle menu).
+ */
+void SetSceneStatic(bool isStatic);
+
+
 /* Callback functions */
 
 /**
@@ -299,6 +1142,30 @@ void SetOnStopCallBack(Callback callback);
  */
 char* GetAppStoragePath();
 
+/**
+ * @brief Copies the app specific storage root path into a caller-provided buffer.
+ *
+ * Allocation-free variant of GetAppStoragePath(), the path is truncated if it does not fit.
+ *
+ * @param dst Buffer receiving the null-terminated path, can be NULL to query the length.
+ * @param cap Capacity of the buffer in bytes.
+ * @return Length of the full path (without null terminator), or -1 if unavailable.
+ */
+int GetAppStoragePathInto(char *dst, size_t cap);
+
+/**
+ * @brief Builds the full path of a file in app specific storage.
+ *
+ * The storage root is resolved only once, this function makes no JNI call
+ * and no allocation, the path is written into the buffer provided.
+ *
+ * @param dst Buffer receiving the null-terminated path.
+ * @param cap Capacity of the buffer in bytes (PATH_MAX is always enough).
+ * @param filepath Path of the file relative to app specific storage.
+ * @return Length of the path written, or -1 if the buffer is too small or the storage is unavailable.
+ */
+int JoinAppStoragePath(char *dst, size_t cap, const char *filepath);
+
 /**
  * @brief Read file in app specific storage.
  *
@@ -309,6 +1176,37 @@ char* GetAppStoragePath();
  */
 void* ReadFromAppStorage(const char *filepath, int *size);
 
+/**
+ * @brief Read file in app specific storage into a caller-provided buffer.
+ *
+ * Allocation-free variant of ReadFromAppStorage(), at most 'cap' bytes are read.
+ *
+ * @param filepath Path of the file relative to app specific storage.
+ * @param dst Buffer receiving the data, can be NULL to query the size.
+ * @param cap Capacity of the buffer in bytes.
+ * @return Size of the file in bytes (only 'cap' bytes were read if greater), or -1 on failure.
+ */
+int ReadFromAppStorageInto(const char *filepath, void *dst, size_t cap);
+
+/**
+ * @brief Maps a file of app specific storage into memory, read-only.
+ *
+ * The content is not copied, pages are loaded by the kernel when accessed.
+ * Prefer this to ReadFromAppStorage() for large files that are consumed in place.
+ *
+ * @param filepath Path of the file relative to app specific storage.
+ * @param access Expected access pattern, given to the kernel as a hint.
+ * @return The mapped file, 'data' is NULL on failure or if the file is empty.
+ */
+MappedFile MapAppStorageFile(const char *filepath, MapAccess access);
+
+/**
+ * @brief Unmaps a file mapped with MapAppStorageFile().
+ *
+ * @param file The mapped file to release.
+ */
+void UnmapAppStorageFile(MappedFile file);
+
 /**
  * @brief Write file in app specific storage.
  *
@@ -320,6 +1218,21 @@ void* ReadFromAppStorage(const char *filepath, int *size);
  */
 bool WriteToAppStorage(const char *filepath, void *data, unsigned int size);
 
+/**
+ * @brief Write file in app specific storage, atomically.
+ *
+ * The data is written to a temporary file, synced to disk and then renamed
+ * over the destination, so the file is never left truncated or half written,
+ * even if the process is killed in the middle of the write.
+ *
+ * @param filepath Path of the file relative to app specific storage.
+ * @param data Pointer to the data.
+ * @param dataSize Size of the data.
+ *
+ * @return true on success.
+ */
+bool WriteToAppStorageAtomic(const char *filepath, const void *data, unsigned int dataSize);
+
 /**
  * @brief Check file exist or not in app specific storage.
  *
@@ -336,8 +1249,261 @@ bool IsFileExistsInAppStorage(const char *filepath);
  */
 void RemoveFileInAppStorage(const char *filepath);
 
+/* Storage stream functions */
+
+/**
+ * @brief Opens a file of app specific storage for chunked reading or writing.
+ *
+ * Unlike ReadFromAppStorage(), streams use 64bit offsets and never load the
+ * whole file, so files of any size can be processed with constant memory.
+ *
+ * @param filepath Path of the file relative to app specific storage.
+ * @param mode Whether the stream reads, writes or appends.
+ * @return The stream, or NULL on failure.
+ */
+StorageStream *OpenAppStorageStream(const char *filepath, StreamMode mode);
+
+/**
+ * @brief Closes a stream and releases it.
+ *
+ * @param stream The stream to close.
+ * @return true if the file was closed without error.
+ */
+bool CloseStorageStream(StorageStream *stream);
+
+/**
+ * @brief Reads the next chunk of a stream into a buffer.
+ *
+ * @param stream A stream opened with STREAM_READ.
+ * @param buffer Buffer receiving the data.
+ * @param size Number of bytes to read.
+ * @return Number of bytes read, less than 'size' only at the end of the file, -1 on error.
+ */
+int64_t ReadStorageChunk(StorageStream *stream, void *buffer, size_t size);
+
+/**
+ * @brief Writes a chunk of data at the current position of a stream.
+ *
+ * @param stream A stream opened with STREAM_WRITE or STREAM_APPEND.
+ * @param buffer Data to write.
+ * @param size Number of bytes to write.
+ * @return Number of bytes written, -1 on error.
+ */
+int64_t WriteStorageChunk(StorageStream *stream, const void *buffer, size_t size);
+
+/**
+ * @brief Moves the position of a stream.
+ *
+ * @param stream The stream.
+ * @param offset 64bit offset in bytes, relative to 'origin'.
+ * @param origin SEEK_SET, SEEK_CUR or SEEK_END.
+ * @return true on success.
+ */
+bool SeekStorageStream(StorageStream *stream, int64_t offset, int origin);
+
+/**
+ * @brief Returns the current position of a stream.
+ *
+ * @param stream The stream.
+ * @return Position in bytes from the start of the file, -1 on error.
+ */
+int64_t TellStorageStream(StorageStream *stream);
+
+/**
+ * @brief Returns the current size of the file behind a stream.
+ *
+ * @param stream The stream.
+ * @return Size in bytes, -1 on error.
+ */
+int64_t GetStorageStreamSize(StorageStream *stream);
+
+/* Asynchronous storage functions */
+
+/**
+ * @brief Reads a file in app specific storage without blocking the calling thread.
+ *
+ * The file is read by a background I/O thread, the callback is then called
+ * from PollStorageRequests(), on the thread that polls.
+ * On success the callback receives the data read, it belongs to the callback
+ * and must be released with RL_FREE(). On failure or cancellation 'data' is NULL.
+ *
+ * @param filepath Path of the file relative to app specific storage.
+ * @param priority Requests of higher priority are served first.
+ * @param callback Function called on completion, can be NULL.
+ * @param userData Pointer passed as is to the callback.
+ * @return Handle of the request, 0 if it could not be queued.
+ */
+StorageRequest ReadFromAppStorageAsync(const char *filepath, StoragePriority priority, StorageCallback callback, void *userData);
+
+/**
+ * @brief Writes a file in app specific storage without blocking the calling thread.
+ *
+ * The data is copied, the caller can release its buffer as soon as this returns.
+ * The file is replaced atomically, like WriteToAppStorageAtomic(). Requests on
+ * the same file run one after the other in submission order, whatever their priority.
+ * The callback is called from PollStorageRequests() with a NULL 'data'.
+ *
+ * @param filepath Path of the file relative to app specific storage.
+ * @param data Pointer to the data.
+ * @param dataSize Size of the data.
+ * @param priority Requests of higher priority are served first.
+ * @param callback Function called on completion, can be NULL.
+ * @param userData Pointer passed as is to the callback.
+ * @return Handle of the request, 0 if it could not be queued.
+ */
+StorageRequest WriteToAppStorageAsync(const char *filepath, const void *data, unsigned int dataSize,
+                                      StoragePriority priority, StorageCallback callback, void *userData);
+
+/**
+ * @brief Cancels a storage request.
+ *
+ * A pending request is dropped, a running one completes but its result is discarded.
+ * In both cases the callback is still called, with STORAGE_REQUEST_CANCELLED.
+ *
+ * @param request Handle of the request.
+ * @return true if the request was pending or running.
+ */
+bool CancelStorageRequest(StorageRequest request);
+
+/**
+ * @brief Returns the current status of a storage request.
+ *
+ * @param request Handle of the request.
+ * @return Status of the request, STORAGE_REQUEST_INVALID once it has been dispatched.
+ */
+StorageRequestStatus GetStorageRequestStatus(StorageRequest request);
+
+/**
+ * @brief Dispatches the callbacks of all completed storage requests.
+ *
+ * Should be called once per frame from the game loop. The callbacks are
+ * called in the order the requests were submitted.
+ *
+ * @return Number of requests dispatched.
+ */
+int PollStorageRequests(void);
+
+/* Storage journal functions */
+
+/**
+ * @brief Queues a write of a file in app specific storage, to be flushed later.
+ *
+ * The data is copied into an in-memory journal. Writing the same file several
+ * times before a flush only keeps the latest content, so frequent saves cost a
+ * single disk write per flush. Files are written with WriteToAppStorageAtomic().
+ *
+ * The journal is flushed by FlushStorageJournal(), by the timer set with
+ * SetStorageJournalFlushInterval(), and when the application is paused.
+ * Must be called from the game thread, which handles the pause.
+ *
+ * @note Until flushed, reading the file returns its previous content.
+ *
+ * @param filepath Path of the file relative to app specific storage.
+ * @param data Pointer to the data.
+ * @param dataSize Size of the data.
+ * @return true if the write was journaled.
+ */
+bool WriteToAppStorageJournaled(const char *filepath, const void *data, unsigned int dataSize);
+
+/**
+ * @brief Writes all the journaled files to app specific storage.
+ *
+ * Files that could not be written stay in the journal for the next flush,
+ * unless they were journaled again in the meantime.
+ *
+ * @return true if every file was written successfully.
+ */
+bool FlushStorageJournal(void);
+
+/**
+ * @brief Flushes the journal on its background thread, waiting at most 'timeout'.
+ *
+ * Used when the application is paused, so the UI thread never waits on the
+ * disk for long. If the timeout expires the flush still completes in background.
+ *
+ * @param timeout Maximum wait in seconds.
+ * @return true if every file was written before the timeout.
+ */
+bool FlushStorageJournalTimeout(float timeout);
+
+/**
+ * @brief Sets the interval at which the journal is flushed in background.
+ *
+ * @param seconds Interval in seconds, 0 disables the timer (the default).
+ */
+void SetStorageJournalFlushInterval(float seconds);
+
+
+/* Input record/replay functions */
+
+/**
+ * @brief Starts recording sensor and soft keyboard input.
+ *
+ * Every sensor event (with its timestamp) and every change of the last soft
+ * key is recorded in memory, the file is only written by StopInputRecording().
+ *
+ * @param filepath Path of the recording relative to app specific storage.
+ * @return true if the recording started.
+ */
+bool StartInputRecording(const char *filepath);
+
+/**
+ * @brief Stops the recording and writes it to app specific storage.
+ *
+ * @return true if the recording was written successfully.
+ */
+bool StopInputRecording(void);
+
+/**
+ * @brief Loads an input recording and starts replaying it.
+ *
+ * While a replay is active, live sensor and soft keyboard input is ignored,
+ * and the sensor and soft keyboard functions return the recorded input.
+ *
+ * The replay also builds on a desktop host, without PLATFORM_ANDROID, to run
+ * game logic under recorded input, e.g. in benchmarks. Build 'input_replay.c'
+ * and 'input_replay_host.c' with the game code, the path is then used as is.
+ *
+ * @param filepath Path of the recording relative to app specific storage.
+ * @return true if the recording was loaded.
+ */
+bool LoadInputReplay(const char *filepath);
+
+/**
+ * @brief Stops the replay and releases the recording.
+ */
+void UnloadInputReplay(void);
+
+/**
+ * @brief Advances the replay, applying the recorded input in order.
+ *
+ * The replay time is only advanced by this function, so a fixed step gives
+ * the same input sequence on every run, whatever the real frame time.
+ *
+ * @param seconds Time to advance.
+ * @return Number of recorded events applied.
+ */
+int UpdateInputReplay(float seconds);
+
+/**
+ * @brief Checks if a replay is loaded.
+ */
+bool IsInputReplayActive(void);
+
+/**
+ * @brief Checks if all the recorded input has been applied.
+ */
+bool IsInputReplayFinished(void);
+
 #if defined(__cplusplus)
 }
 #endif
 
+// NOTE: Defined from 'performance.hint' in gradle.properties, reports the
+//       work of each frame without changing the game code
+#if defined(RAYMOB_PERFORMANCE_HINT)
+    #define BeginDrawing() BeginHintedDrawing()
+    #define EndDrawing() EndHintedDrawing()
+#endif
+
 #endif //RAYMOB_H
@@ -0,0 +1,128 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "resolution_governor.h"
+
+#include <math.h>
+#include <string.h>
+
+/* DEFINES */
+
+#define GOVERNOR_MAX_STEP_DOWN  0.25f   // Largest decrease of the scale at once
+
+/* INTERNAL FUNCTIONS */
+
+static float Clamp(float value, float min, float max)
+{
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+static void SetScale(Governor *governor, float scale)
+{
+    scale = Clamp(scale, governor->config.minScale, governor->config.maxScale);
+
+    if (scale != governor->scale) {
+        governor->scale = scale;
+        governor->count = 0;
+        governor->next = 0;
+    }
+}
+
+/* FUNCTIONS */
+
+GovernorConfig GetDefaultGovernorConfig(float minScale, float maxScale, float budget)
+{
+    return (GovernorConfig) {
+        .minScale = minScale,
+        .maxScale = maxScale,
+        .budget = budget,
+        .percentile = 0.9f,
+        .lowerThreshold = 1.0f,
+        .raiseThreshold = 0.85f,
+        .step = 0.05f
+    };
+}
+
+void InitGovernor(Governor *governor, GovernorConfig config)
+{
+    memset(governor, 0, sizeof(Governor));
+
+    if (config.minScale > config.maxScale) config.minScale = config.maxScale;
+
+    governor->config = config;
+    governor->scale = config.maxScale;
+}
+
+float UpdateGovernor(Governor *governor, float frameTime)
+{
+    const GovernorConfig *config = &governor->config;
+
+    governor->samples[governor->next] = frameTime;
+    governor->next = (governor->next + 1)%GOVERNOR_WINDOW;
+    if (governor->count < GOVERNOR_WINDOW) governor->count++;
+
+    if (governor->count < GOVERNOR_MIN_SAMPLES || config->budget <= 0.0f) return governor->scale;
+
+    float frameTimeHigh = GetFrameTimePercentile(governor->samples, governor->count, config->percentile);
+    float scale = governor->scale;
+
+    if (frameTimeHigh > config->budget*config->lowerThreshold) {
+        // Aim for the scale that would fit the raise threshold, at least one hundredth below
+        float target = scale*sqrtf(config->budget*config->raiseThreshold/frameTimeHigh);
+        SetScale(governor, Clamp(target, scale - GOVERNOR_MAX_STEP_DOWN, scale - 0.01f));
+    } else if (scale < config->maxScale) {
+        // Only go up if the cost predicted at the next step stays under the raise threshold,
+        // the gap between both thresholds keeps the scale from oscillating
+        float next = Clamp(scale + config->step, scale, config->maxScale);
+        float predicted = frameTimeHigh*(next*next)/(scale*scale);
+        if (predicted < config->budget*config->raiseThreshold) SetScale(governor, next);
+    }
+
+    return governor->scale;
+}
+
+float GetFrameTimePercentile(const float *frameTimes, int count, float percentile)
+{
+    if (count <= 0) return 0.0f;
+    if (count > GOVERNOR_WINDOW) count = GOVERNOR_WINDOW;
+
+    // NOTE: Insertion sort on a copy, the window is small
+    float sorted[GOVERNOR_WINDOW];
+
+    for (int i = 0; i < count; i++) {
+        int j = i;
+        while (j > 0 && sorted[j - 1] > frameTimes[i]) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = frameTimes[i];
+    }
+
+    int index = (int)(percentile*(count - 1) + 0.5f);
+    if (index < 0) index = 0;
+    if (index > count - 1) index = count - 1;
+
+    return sorted[index];
+}
@@ -0,0 +1,84 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef RAYMOB_RESOLUTION_GOVERNOR_H
+#define RAYMOB_RESOLUTION_GOVERNOR_H
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Control loop of the dynamic resolution. Plain C, it only sees frame times
+ * and returns a scale, so it can be replayed against recorded frame time
+ * traces on any host.
+ *
+ * The render cost is assumed to follow the number of pixels, i.e. the square
+ * of the scale. The scale goes down as soon as a high percentile of the recent
+ * frame times exceeds the budget, and only goes up when there is enough
+ * headroom for the next step to stay within it. The window is cleared after
+ * each change, so every decision is made on frames rendered at the current scale.
+ */
+
+#define GOVERNOR_WINDOW         64      // Frame times kept for the percentile
+#define GOVERNOR_MIN_SAMPLES    30      // Frames needed at a scale before changing it again
+
+typedef struct GovernorConfig {
+    float minScale;
+    float maxScale;
+    float budget;               // Target frame time in seconds
+    float percentile;           // Percentile of the frame times compared to the budget, e.g. 0.9
+    float lowerThreshold;       // Part of the budget above which the scale goes down, e.g. 1.0
+    float raiseThreshold;       // Part of the budget the next step up must stay under, e.g. 0.85
+    float step;                 // Scale added when going up
+} GovernorConfig;
+
+typedef struct Governor {
+    GovernorConfig config;
+    float samples[GOVERNOR_WINDOW];
+    int count;
+    int next;
+    float scale;
+} Governor;
+
+/**
+ * @brief Returns the default configuration for a budget, between 'minScale' and 'maxScale'.
+ */
+GovernorConfig GetDefaultGovernorConfig(float minScale, float maxScale, float budget);
+
+/**
+ * @brief Resets a governor, starting at the maximum scale.
+ */
+void InitGovernor(Governor *governor, GovernorConfig config);
+
+/**
+ * @brief Adds the frame time of the last frame and returns the scale for the next one.
+ */
+float UpdateGovernor(Governor *governor, float frameTime);
+
+/**
+ * @brief Returns a percentile of a set of frame times (0.5 for the median).
+ */
+float GetFrameTimePercentile(const float *frameTimes, int count, float percentile);
+
+#endif //RAYMOB_RESOLUTION_GOVERNOR_H
@@ -0,0 +1,123 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "ring_buffer.h"
+
+#include "raylib.h"     // RL_MALLOC(), RL_FREE()
+
+#include <string.h>
+
+/* INTERNAL FUNCTIONS */
+
+// NOTE: A range can wrap around the end of the storage, it is copied in two parts
+
+static void WriteRing(RingBuffer *ring, uint32_t index, const void *src, uint32_t count)
+{
+    uint32_t start = index & ring->mask;
+    uint32_t first = (count < ring->mask + 1 - start) ? count : ring->mask + 1 - start;
+    size_t size = ring->elementSize;
+
+    memcpy(ring->data + start*size, src, first*size);
+    memcpy(ring->data, (const unsigned char *)src + first*size, (count - first)*size);
+}
+
+static void ReadRing(const RingBuffer *ring, uint32_t index, void *dst, uint32_t count)
+{
+    uint32_t start = index & ring->mask;
+    uint32_t first = (count < ring->mask + 1 - start) ? count : ring->mask + 1 - start;
+    size_t size = ring->elementSize;
+
+    memcpy(dst, ring->data + start*size, first*size);
+    memcpy((unsigned char *)dst + first*size, ring->data, (count - first)*size);
+}
+
+/* PUBLIC API */
+
+bool LoadRingBuffer(RingBuffer *ring, int elementSize, int capacity)
+{
+    memset(ring, 0, sizeof(RingBuffer));
+
+    if (elementSize <= 0 || capacity <= 0) return false;
+
+    uint32_t pow2 = 1;
+    while (pow2 < (uint32_t)capacity) pow2 <<= 1;
+
+    ring->data = RL_MALLOC((size_t)pow2*elementSize);
+    if (ring->data == NULL) return false;
+
+    ring->elementSize = (uint32_t)elementSize;
+    ring->mask = pow2 - 1;
+
+    return true;
+}
+
+void UnloadRingBuffer(RingBuffer *ring)
+{
+    RL_FREE(ring->data);
+    memset(ring, 0, sizeof(RingBuffer));
+}
+
+int PushRingBuffer(RingBuffer *ring, const void *elements, int count)
+{
+    if (ring->data == NULL || count <= 0) return 0;
+
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    uint32_t space = (ring->mask + 1) - (tail - head);
+    uint32_t n = ((uint32_t)count < space) ? (uint32_t)count : space;
+
+    if (n > 0) {
+        WriteRing(ring, tail, elements, n);
+        __atomic_store_n(&ring->tail, tail + n, __ATOMIC_RELEASE);
+    }
+
+    return (int)n;
+}
+
+int PopRingBuffer(RingBuffer *ring, void *out, int max)
+{
+    if (ring->data == NULL || max <= 0) return 0;
+
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    uint32_t available = tail - head;
+    uint32_t n = ((uint32_t)max < available) ? (uint32_t)max : available;
+
+    if (n > 0) {
+        ReadRing(ring, head, out, n);
+        __atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+    }
+
+    return (int)n;
+}
+
+int GetRingBufferCount(const RingBuffer *ring)
+{
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    return (int)(tail - head);
+}
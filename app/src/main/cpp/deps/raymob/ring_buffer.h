@@ -0,0 +1,86 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef RAYMOB_RING_BUFFER_H
+#define RAYMOB_RING_BUFFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Lock-free single producer / single consumer ring of fixed size elements.
+ * One thread may push while another one pops, without any lock. Plain C,
+ * it does not depend on Android and can be built on any host.
+ *
+ * NOTE: When the ring is full, new elements are rejected, the ones already
+ *       queued are never overwritten under the consumer.
+ */
+
+typedef struct RingBuffer {
+
+    unsigned char *data;
+    uint32_t elementSize;
+    uint32_t mask;          // Capacity - 1, the capacity is a power of two
+
+    // NOTE: Free running counters, each one written by a single side and
+    //       kept on its own cache line to avoid false sharing
+    uint32_t head __attribute__((aligned(64)));     // Written by the consumer
+    uint32_t tail __attribute__((aligned(64)));     // Written by the producer
+
+} RingBuffer;
+
+/**
+ * @brief Allocates a ring, the capacity is rounded up to a power of two.
+ *
+ * @return false if the allocation failed.
+ */
+bool LoadRingBuffer(RingBuffer *ring, int elementSize, int capacity);
+
+/**
+ * @brief Releases the ring memory, no thread may use it anymore.
+ */
+void UnloadRingBuffer(RingBuffer *ring);
+
+/**
+ * @brief Pushes up to 'count' elements, producer side only.
+ *
+ * @return Number of elements pushed, less than 'count' if the ring is full.
+ */
+int PushRingBuffer(RingBuffer *ring, const void *elements, int count);
+
+/**
+ * @brief Pops up to 'max' elements in FIFO order, consumer side only.
+ *
+ * @return Number of elements copied into 'out'.
+ */
+int PopRingBuffer(RingBuffer *ring, void *out, int max);
+
+/**
+ * @brief Number of elements currently queued, may be stale by the time it returns.
+ */
+int GetRingBufferCount(const RingBuffer *ring);
+
+#endif //RAYMOB_RING_BUFFER_H
@@ -23,70 +23,426 @@
  */
 
 #include "raymob.h"
+#include "ring_buffer.h"
+#include "sensor_rate.h"
+#include "sensor_fusion.h"
+#include "seqlock.h"
+#include "input_record.h"
 
 #include <android/sensor.h>
+#include <sys/resource.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <dlfcn.h>
+
+/* DEFINES */
+
+#define SENSOR_MAX_VALUES           16      // Size of ASensorEvent.data
+#define SENSOR_TYPE_MAX             64      // Android types above are vendor specific, ignored
+#define SENSOR_EVENT_BATCH          64      // Events read from the queue per call
+#define SENSOR_RING_CAPACITY        1024    // Per sensor, about 5 seconds at 200 Hz
+#define SENSOR_THREAD_PRIORITY      -8      // Same as THREAD_PRIORITY_URGENT_DISPLAY on the Java side
+#define SENSOR_REPLAY_CAPACITY      256     // Replayed samples waiting for the sensor thread
+#define SENSOR_REPLAY_MAX_RETRIES   1000    // Yields while the replay ring is full, before dropping
+#define SENSOR_REPLAY_FLUSH_TIMEOUT 50      // Milliseconds, longest wait for the sensor thread
+
+/* TYPES */
+
+typedef struct {
+    int type;               // ASENSOR_TYPE_* value
+    const char *name;
+    int valueCount;         // Number of meaningful floats in ASensorEvent.data
+} SensorInfo;
+
+// NOTE: ASensorEventQueue_registerSensor() only exists since API 26, it is resolved at runtime
+typedef int (*RegisterSensorFunc)(ASensorEventQueue*, ASensor const*, int32_t, int64_t);
+
+typedef struct {
+    uint32_t sequence;
+    float values[7];    // Orientation (w, x, y, z) then linear acceleration (x, y, z)
+} FusionReading;
+
+typedef struct {
+    int sensor;
+    int64_t timestamp;
+    float values[SENSOR_MAX_VALUES];
+} ReplayedSample;
 
 /* GLOBAL VARIABLES */
 
-struct SensorInputs {
-    Vector3 accelerometerAxis;
-    Vector3 gyroscopeAxis;
+// Registry of the supported sensors, indexed by Sensor
+// NOTE: Types from 37 are written as numbers, older NDKs do not define them
+static const SensorInfo sensorInfos[] = {
+    [SENSOR_ACCELEROMETER]                          = { ASENSOR_TYPE_ACCELEROMETER, "SENSOR_ACCELEROMETER", 3 },
+    [SENSOR_GYROSCOPE]                              = { ASENSOR_TYPE_GYROSCOPE, "SENSOR_GYROSCOPE", 3 },
+    [SENSOR_MAGNETIC_FIELD]                         = { ASENSOR_TYPE_MAGNETIC_FIELD, "SENSOR_MAGNETIC_FIELD", 3 },
+    [SENSOR_LIGHT]                                  = { ASENSOR_TYPE_LIGHT, "SENSOR_LIGHT", 1 },
+    [SENSOR_PRESSURE]                               = { ASENSOR_TYPE_PRESSURE, "SENSOR_PRESSURE", 1 },
+    [SENSOR_PROXIMITY]                              = { ASENSOR_TYPE_PROXIMITY, "SENSOR_PROXIMITY", 1 },
+    [SENSOR_GRAVITY]                                = { ASENSOR_TYPE_GRAVITY, "SENSOR_GRAVITY", 3 },
+    [SENSOR_LINEAR_ACCELERATION]                    = { ASENSOR_TYPE_LINEAR_ACCELERATION, "SENSOR_LINEAR_ACCELERATION", 3 },
+    [SENSOR_ROTATION_VECTOR]                        = { ASENSOR_TYPE_ROTATION_VECTOR, "SENSOR_ROTATION_VECTOR", 5 },
+    [SENSOR_RELATIVE_HUMIDITY]                      = { ASENSOR_TYPE_RELATIVE_HUMIDITY, "SENSOR_RELATIVE_HUMIDITY", 1 },
+    [SENSOR_AMBIENT_TEMPERATURE]                    = { ASENSOR_TYPE_AMBIENT_TEMPERATURE, "SENSOR_AMBIENT_TEMPERATURE", 1 },
+    [SENSOR_MAGNETIC_FIELD_UNCALIBRATED]            = { ASENSOR_TYPE_MAGNETIC_FIELD_UNCALIBRATED, "SENSOR_MAGNETIC_FIELD_UNCALIBRATED", 6 },
+    [SENSOR_GAME_ROTATION_VECTOR]                   = { ASENSOR_TYPE_GAME_ROTATION_VECTOR, "SENSOR_GAME_ROTATION_VECTOR", 4 },
+    [SENSOR_GYROSCOPE_UNCALIBRATED]                 = { ASENSOR_TYPE_GYROSCOPE_UNCALIBRATED, "SENSOR_GYROSCOPE_UNCALIBRATED", 6 },
+    [SENSOR_SIGNIFICANT_MOTION]                     = { ASENSOR_TYPE_SIGNIFICANT_MOTION, "SENSOR_SIGNIFICANT_MOTION", 1 },
+    [SENSOR_STEP_DETECTOR]                          = { ASENSOR_TYPE_STEP_DETECTOR, "SENSOR_STEP_DETECTOR", 1 },
+    [SENSOR_STEP_COUNTER]                           = { ASENSOR_TYPE_STEP_COUNTER, "SENSOR_STEP_COUNTER", 1 },
+    [SENSOR_GEOMAGNETIC_ROTATION_VECTOR]            = { ASENSOR_TYPE_GEOMAGNETIC_ROTATION_VECTOR, "SENSOR_GEOMAGNETIC_ROTATION_VECTOR", 5 },
+    [SENSOR_HEART_RATE]                             = { ASENSOR_TYPE_HEART_RATE, "SENSOR_HEART_RATE", 1 },
+    [SENSOR_POSE_6DOF]                              = { ASENSOR_TYPE_POSE_6DOF, "SENSOR_POSE_6DOF", 15 },
+    [SENSOR_STATIONARY_DETECT]                      = { ASENSOR_TYPE_STATIONARY_DETECT, "SENSOR_STATIONARY_DETECT", 1 },
+    [SENSOR_MOTION_DETECT]                          = { ASENSOR_TYPE_MOTION_DETECT, "SENSOR_MOTION_DETECT", 1 },
+    [SENSOR_HEART_BEAT]                             = { ASENSOR_TYPE_HEART_BEAT, "SENSOR_HEART_BEAT", 1 },
+    [SENSOR_LOW_LATENCY_OFFBODY_DETECT]             = { ASENSOR_TYPE_LOW_LATENCY_OFFBODY_DETECT, "SENSOR_LOW_LATENCY_OFFBODY_DETECT", 1 },
+    [SENSOR_ACCELEROMETER_UNCALIBRATED]             = { ASENSOR_TYPE_ACCELEROMETER_UNCALIBRATED, "SENSOR_ACCELEROMETER_UNCALIBRATED", 6 },
+    [SENSOR_HINGE_ANGLE]                            = { ASENSOR_TYPE_HINGE_ANGLE, "SENSOR_HINGE_ANGLE", 1 },
+    [SENSOR_HEAD_TRACKER]                           = { 37, "SENSOR_HEAD_TRACKER", 6 },
+    [SENSOR_ACCELEROMETER_LIMITED_AXES]             = { 38, "SENSOR_ACCELEROMETER_LIMITED_AXES", 6 },
+    [SENSOR_GYROSCOPE_LIMITED_AXES]                 = { 39, "SENSOR_GYROSCOPE_LIMITED_AXES", 6 },
+    [SENSOR_ACCELEROMETER_LIMITED_AXES_UNCALIBRATED] = { 40, "SENSOR_ACCELEROMETER_LIMITED_AXES_UNCALIBRATED", 9 },
+    [SENSOR_GYROSCOPE_LIMITED_AXES_UNCALIBRATED]    = { 41, "SENSOR_GYROSCOPE_LIMITED_AXES_UNCALIBRATED", 9 },
+    [SENSOR_HEADING]                                = { 42, "SENSOR_HEADING", 2 },
 };
 
+#define SENSOR_COUNT    (int)(sizeof(sensorInfos)/sizeof(sensorInfos[0]))
+
 static struct {
 
     ASensorManager* manager;
     ASensorEventQueue* eventQueue;
-    const ASensor *sensors[2];
     int looperID;
+    bool initialized;                   // Between InitSensorManagerEx() and CloseSensorManager()
+
+    // NOTE: Per sensor data is kept in parallel arrays indexed by Sensor,
+    //       the callback only touches the rows of the sensors it receives
+
+    const ASensor *sensors[SENSOR_COUNT];
+    uint32_t sequences[SENSOR_COUNT];               // Seqlock of each row of 'values'
+    float values[SENSOR_COUNT][SENSOR_MAX_VALUES];  // Latest values, see PublishValues()
+    RingBuffer events[SENSOR_COUNT];                // Filled by the looper callback, drained by the game
+
+    signed char slots[SENSOR_TYPE_MAX];             // Android type to Sensor, -1 if not registered
 
-    struct SensorInputs inputs;
+    FusionState fusion;                 // Only touched by the thread running SensorCallback()
+    FusionReading fusionReading;
+    float fusionBeta;                   // Requested gain, applied by the callback
 
-} State = { 0 };
+    RegisterSensorFunc registerSensor;  // NULL below API 26
+
+    // NOTE: With a dedicated thread, replayed samples are pushed by the game thread
+    //       and dispatched by the sensor thread, which stays the only writer
+    RingBuffer replay;
+    int replayFd;                       // eventfd waking the sensor thread, -1 without it
+    uint64_t replayPushed;              // Samples pushed, game thread only
+    uint64_t replayDispatched;          // Samples dispatched and published, under replayMutex
+    pthread_mutex_t replayMutex;
+    pthread_cond_t replayCond;
+
+    pthread_t thread;                   // Only used with a dedicated sensor thread
+    ALooper *threadLooper;              // Acquired until the thread is joined
+    bool threaded;
+    bool threadStopping;
+    pthread_mutex_t threadMutex;
+    pthread_cond_t threadCond;
+    bool threadReady;
+
+} State = {
+    .replayFd = -1,
+    .replayMutex = PTHREAD_MUTEX_INITIALIZER,
+    .replayCond = PTHREAD_COND_INITIALIZER,
+    .threadMutex = PTHREAD_MUTEX_INITIALIZER,
+    .threadCond = PTHREAD_COND_INITIALIZER
+};
 
 /* INTERNAL FUNCTIONS */
 
+static bool IsValidSensor(Sensor sensor)
+{
+    return (int)sensor >= 0 && (int)sensor < SENSOR_COUNT;
+}
+
 static const char* GetSensorName(Sensor sensor)
 {
-    const char *sensorName = "UNKNOWN";
-    switch (sensor) {
-        case SENSOR_ACCELEROMETER: sensorName = "SENSOR_ACCELEROMETER"; break;
-        case SENSOR_GYROSCOPE: sensorName = "SENSOR_GYROSCOPE"; break;
-        default: break;
+    return IsValidSensor(sensor) ? sensorInfos[sensor].name : "UNKNOWN";
+}
+
+static SensorLimits GetSensorLimits(Sensor sensor)
+{
+    const ASensor *asensor = State.sensors[sensor];
+
+    return (SensorLimits) {
+        .minDelayUs = ASensor_getMinDelay(asensor),
+        .fifoMaxEventCount = ASensor_getFifoMaxEventCount(asensor),
+        .fifoReservedEventCount = ASensor_getFifoReservedEventCount(asensor),
+        .bufferCapacity = SENSOR_RING_CAPACITY
+    };
+}
+
+static bool PrepareSensor(Sensor sensor, const char *action)
+{
+    if (!IsValidSensor(sensor) || State.sensors[sensor] == NULL) {
+        TraceLog(LOG_WARNING, "Cannot %s unsupported sensor: %s", action, GetSensorName(sensor));
+        return false;
+    }
+
+    if (State.eventQueue == NULL) {
+        TraceLog(LOG_WARNING, "Cannot %s sensor without an event queue: %s", action, GetSensorName(sensor));
+        return false;
+    }
+
+    // NOTE: The ring is allocated before the sensor is enabled, so before its first event
+    if (State.events[sensor].data == NULL && !LoadRingBuffer(&State.events[sensor], sizeof(SensorEvent), SENSOR_RING_CAPACITY)) {
+        TraceLog(LOG_WARNING, "Cannot allocate event buffer for sensor: %s", GetSensorName(sensor));
+        return false;
     }
-    return sensorName;
+
+    return true;
+}
+
+// Latest values are published with a seqlock, see seqlock.h
+
+static void PublishValues(uint32_t *sequence, float *dst, const float *src, int count)
+{
+    // NOTE: Single writer, the thread running SensorCallback()
+    uint32_t current = BeginSeqlockWrite(sequence);
+
+    for (int i = 0; i < count; i++) __atomic_store(&dst[i], &src[i], __ATOMIC_RELAXED);
+
+    EndSeqlockWrite(sequence, current);
+}
+
+static void ReadValues(uint32_t *sequence, const float *src, float *dst, int count)
+{
+    uint32_t current = 0;
+
+    // NOTE: Never blocks, a retry only happens if values are published during the copy
+    do {
+        current = BeginSeqlockRead(sequence);
+
+        for (int i = 0; i < count; i++) __atomic_load(&src[i], &dst[i], __ATOMIC_RELAXED);
+    } while (!EndSeqlockRead(sequence, current));
+}
+
+static Vector3 ReadSensorVector(Sensor sensor)
+{
+    Vector3 axis = { 0 };
+    ReadValues(&State.sequences[sensor], State.values[sensor], &axis.x, 3);
+    return axis;
+}
+
+static void PublishFusion(void)
+{
+    float values[7];
+
+    values[0] = State.fusion.q[0];
+    values[1] = State.fusion.q[1];
+    values[2] = State.fusion.q[2];
+    values[3] = State.fusion.q[3];
+
+    GetFusionLinearAccel(&State.fusion, &values[4]);
+
+    PublishValues(&State.fusionReading.sequence, State.fusionReading.values, values, 7);
+}
+
+static void ReadEventValues(Sensor sensor, const ASensorEvent *event, float *values)
+{
+    // NOTE: The step counter is the only sensor reporting an integer
+    if (sensor == SENSOR_STEP_COUNTER) values[0] = (float)event->u64.step_counter;
+    else memcpy(values, event->data, sensorInfos[sensor].valueCount*sizeof(float));
+}
+
+static void DispatchSensorValues(Sensor sensor, int64_t timestamp, const float *values)
+{
+    PublishValues(&State.sequences[sensor], State.values[sensor], values, sensorInfos[sensor].valueCount);
+
+    // NOTE: If the game does not drain fast enough the newest events are dropped,
+    //       the queued ones stay in order so that integration keeps a consistent timeline
+    SensorEvent queued = { timestamp, values[0], values[1], values[2] };
+    PushRingBuffer(&State.events[sensor], &queued, 1);
+
+    if (sensor == SENSOR_ACCELEROMETER) UpdateFusionAccel(&State.fusion, values[0], values[1], values[2]);
+    else if (sensor == SENSOR_GYROSCOPE) UpdateFusionGyro(&State.fusion, timestamp, values[0], values[1], values[2]);
+}
+
+static void RecordSensorValues(Sensor sensor, int64_t timestamp, const float *values)
+{
+    InputRecord record = {
+        .kind = INPUT_RECORD_SENSOR,
+        .id = (unsigned char)sensor,
+        .count = (unsigned char)sensorInfos[sensor].valueCount,
+        .timestamp = timestamp
+    };
+
+    memcpy(record.values, values, record.count*sizeof(float));
+    RecordInput(&record);
 }
 
 static int SensorCallback(int fd, int events, void* data)
 {
-    ASensorEvent event;
-    while (ASensorEventQueue_getEvents(State.eventQueue, &event, 1) > 0) {
-        switch (event.type) {
-            case ASENSOR_TYPE_ACCELEROMETER:
-                State.inputs.accelerometerAxis.x = event.acceleration.x;
-                State.inputs.accelerometerAxis.y = event.acceleration.y;
-                State.inputs.accelerometerAxis.z = event.acceleration.z;
-                break;
-            case ASENSOR_TYPE_GYROSCOPE:
-                State.inputs.gyroscopeAxis.x = event.gyro.x;
-                State.inputs.gyroscopeAxis.y = event.gyro.y;
-                State.inputs.gyroscopeAxis.z = event.gyro.z;
-                break;
-            default:
-                break;
+    ASensorEvent batch[SENSOR_EVENT_BATCH];
+    ssize_t count = 0;
+
+    __atomic_load(&State.fusionBeta, &State.fusion.beta, __ATOMIC_RELAXED);
+
+    while ((count = ASensorEventQueue_getEvents(State.eventQueue, batch, SENSOR_EVENT_BATCH)) > 0) {
+
+        // NOTE: During a replay the queue is still drained, but live events are ignored
+        if (IsInputReplayActive()) continue;
+
+        bool recording = IsInputRecording();
+
+        for (ssize_t i = 0; i < count; i++) {
+            const ASensorEvent *event = &batch[i];
+
+            int slot = (event->type >= 0 && event->type < SENSOR_TYPE_MAX) ? State.slots[event->type] : -1;
+            if (slot < 0) continue;
+
+            float values[SENSOR_MAX_VALUES] = { 0 };
+            ReadEventValues((Sensor)slot, event, values);
+
+            if (recording) RecordSensorValues((Sensor)slot, event->timestamp, values);
+            DispatchSensorValues((Sensor)slot, event->timestamp, values);
+        }
+
+        // NOTE: The filter runs for every event, but is only published once per batch
+        PublishFusion();
+    }
+    return 1;
+}
+
+static void WakeReplay(void)
+{
+    uint64_t wake = 1;
+    ssize_t unused = write(State.replayFd, &wake, sizeof(wake));
+    (void)unused;   // Already signaled if the counter is saturated
+}
+
+static int ReplayCallback(int fd, int events, void* data)
+{
+    // NOTE: Only resets the eventfd, the samples are counted by the ring
+    uint64_t pending = 0;
+    ssize_t unused = read(fd, &pending, sizeof(pending));
+    (void)unused;
+
+    __atomic_load(&State.fusionBeta, &State.fusion.beta, __ATOMIC_RELAXED);
+
+    ReplayedSample samples[16];
+    int count = 0;
+
+    while ((count = PopRingBuffer(&State.replay, samples, 16)) > 0) {
+        for (int i = 0; i < count; i++) {
+            DispatchSensorValues((Sensor)samples[i].sensor, samples[i].timestamp, samples[i].values);
         }
+        PublishFusion();
+
+        pthread_mutex_lock(&State.replayMutex);
+        State.replayDispatched += count;
+        pthread_cond_broadcast(&State.replayCond);
+        pthread_mutex_unlock(&State.replayMutex);
     }
+
     return 1;
 }
 
+static void CreateSensorEventQueue(ALooper *looper)
+{
+    State.looperID = 1;
+    State.eventQueue = ASensorManager_createEventQueue(State.manager, looper, State.looperID, SensorCallback, NULL);
+
+    if (State.eventQueue == NULL) {
+        TraceLog(LOG_ERROR, "Cannot create sensor event queue");
+    }
+}
+
+static void *SensorThread(void *arg)
+{
+    // NOTE: On Linux the nice value is per thread, this only affects the sensor thread
+    if (setpriority(PRIO_PROCESS, 0, SENSOR_THREAD_PRIORITY) != 0) {
+        TraceLog(LOG_WARNING, "Cannot raise sensor thread priority");
+    }
+
+    ALooper *looper = ALooper_prepare(0);
+    CreateSensorEventQueue(looper);
+
+    // NOTE: Kept alive for ALooper_wake() in CloseSensorManager(), even if this thread already left
+    ALooper_acquire(looper);
+    State.threadLooper = looper;
+
+    // Replayed samples are dispatched from this thread too
+    if (LoadRingBuffer(&State.replay, sizeof(ReplayedSample), SENSOR_REPLAY_CAPACITY)) {
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd >= 0 && ALooper_addFd(looper, fd, ALOOPER_POLL_CALLBACK, ALOOPER_EVENT_INPUT, ReplayCallback, NULL) == 1) {
+            State.replayFd = fd;
+        }
+        else {
+            if (fd >= 0) close(fd);
+            TraceLog(LOG_WARNING, "Cannot route replayed sensor events to the sensor thread");
+        }
+    }
+
+    pthread_mutex_lock(&State.threadMutex);
+    State.threadReady = true;
+    pthread_cond_signal(&State.threadCond);
+    pthread_mutex_unlock(&State.threadMutex);
+
+    // Events are dispatched to SensorCallback() as soon as they arrive, whatever the frame time
+    while (!__atomic_load_n(&State.threadStopping, __ATOMIC_ACQUIRE)) {
+        ALooper_pollOnce(-1, NULL, NULL, NULL);
+    }
+
+    // The queue and the eventfd are attached to the looper of this thread, released here
+    if (State.eventQueue != NULL) {
+        ASensorManager_destroyEventQueue(State.manager, State.eventQueue);
+        State.eventQueue = NULL;
+    }
+
+    if (State.replayFd >= 0) {
+        ALooper_removeFd(looper, State.replayFd);
+        close(State.replayFd);
+        State.replayFd = -1;
+    }
+
+    return NULL;
+}
+
 /* PUBLIC API */
 
 void InitSensorManager(void)
 {
+    InitSensorManagerEx(false);
+}
+
+void InitSensorManagerEx(bool dedicatedThread)
+{
+    // NOTE: A second call would leak the queue, and with it the thread, keep the first one
+    if (State.initialized) {
+        if (dedicatedThread != State.threaded) {
+            TraceLog(LOG_WARNING, "Sensor manager already initialized %s a dedicated thread, call CloseSensorManager() first",
+                     State.threaded ? "with" : "without");
+        }
+        return;
+    }
+
     State.manager = ASensorManager_getInstance();
 
-    // Get all available sensors
+    // Register the default sensor of each known type
+
+    memset(State.slots, -1, sizeof(State.slots));
+
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        State.slots[sensorInfos[i].type] = (signed char)i;
+        State.sensors[i] = ASensorManager_getDefaultSensor(State.manager, sensorInfos[i].type);
+    }
+
+    // List all available sensors
 
     ASensorList sensorList;
     int sensorCount = ASensorManager_getSensorList(State.manager, &sensorList);
@@ -95,51 +451,123 @@ void InitSensorManager(void)
         const char *type = ASensor_getStringType(sensorList[i]);
         const char *vendor = ASensor_getVendor(sensorList[i]);
         const char *name = ASensor_getName(sensorList[i]);
-        bool supported = true;
-        switch (ASensor_getType(sensorList[i])) {
-            case ASENSOR_TYPE_ACCELEROMETER:
-                State.sensors[SENSOR_ACCELEROMETER] = sensorList[i];
-                break;
-            case ASENSOR_TYPE_GYROSCOPE:
-                State.sensors[SENSOR_GYROSCOPE] = sensorList[i];
-                break;
-            default:
-                supported = false;
-                break;
-        }
+        int typeValue = ASensor_getType(sensorList[i]);
+        bool supported = (typeValue >= 0 && typeValue < SENSOR_TYPE_MAX && State.slots[typeValue] >= 0);
         TraceLog(LOG_INFO, "Sensor %s:\n    > Name: %s\n    > Vendor: %s\n    > Supported: %s",
                  type, name, vendor, supported ? "YES" : "NO");
     }
 
+    // Start the fusion filter from the identity orientation
+
+    State.fusionBeta = FUSION_DEFAULT_BETA;
+    InitFusion(&State.fusion, State.fusionBeta);
+    PublishFusion();
+
+    // Resolve the API 26 functions, if available
+
+    void *libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_NOLOAD);
+    if (libandroid != NULL) {
+        State.registerSensor = (RegisterSensorFunc)dlsym(libandroid, "ASensorEventQueue_registerSensor");
+        dlclose(libandroid);    // NOTE: Still loaded, we are linked against it
+    }
+
     // Create event queue
 
-    State.looperID = 1;
-    State.eventQueue = ASensorManager_createEventQueue(
-            State.manager, ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS),
-            State.looperID, SensorCallback, NULL);
+    if (!dedicatedThread) {
+        // NOTE: Events are then dispatched when raylib polls the looper of this thread
+        CreateSensorEventQueue(ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS));
+        State.initialized = true;
+        return;
+    }
 
-    if (State.eventQueue == NULL) {
-        TraceLog(LOG_ERROR, "Cannot create sensor event queue");
+    State.threadReady = false;
+    State.threadStopping = false;
+
+    if (pthread_create(&State.thread, NULL, SensorThread, NULL) != 0) {
+        TraceLog(LOG_ERROR, "Cannot create sensor thread");
+        return;
     }
+
+    pthread_setname_np(State.thread, "raymob-sensor");
+
+    // Wait for the event queue, so sensors can be enabled right after this call
+    pthread_mutex_lock(&State.threadMutex);
+    while (!State.threadReady) pthread_cond_wait(&State.threadCond, &State.threadMutex);
+    pthread_mutex_unlock(&State.threadMutex);
+
+    State.threaded = true;
+    State.initialized = true;
 }
 
-void EnableSensor(Sensor sensor)
+void CloseSensorManager(void)
 {
-    if (State.sensors[sensor] == NULL) {
-        TraceLog(LOG_WARNING, "Cannot enable unsupported sensor: %s", GetSensorName(sensor));
-        return;
+    if (!State.initialized) return;
+
+    if (State.threaded) {
+        // NOTE: The thread checks the flag after each wake up, then releases its queue
+        __atomic_store_n(&State.threadStopping, true, __ATOMIC_RELEASE);
+        ALooper_wake(State.threadLooper);
+        pthread_join(State.thread, NULL);
+
+        ALooper_release(State.threadLooper);
+        State.threadLooper = NULL;
+        State.threaded = false;
+
+        UnloadRingBuffer(&State.replay);
+        State.replayPushed = 0;
+        State.replayDispatched = 0;
     }
+    else if (State.eventQueue != NULL) {
+        ASensorManager_destroyEventQueue(State.manager, State.eventQueue);
+        State.eventQueue = NULL;
+    }
+
+    // NOTE: No callback can run anymore, the rings are allocated again when a sensor is enabled
+    for (int i = 0; i < SENSOR_COUNT; i++) UnloadRingBuffer(&State.events[i]);
+
+    State.initialized = false;
+}
+
+void EnableSensor(Sensor sensor)
+{
+    if (!PrepareSensor(sensor, "enable")) return;
     if (ASensorEventQueue_enableSensor(State.eventQueue, State.sensors[sensor]) != 0) {
         TraceLog(LOG_ERROR, "Cannot enable sensor: %s", GetSensorName(sensor));
     }
 }
 
+void EnableSensorEx(Sensor sensor, int samplingPeriodUs, int64_t maxBatchLatencyUs)
+{
+    if (!PrepareSensor(sensor, "enable")) return;
+
+    SensorRate rate = ResolveSensorRate(GetSensorLimits(sensor), samplingPeriodUs, maxBatchLatencyUs);
+
+    int result = 0;
+
+    if (State.registerSensor != NULL) {
+        result = State.registerSensor(State.eventQueue, State.sensors[sensor], rate.samplingPeriodUs, rate.maxBatchLatencyUs);
+    } else {
+        // NOTE: Below API 26 there is no batching, only the rate can be set
+        result = ASensorEventQueue_enableSensor(State.eventQueue, State.sensors[sensor]);
+        if (result == 0) result = ASensorEventQueue_setEventRate(State.eventQueue, State.sensors[sensor], rate.samplingPeriodUs);
+    }
+
+    if (result != 0) {
+        TraceLog(LOG_ERROR, "Cannot enable sensor: %s", GetSensorName(sensor));
+        return;
+    }
+
+    TraceLog(LOG_INFO, "Sensor %s enabled: period %ius, batch latency %lldus", GetSensorName(sensor),
+             rate.samplingPeriodUs, (State.registerSensor != NULL) ? (long long)rate.maxBatchLatencyUs : 0LL);
+}
+
 void DisableSensor(Sensor sensor)
 {
-    if (State.sensors[sensor] == NULL) {
+    if (!IsValidSensor(sensor) || State.sensors[sensor] == NULL) {
         TraceLog(LOG_WARNING, "Cannot disable unsupported sensor: %s", GetSensorName(sensor));
         return;
     }
+    if (State.eventQueue == NULL) return;   // Closed, every sensor is already disabled
     if (ASensorEventQueue_disableSensor(State.eventQueue, State.sensors[sensor]) != 0) {
         TraceLog(LOG_ERROR, "Cannot disable sensor: %s", GetSensorName(sensor));
     }
@@ -147,15 +575,129 @@ void DisableSensor(Sensor sensor)
 
 bool IsSensorAvailable(Sensor sensor)
 {
-    return State.sensors[sensor] != NULL;
+    return IsValidSensor(sensor) && State.sensors[sensor] != NULL;
+}
+
+int GetSensorMinDelay(Sensor sensor)
+{
+    return IsSensorAvailable(sensor) ? ASensor_getMinDelay(State.sensors[sensor]) : -1;
+}
+
+int GetSensorFifoMaxEventCount(Sensor sensor)
+{
+    return IsSensorAvailable(sensor) ? ASensor_getFifoMaxEventCount(State.sensors[sensor]) : 0;
+}
+
+int GetSensorFifoReservedEventCount(Sensor sensor)
+{
+    return IsSensorAvailable(sensor) ? ASensor_getFifoReservedEventCount(State.sensors[sensor]) : 0;
+}
+
+int DrainSensorEvents(Sensor sensor, SensorEvent *events, int maxEvents)
+{
+    if (!IsValidSensor(sensor)) return 0;
+    return PopRingBuffer(&State.events[sensor], events, maxEvents);
 }
 
 Vector3 GetAccelerotmerAxis(void)
 {
-    return State.inputs.accelerometerAxis;
+    return ReadSensorVector(SENSOR_ACCELEROMETER);
 }
 
 Vector3 GetGyroscopeAxis(void)
 {
-    return State.inputs.gyroscopeAxis;
+    return ReadSensorVector(SENSOR_GYROSCOPE);
+}
+
+int GetSensorValues(Sensor sensor, float *values, int maxValues)
+{
+    if (!IsValidSensor(sensor) || values == NULL) return 0;
+
+    int count = sensorInfos[sensor].valueCount;
+    if (count > maxValues) count = maxValues;
+    if (count <= 0) return 0;
+
+    ReadValues(&State.sequences[sensor], State.values[sensor], values, count);
+
+    return count;
+}
+
+Quaternion GetDeviceOrientation(void)
+{
+    float values[7];
+    ReadValues(&State.fusionReading.sequence, State.fusionReading.values, values, 7);
+
+    // NOTE: Before initialization everything is zero, which is not a valid rotation
+    if (values[0] == 0.0f && values[1] == 0.0f && values[2] == 0.0f && values[3] == 0.0f) {
+        return (Quaternion){ 0.0f, 0.0f, 0.0f, 1.0f };
+    }
+
+    return (Quaternion){ values[1], values[2], values[3], values[0] };
+}
+
+Vector3 GetLinearAcceleration(void)
+{
+    float values[7];
+    ReadValues(&State.fusionReading.sequence, State.fusionReading.values, values, 7);
+
+    return (Vector3){ values[4], values[5], values[6] };
+}
+
+void SetSensorFusionGain(float beta)
+{
+    __atomic_store(&State.fusionBeta, &beta, __ATOMIC_RELAXED);
+}
+
+void ReplaySensorEvent(Sensor sensor, int64_t timestamp, const float *values, int count)
+{
+    if (!IsValidSensor(sensor)) return;
+
+    ReplayedSample sample = { .sensor = sensor, .timestamp = timestamp };
+    memcpy(sample.values, values, ((count < SENSOR_MAX_VALUES) ? count : SENSOR_MAX_VALUES)*sizeof(float));
+
+    // NOTE: Without a dedicated thread, SensorCallback() also runs on the game thread
+    if (!State.threaded) {
+        DispatchSensorValues(sensor, timestamp, sample.values);
+        PublishFusion();
+        return;
+    }
+
+    if (State.replayFd < 0) return;
+
+    // The sensor thread dispatches it, a batch of live events may still be in flight
+    int retries = 0;
+
+    while (PushRingBuffer(&State.replay, &sample, 1) == 0) {
+        WakeReplay();
+        if (++retries > SENSOR_REPLAY_MAX_RETRIES) {
+            TraceLog(LOG_WARNING, "Replayed sensor event dropped, sensor thread not draining");
+            return;     // NOTE: Not counted as pushed, FlushReplayedSensorEvents() does not wait for it
+        }
+        sched_yield();
+    }
+
+    State.replayPushed++;
+    WakeReplay();
+}
+
+void FlushReplayedSensorEvents(void)
+{
+    if (!State.threaded || State.replayFd < 0) return;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += SENSOR_REPLAY_FLUSH_TIMEOUT*1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&State.replayMutex);
+    while (State.replayDispatched < State.replayPushed) {
+        if (pthread_cond_timedwait(&State.replayCond, &State.replayMutex, &deadline) != 0) {
+            TraceLog(LOG_WARNING, "Replayed sensor events not dispatched in time");
+            break;
+        }
+    }
+    pthread_mutex_unlock(&State.replayMutex);
 }
@@ -0,0 +1,153 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "sensor_fusion.h"
+
+#include <math.h>
+
+/* DEFINES */
+
+#define FUSION_MAX_STEP     0.1f        // Larger gaps (e.g. after a pause) are not integrated
+#define STANDARD_GRAVITY    9.80665f
+
+/* VECTOR TYPES */
+
+// NOTE: The filter works on the four quaternion lanes at once,
+//       every operation below maps to one or two instructions
+
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+typedef float32x4_t Vec4;
+
+static inline Vec4 Vec4Set(float a, float b, float c, float d) { const float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+static inline Vec4 Vec4Load(const float *p) { return vld1q_f32(p); }
+static inline void Vec4Store(float *p, Vec4 v) { vst1q_f32(p, v); }
+static inline Vec4 Vec4Scale(Vec4 a, float s) { return vmulq_n_f32(a, s); }
+static inline Vec4 Vec4MulAdd(Vec4 acc, Vec4 a, float s) { return vfmaq_n_f32(acc, a, s); }
+static inline float Vec4Dot(Vec4 a, Vec4 b) { return vaddvq_f32(vmulq_f32(a, b)); }
+
+#elif defined(__SSE__)
+
+#include <xmmintrin.h>
+
+typedef __m128 Vec4;
+
+static inline Vec4 Vec4Set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static inline Vec4 Vec4Load(const float *p) { return _mm_loadu_ps(p); }
+static inline void Vec4Store(float *p, Vec4 v) { _mm_storeu_ps(p, v); }
+static inline Vec4 Vec4Scale(Vec4 a, float s) { return _mm_mul_ps(a, _mm_set1_ps(s)); }
+static inline Vec4 Vec4MulAdd(Vec4 acc, Vec4 a, float s) { return _mm_add_ps(acc, _mm_mul_ps(a, _mm_set1_ps(s))); }
+
+static inline float Vec4Dot(Vec4 a, Vec4 b)
+{
+    __m128 m = _mm_mul_ps(a, b);
+    __m128 s = _mm_add_ps(m, _mm_movehl_ps(m, m));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+#else
+
+typedef struct { float v[4]; } Vec4;
+
+static inline Vec4 Vec4Set(float a, float b, float c, float d) { return (Vec4){ { a, b, c, d } }; }
+static inline Vec4 Vec4Load(const float *p) { return (Vec4){ { p[0], p[1], p[2], p[3] } }; }
+static inline void Vec4Store(float *p, Vec4 v) { for (int i = 0; i < 4; i++) p[i] = v.v[i]; }
+static inline Vec4 Vec4Scale(Vec4 a, float s) { for (int i = 0; i < 4; i++) a.v[i] *= s; return a; }
+static inline Vec4 Vec4MulAdd(Vec4 acc, Vec4 a, float s) { for (int i = 0; i < 4; i++) acc.v[i] += a.v[i]*s; return acc; }
+static inline float Vec4Dot(Vec4 a, Vec4 b) { return a.v[0]*b.v[0] + a.v[1]*b.v[1] + a.v[2]*b.v[2] + a.v[3]*b.v[3]; }
+
+#endif
+
+/* PUBLIC API */
+
+void InitFusion(FusionState *fusion, float beta)
+{
+    *fusion = (FusionState){ .q = { 1.0f, 0.0f, 0.0f, 0.0f }, .beta = beta };
+}
+
+void UpdateFusionAccel(FusionState *fusion, float ax, float ay, float az)
+{
+    fusion->accel[0] = ax;
+    fusion->accel[1] = ay;
+    fusion->accel[2] = az;
+    fusion->hasAccel = true;
+}
+
+void UpdateFusionGyro(FusionState *fusion, int64_t timestamp, float gx, float gy, float gz)
+{
+    int64_t previous = fusion->lastTimestamp;
+    fusion->lastTimestamp = timestamp;
+
+    float dt = (float)(timestamp - previous)*1e-9f;
+    if (previous == 0 || dt <= 0.0f || dt > FUSION_MAX_STEP) return;
+
+    const float q0 = fusion->q[0], q1 = fusion->q[1], q2 = fusion->q[2], q3 = fusion->q[3];
+
+    // Rate of change from the gyroscope, 0.5*q*(0, gx, gy, gz)
+
+    Vec4 qDot = Vec4Scale(Vec4Set(-q1, q0, q3, -q2), 0.5f*gx);
+    qDot = Vec4MulAdd(qDot, Vec4Set(-q2, -q3, q0, q1), 0.5f*gy);
+    qDot = Vec4MulAdd(qDot, Vec4Set(-q3, q2, -q1, q0), 0.5f*gz);
+
+    // Gradient descent step, pulling the predicted gravity towards the measured one
+
+    float norm = sqrtf(fusion->accel[0]*fusion->accel[0] + fusion->accel[1]*fusion->accel[1] + fusion->accel[2]*fusion->accel[2]);
+
+    if (fusion->hasAccel && norm > 0.0f) {
+        float ax = fusion->accel[0]/norm, ay = fusion->accel[1]/norm, az = fusion->accel[2]/norm;
+
+        float f0 = 2.0f*(q1*q3 - q0*q2) - ax;
+        float f1 = 2.0f*(q0*q1 + q2*q3) - ay;
+        float f2 = 2.0f*(0.5f - q1*q1 - q2*q2) - az;
+
+        // NOTE: Transposed jacobian times the objective function, one row per component
+        Vec4 step = Vec4Scale(Vec4Set(-2.0f*q2, 2.0f*q3, -2.0f*q0, 2.0f*q1), f0);
+        step = Vec4MulAdd(step, Vec4Set(2.0f*q1, 2.0f*q0, 2.0f*q3, 2.0f*q2), f1);
+        step = Vec4MulAdd(step, Vec4Set(0.0f, -4.0f*q1, -4.0f*q2, 0.0f), f2);
+
+        float stepNorm = Vec4Dot(step, step);
+        if (stepNorm > 0.0f) qDot = Vec4MulAdd(qDot, step, -fusion->beta/sqrtf(stepNorm));
+    }
+
+    // Integrate and normalize
+
+    Vec4 q = Vec4MulAdd(Vec4Load(fusion->q), qDot, dt);
+    q = Vec4Scale(q, 1.0f/sqrtf(Vec4Dot(q, q)));
+
+    Vec4Store(fusion->q, q);
+}
+
+void GetFusionLinearAccel(const FusionState *fusion, float out[3])
+{
+    const float q0 = fusion->q[0], q1 = fusion->q[1], q2 = fusion->q[2], q3 = fusion->q[3];
+
+    // NOTE: At rest the accelerometer measures +g along the earth Z axis,
+    //       expressed here in the device frame
+    out[0] = fusion->accel[0] - STANDARD_GRAVITY*2.0f*(q1*q3 - q0*q2);
+    out[1] = fusion->accel[1] - STANDARD_GRAVITY*2.0f*(q0*q1 + q2*q3);
+    out[2] = fusion->accel[2] - STANDARD_GRAVITY*(q0*q0 - q1*q1 - q2*q2 + q3*q3);
+}
@@ -0,0 +1,72 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef RAYMOB_SENSOR_FUSION_H
+#define RAYMOB_SENSOR_FUSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Madgwick IMU filter, fusing the gyroscope and the accelerometer into an
+ * orientation quaternion. Plain C, vectorized with NEON on arm64 and SSE on
+ * x86, so that it can be built and checked on any host.
+ *
+ * The quaternion (w, x, y, z) rotates device frame vectors into the earth
+ * frame, whose Z axis points up.
+ */
+
+#define FUSION_DEFAULT_BETA     0.1f    // Filter gain, higher trusts the accelerometer more
+
+typedef struct FusionState {
+    float q[4];                 // w, x, y, z
+    float accel[3];             // Latest accelerometer sample, in m/s^2
+    bool hasAccel;
+    int64_t lastTimestamp;      // Timestamp of the previous gyroscope sample, in ns
+    float beta;
+} FusionState;
+
+/**
+ * @brief Resets the filter to the identity orientation.
+ */
+void InitFusion(FusionState *fusion, float beta);
+
+/**
+ * @brief Stores an accelerometer sample, used by the next gyroscope update.
+ */
+void UpdateFusionAccel(FusionState *fusion, float ax, float ay, float az);
+
+/**
+ * @brief Integrates a gyroscope sample (rad/s), the time step comes from the timestamps.
+ */
+void UpdateFusionGyro(FusionState *fusion, int64_t timestamp, float gx, float gy, float gz);
+
+/**
+ * @brief Latest accelerometer sample with gravity removed, in the device frame.
+ */
+void GetFusionLinearAccel(const FusionState *fusion, float out[3]);
+
+#endif //RAYMOB_SENSOR_FUSION_H
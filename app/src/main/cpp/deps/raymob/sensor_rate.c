@@ -0,0 +1,52 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "sensor_rate.h"
+
+SensorRate ResolveSensorRate(SensorLimits limits, int samplingPeriodUs, int64_t maxBatchLatencyUs)
+{
+    SensorRate rate = { samplingPeriodUs, maxBatchLatencyUs };
+
+    // Sampling period
+
+    if (rate.samplingPeriodUs <= 0) rate.samplingPeriodUs = SENSOR_DEFAULT_PERIOD_US;
+    if (rate.samplingPeriodUs < limits.minDelayUs) rate.samplingPeriodUs = limits.minDelayUs;
+
+    // Batch latency, bounded by the number of events that can be held at this period
+
+    if (rate.maxBatchLatencyUs <= 0 || limits.fifoMaxEventCount <= 0) {
+        rate.maxBatchLatencyUs = 0;
+        return rate;
+    }
+
+    // NOTE: Only the reserved part of the FIFO is guaranteed, the rest is shared
+    //       with other sensors, so it is only relied upon when nothing is reserved
+    int64_t fifoEvents = (limits.fifoReservedEventCount > 0) ? limits.fifoReservedEventCount : limits.fifoMaxEventCount;
+    if (limits.bufferCapacity > 0 && limits.bufferCapacity < fifoEvents) fifoEvents = limits.bufferCapacity;
+
+    int64_t maxLatency = fifoEvents*rate.samplingPeriodUs;
+    if (rate.maxBatchLatencyUs > maxLatency) rate.maxBatchLatencyUs = maxLatency;
+
+    return rate;
+}
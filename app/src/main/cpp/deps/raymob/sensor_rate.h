@@ -0,0 +1,62 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef RAYMOB_SENSOR_RATE_H
+#define RAYMOB_SENSOR_RATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Sampling rate and hardware batching policy of the sensors. Plain C, it
+ * only works on the limits reported by the sensor, so that it can be built
+ * and checked on any host without a sensor backend.
+ */
+
+#define SENSOR_DEFAULT_PERIOD_US    20000   // Same as SENSOR_DELAY_GAME on the Java side
+
+typedef struct SensorLimits {
+    int minDelayUs;                 // 0 for sensors that only report on change
+    int fifoMaxEventCount;          // 0 if the sensor has no hardware FIFO
+    int fifoReservedEventCount;     // Part of the FIFO guaranteed to this sensor
+    int bufferCapacity;             // Events the native ring can hold between two drains
+} SensorLimits;
+
+typedef struct SensorRate {
+    int samplingPeriodUs;
+    int64_t maxBatchLatencyUs;      // 0 means events are delivered as soon as possible
+} SensorRate;
+
+/**
+ * @brief Clamps a requested rate and batch latency to what a sensor supports.
+ *
+ * A negative or null period selects SENSOR_DEFAULT_PERIOD_US. The batch
+ * latency is reduced so that a full batch fits both in the hardware FIFO
+ * and in the native ring, otherwise events would be lost.
+ */
+SensorRate ResolveSensorRate(SensorLimits limits, int samplingPeriodUs, int64_t maxBatchLatencyUs);
+
+#endif //RAYMOB_SENSOR_RATE_H
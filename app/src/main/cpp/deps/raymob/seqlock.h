@@ -0,0 +1,87 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef RAYMOB_SEQLOCK_H
+#define RAYMOB_SEQLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sched.h>
+
+/*
+ * Internal header, not part of the public raymob API.
+ *
+ * Sequence lock for a block of values with a single writer and any number
+ * of readers. The sequence is odd while the values are written, a reader
+ * copies the values between BeginSeqlockRead() and EndSeqlockRead() and
+ * retries until it saw the same even sequence on both sides:
+ *
+ *     uint32_t current;
+ *     do {
+ *         current = BeginSeqlockRead(&sequence);
+ *         ... relaxed atomic loads of the values ...
+ *     } while (!EndSeqlockRead(&sequence, current));
+ *
+ * NOTE: The values themselves must be accessed with relaxed atomics, plain C,
+ *       it does not depend on Android and can be built on any host.
+ */
+
+#define SEQLOCK_SPIN_LIMIT      64      // Busy reads of an odd sequence before yielding
+
+static inline uint32_t BeginSeqlockWrite(uint32_t *sequence)
+{
+    // NOTE: Single writer, so its own sequence can be read without ordering
+    uint32_t current = __atomic_load_n(sequence, __ATOMIC_RELAXED);
+
+    __atomic_store_n(sequence, current + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    return current;
+}
+
+static inline void EndSeqlockWrite(uint32_t *sequence, uint32_t current)
+{
+    __atomic_store_n(sequence, current + 2, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t BeginSeqlockRead(const uint32_t *sequence)
+{
+    uint32_t current = 0;
+
+    // NOTE: The writer may be preempted mid-write, yield rather than burn its time slice
+    for (int spins = 0; (current = __atomic_load_n(sequence, __ATOMIC_ACQUIRE)) & 1; spins++) {
+        if (spins >= SEQLOCK_SPIN_LIMIT) sched_yield();
+    }
+
+    return current;
+}
+
+static inline bool EndSeqlockRead(const uint32_t *sequence, uint32_t current)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(sequence, __ATOMIC_RELAXED) == current;
+}
+
+#endif // RAYMOB_SEQLOCK_H
@@ -22,189 +22,329 @@
  *  SOFTWARE.
  */
 
+
 #include "raymob.h"
+#include "bridge.h"
+#include "ring_buffer.h"
+#include "input_record.h"
+
+#include <pthread.h>
 #include <string.h>
+#include <time.h>
 
-void ShowSoftKeyboard(void)
+/* DEFINES */
+
+#define SOFT_KEY_QUEUE_CAPACITY     64
+#define SOFT_TEXT_MAX_PENDING       (1 << 20)   // Committed text kept while the game does not read it
+
+#define KEYCODE_ENTER    66
+#define KEYCODE_DEL      67
+
+/* TYPES */
+
+typedef struct TextChunk {
+    char *data;
+    int length;
+    int capacity;           // Terminator excluded
+} TextChunk;
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    // NOTE: Key events are pushed by Java (UI thread) through OnSoftKeyEvent(),
+    //       or by the input replay (game thread), never by both at once
+
+    RingBuffer queue;               // Drained by PollSoftKeyEvents()
+    pthread_once_t queueOnce;
+
+    pthread_mutex_t lastKeyMutex;
+    SoftKeyEvent lastKey;           // Cleared by ClearLastSoftKey()
+
+    // NOTE: Text from the input method is written by the UI thread in the pending
+    //       chunks, and swapped or copied to the read chunks by the game thread
+
+    pthread_mutex_t textMutex;
+    TextChunk committed;            // Appended until read by GetSoftKeyboardCommittedText()
+    TextChunk committedRead;
+    TextChunk composing;            // Replaced on every composing update
+    TextChunk composingRead;
+    unsigned int composingVersion;
+    unsigned int composingReadVersion;
+
+} State = {
+    .queueOnce = PTHREAD_ONCE_INIT,
+    .lastKeyMutex = PTHREAD_MUTEX_INITIALIZER,
+    .textMutex = PTHREAD_MUTEX_INITIALIZER
+};
+
+/* INTERNAL FUNCTIONS */
+
+static void InitSoftKeyQueue(void)
 {
-    jobject context = GetNativeLoaderInstance();
+    if (!LoadRingBuffer(&State.queue, sizeof(SoftKeyEvent), SOFT_KEY_QUEUE_CAPACITY)) {
+        TraceLog(LOG_WARNING, "RAYMOB: Failed to allocate soft keyboard event queue");
+    }
+}
 
-    if (context != NULL) {
-        JNIEnv* env = AttachCurrentThread();
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, context);
+static SoftKeyEvent GetLastSoftKey(void)
+{
+    GetBridge();    // Registers the natives on first use, like PollSoftKeyEvents()
 
-        jfieldID softKeyboardField = (*env)->GetFieldID(env, nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
-        jobject softKeyboard = (*env)->GetObjectField(env, context, softKeyboardField);
+    pthread_mutex_lock(&State.lastKeyMutex);
+    SoftKeyEvent key = State.lastKey;
+    pthread_mutex_unlock(&State.lastKeyMutex);
 
-        if (softKeyboard != NULL) {
-            jclass softKeyboardClass = (*env)->GetObjectClass(env, softKeyboard);
-            jmethodID method = (*env)->GetMethodID(env, softKeyboardClass, "showKeyboard", "()V");
-            (*env)->CallVoidMethod(env, softKeyboard, method);
-        }
+    return key;
+}
+
+static void SetLastSoftKey(SoftKeyEvent key)
+{
+    pthread_mutex_lock(&State.lastKeyMutex);
+    State.lastKey = key;
+    pthread_mutex_unlock(&State.lastKeyMutex);
+}
+
+static void RecordSoftKey(SoftKeyEvent key)
+{
+    InputRecord record = {
+        .kind = INPUT_RECORD_SOFT_KEY,
+        .count = 3,
+        .timestamp = key.timestamp
+    };
+
+    record.values[0] = (float)key.keyCode;
+    record.values[1] = (float)key.unicode;
+    record.values[2] = (float)key.label;
 
-        DetachCurrentThread();
+    RecordInput(&record);
+}
+
+static void PushSoftKey(SoftKeyEvent key)
+{
+    pthread_once(&State.queueOnce, InitSoftKeyQueue);
+
+    SetLastSoftKey(key);
+
+    if (PushRingBuffer(&State.queue, &key, 1) == 0) {
+        TraceLog(LOG_WARNING, "RAYMOB: Soft keyboard event queue is full, key dropped");
     }
 }
 
-void HideSoftKeyboard(void)
+static bool ReserveTextChunk(TextChunk *chunk, int length)
 {
-    jobject context = GetNativeLoaderInstance();
+    if (length <= chunk->capacity) return true;
 
-    if (context != NULL) {
-        JNIEnv* env = AttachCurrentThread();
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, context);
+    int capacity = (chunk->capacity > 0) ? chunk->capacity : 64;
+    while (capacity < length) capacity *= 2;
 
-        jfieldID softKeyboardField = (*env)->GetFieldID(env, nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
-        jobject softKeyboard = (*env)->GetObjectField(env, context, softKeyboardField);
+    char *data = RL_REALLOC(chunk->data, capacity + 1);
+    if (data == NULL) return false;
 
-        if (softKeyboard != NULL) {
-            jclass softKeyboardClass = (*env)->GetObjectClass(env, softKeyboard);
-            jmethodID method = (*env)->GetMethodID(env, softKeyboardClass, "hideKeyboard", "()V");
-            (*env)->CallVoidMethod(env, softKeyboard, method);
-        }
+    chunk->data = data;
+    chunk->capacity = capacity;
+
+    return true;
+}
 
-        DetachCurrentThread();
+// Copies a Java byte array at the end of a chunk, must be called with the text mutex locked
+static void AppendTextChunk(JNIEnv *env, TextChunk *chunk, jbyteArray bytes)
+{
+    int length = (*env)->GetArrayLength(env, bytes);
+    if (length == 0) return;
+
+    if (chunk->length + length > SOFT_TEXT_MAX_PENDING || !ReserveTextChunk(chunk, chunk->length + length)) {
+        TraceLog(LOG_WARNING, "RAYMOB: Soft keyboard text is not being read, %i bytes dropped", length);
+        return;
     }
+
+    (*env)->GetByteArrayRegion(env, bytes, 0, length, (jbyte *)chunk->data + chunk->length);
+    chunk->length += length;
+    chunk->data[chunk->length] = '\0';
 }
 
-int GetLastSoftKeyCode(void)
+static int64_t GetBootTime(void)
 {
-    jobject context = GetNativeLoaderInstance();
+    // NOTE: Same clock as the sensor event timestamps
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    return (int64_t)now.tv_sec*1000000000LL + now.tv_nsec;
+}
 
-    if (context != NULL) {
-        JNIEnv* env = AttachCurrentThread();
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, context);
+static int64_t UptimeToBootTime(int64_t uptimeMillis)
+{
+    // NOTE: SystemClock.uptimeMillis() is CLOCK_MONOTONIC, which stops during
+    //       deep sleep, the current offset between both clocks converts it
+    struct timespec monotonic;
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
 
-        jfieldID softKeyboardField = (*env)->GetFieldID(env, nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
-        jobject softKeyboard = (*env)->GetObjectField(env, context, softKeyboardField);
+    int64_t offset = GetBootTime() - ((int64_t)monotonic.tv_sec*1000000000LL + monotonic.tv_nsec);
+    return uptimeMillis*1000000LL + offset;
+}
 
-        if (softKeyboard != NULL) {
-            jclass softKeyboardClass = (*env)->GetObjectClass(env, softKeyboard);
-            jmethodID method = (*env)->GetMethodID(env, softKeyboardClass, "getLastKeyCode", "()I");
-            int value = (*env)->CallIntMethod(env, softKeyboard, method);
-            DetachCurrentThread();
-            return value;
-        }
+/* NATIVE METHODS */
+
+void JNICALL OnSoftKeyEvent(JNIEnv *env, jobject obj, jint keyCode, jint unicode, jchar label, jlong eventTime)
+{
+    if (IsInputReplayActive()) return;
 
-        DetachCurrentThread();
+    // NOTE: Converted to the boot time, so that key events and sensor events share the same clock
+    SoftKeyEvent key = { keyCode, unicode, label, UptimeToBootTime(eventTime) };
+
+    if (IsInputRecording()) RecordSoftKey(key);
+
+    PushSoftKey(key);
+}
+
+void JNICALL OnSoftTextInput(JNIEnv *env, jobject obj, jbyteArray committed, jbyteArray composing)
+{
+    if (IsInputReplayActive()) return;
+
+    pthread_mutex_lock(&State.textMutex);
+
+    if (committed != NULL) {
+        AppendTextChunk(env, &State.committed, committed);
     }
 
-    return 0;
+    if (composing != NULL) {
+        State.composing.length = 0;
+        AppendTextChunk(env, &State.composing, composing);
+        State.composingVersion++;
+    }
+
+    pthread_mutex_unlock(&State.textMutex);
 }
 
-unsigned short GetLastSoftKeyLabel(void)
+/* PUBLIC API */
+
+void ShowSoftKeyboard(void)
 {
-    jobject context = GetNativeLoaderInstance();
+    // NOTE: Also registers the native key event queue, if not done yet
+    const RaymobBridge *bridge = GetBridge();
 
-    if (context != NULL) {
-        JNIEnv* env = AttachCurrentThread();
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, context);
+    if (bridge != NULL && bridge->softKeyboard != NULL) {
+        JNIEnv* env = GetThreadJNIEnv();
+        (*env)->CallVoidMethod(env, bridge->softKeyboard, bridge->showKeyboard);
+    }
+}
 
-        jfieldID softKeyboardField = (*env)->GetFieldID(env, nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
-        jobject softKeyboard = (*env)->GetObjectField(env, context, softKeyboardField);
+void HideSoftKeyboard(void)
+{
+    const RaymobBridge *bridge = GetBridge();
 
-        if (softKeyboard != NULL) {
-            jclass softKeyboardClass = (*env)->GetObjectClass(env, softKeyboard);
-            jmethodID method = (*env)->GetMethodID(env, softKeyboardClass, "getLastKeyLabel", "()C");
-            unsigned short value = (*env)->CallCharMethod(env, softKeyboard, method);
-            DetachCurrentThread();
-            return value;
-        }
+    if (bridge != NULL && bridge->softKeyboard != NULL) {
+        JNIEnv* env = GetThreadJNIEnv();
+        (*env)->CallVoidMethod(env, bridge->softKeyboard, bridge->hideKeyboard);
     }
+}
+
+void SetSoftKeyboardTextInput(bool enabled)
+{
+    const RaymobBridge *bridge = GetBridge();
 
-    return 0;
+    if (bridge != NULL && bridge->softKeyboard != NULL) {
+        JNIEnv* env = GetThreadJNIEnv();
+        (*env)->CallVoidMethod(env, bridge->softKeyboard, bridge->setTextInput, (jboolean)enabled);
+    }
 }
 
-int GetLastSoftKeyUnicode(void)
+const char *GetSoftKeyboardCommittedText(void)
 {
-    jobject context = GetNativeLoaderInstance();
+    // NOTE: Swaps the chunks instead of copying, a large paste costs nothing more here
+    pthread_mutex_lock(&State.textMutex);
 
-    if (context != NULL) {
-        JNIEnv* env = AttachCurrentThread();
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, context);
+    TextChunk committed = State.committed;
+    State.committed = State.committedRead;
+    State.committed.length = 0;
+    State.committedRead = committed;
 
-        jfieldID softKeyboardField = (*env)->GetFieldID(env, nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
-        jobject softKeyboard = (*env)->GetObjectField(env, context, softKeyboardField);
+    pthread_mutex_unlock(&State.textMutex);
 
-        if (softKeyboard != NULL) {
-            jclass softKeyboardClass = (*env)->GetObjectClass(env, softKeyboard);
-            jmethodID method = (*env)->GetMethodID(env, softKeyboardClass, "getLastKeyUnicode", "()I");
-            int value = (*env)->CallIntMethod(env, softKeyboard, method);
-            DetachCurrentThread();
-            return value;
+    return (State.committedRead.length > 0) ? State.committedRead.data : "";
+}
+
+const char *GetSoftKeyboardComposingText(void)
+{
+    pthread_mutex_lock(&State.textMutex);
+
+    if (State.composingReadVersion != State.composingVersion) {
+        State.composingReadVersion = State.composingVersion;
+        State.composingRead.length = 0;
+
+        if (ReserveTextChunk(&State.composingRead, State.composing.length)) {
+            memcpy(State.composingRead.data, State.composing.data, State.composing.length);
+            State.composingRead.length = State.composing.length;
+            State.composingRead.data[State.composingRead.length] = '\0';
         }
     }
 
-    return 0;
+    pthread_mutex_unlock(&State.textMutex);
+
+    return (State.composingRead.length > 0) ? State.composingRead.data : "";
 }
 
-char GetLastSoftKeyChar(void)
+int PollSoftKeyEvents(SoftKeyEvent *events, int maxEvents)
 {
-#define KEYCODE_ENTER    66
-#define KEYCODE_DEL      67
+    if (events == NULL) return 0;
 
-    jobject context = GetNativeLoaderInstance();
-
-    if (context != NULL) {
-        char value = '\0';
-
-        JNIEnv* env = AttachCurrentThread();
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, context);
-
-        jfieldID softKeyboardField = (*env)->GetFieldID(env, nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
-        jobject softKeyboard = (*env)->GetObjectField(env, context, softKeyboardField);
-
-        if (softKeyboard != NULL) {
-            jclass softKeyboardClass = (*env)->GetObjectClass(env, softKeyboard);
-
-            jmethodID methodKeyCode = (*env)->GetMethodID(env, softKeyboardClass, "getLastKeyCode", "()I");
-            int keyCode = (*env)->CallIntMethod(env, softKeyboard, methodKeyCode);
-
-            if (keyCode != 0) {
-                switch (keyCode) {
-                    case KEYCODE_ENTER: {
-                        value = '\n';
-                    } break;
-                    case KEYCODE_DEL: {
-                        value = '\b';
-                    } break;
-                    default: {
-                        jmethodID methodKeyUnicode = (*env)->GetMethodID(env, softKeyboardClass, "getLastKeyUnicode", "()I");
-                        int u = (*env)->CallIntMethod(env, softKeyboard, methodKeyUnicode);
-                        if (u > 0xFF) value = '?';
-                        else value = (char) u;
-                    }
-                }
-            }
-        }
+    // NOTE: Java only pushes events once the natives are registered by the bridge
+    GetBridge();
 
-        DetachCurrentThread();
+    pthread_once(&State.queueOnce, InitSoftKeyQueue);
+    return PopRingBuffer(&State.queue, events, maxEvents);
+}
 
-        return value;
+int GetLastSoftKeyCode(void)
+{
+    return GetLastSoftKey().keyCode;
+}
+
+unsigned short GetLastSoftKeyLabel(void)
+{
+    return GetLastSoftKey().label;
+}
+
+int GetLastSoftKeyUnicode(void)
+{
+    return GetLastSoftKey().unicode;
+}
+
+char GetLastSoftKeyChar(void)
+{
+    SoftKeyEvent key = GetLastSoftKey();
+
+    switch (key.keyCode) {
+        case 0: return '\0';
+        case KEYCODE_ENTER: return '\n';
+        case KEYCODE_DEL: return '\b';
+        default: break;
     }
 
-    return '\0';
+    return (key.unicode > 0xFF) ? '?' : (char)key.unicode;
 }
 
 void ClearLastSoftKey(void)
 {
-    jobject context = GetNativeLoaderInstance();
+    SoftKeyEvent cleared = { 0 };
 
-    if (context != NULL) {
-        JNIEnv* env = AttachCurrentThread();
-        jclass nativeLoaderClass = (*env)->GetObjectClass(env, context);
-
-        jfieldID softKeyboardField = (*env)->GetFieldID(env, nativeLoaderClass, "softKeyboard", "Lcom/raylib/raymob/SoftKeyboard;");
-        jobject softKeyboard = (*env)->GetObjectField(env, context, softKeyboardField);
+    if (!IsInputReplayActive() && IsInputRecording()) {
+        cleared.timestamp = GetBootTime();
+        RecordSoftKey(cleared);
+        cleared.timestamp = 0;
+    }
 
-        if (softKeyboard != NULL) {
-            jclass softKeyboardClass = (*env)->GetObjectClass(env, softKeyboard);
-            jmethodID method = (*env)->GetMethodID(env, softKeyboardClass, "clearLastKeyEvent", "()V");
-            (*env)->CallVoidMethod(env, softKeyboard, method);
-        }
+    SetLastSoftKey(cleared);
+}
 
-        DetachCurrentThread();
+void ReplaySoftKey(int keyCode, int unicode, int label, int64_t timestamp)
+{
+    // NOTE: A recorded clear only resets the last key, it is not a key event
+    if (keyCode == 0) {
+        SetLastSoftKey((SoftKeyEvent){ 0 });
+        return;
     }
+
+    PushSoftKey((SoftKeyEvent){ keyCode, unicode, (unsigned short)label, timestamp });
 }
 
 void SoftKeyboardEditText(char* text, unsigned int size)
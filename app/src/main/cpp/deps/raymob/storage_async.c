@@ -0,0 +1,336 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "raymob.h"
+
+#include <pthread.h>
+#include <string.h>
+
+/* DEFINES */
+
+#define MAX_STORAGE_REQUESTS    64      // Maximum number of requests in flight
+#define STORAGE_WORKER_COUNT    2       // Number of I/O threads
+
+/* TYPES */
+
+typedef enum {
+    STORAGE_TASK_READ,
+    STORAGE_TASK_WRITE,
+} StorageTaskType;
+
+typedef struct {
+
+    StorageRequest handle;      // 0 when the slot is free
+    StorageTaskType type;
+    StoragePriority priority;
+    unsigned int sequence;      // Keeps FIFO order between requests of the same priority
+
+    StorageRequestStatus status;
+    bool cancelRequested;
+
+    char *filepath;
+    void *data;
+    int dataSize;
+
+    StorageCallback callback;
+    void *userData;
+
+} StorageTask;
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t workers[STORAGE_WORKER_COUNT];
+
+    StorageTask tasks[MAX_STORAGE_REQUESTS];
+    unsigned int generation;
+    unsigned int sequence;
+
+} State = { .mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+static pthread_once_t workersOnce = PTHREAD_ONCE_INIT;
+
+/* INTERNAL FUNCTIONS */
+
+static StorageTask *GetTask(StorageRequest request)
+{
+    if (request == 0) return NULL;
+
+    StorageTask *task = &State.tasks[request%MAX_STORAGE_REQUESTS];
+    return (task->handle == request) ? task : NULL;
+}
+
+static bool IsTaskBlocked(const StorageTask *task)
+{
+    // NOTE: Requests on the same file run one at a time and in submission order,
+    //       whatever their priority, the priority only orders different files
+    for (int i = 0; i < MAX_STORAGE_REQUESTS; i++) {
+        const StorageTask *other = &State.tasks[i];
+        if (other == task || other->handle == 0) continue;
+
+        bool running = (other->status == STORAGE_REQUEST_RUNNING);
+        bool earlier = (other->status == STORAGE_REQUEST_PENDING) && (int)(other->sequence - task->sequence) < 0;
+
+        if ((running || earlier) && strcmp(other->filepath, task->filepath) == 0) return true;
+    }
+
+    return false;
+}
+
+static StorageTask *PopNextTask(void)
+{
+    StorageTask *next = NULL;
+
+    for (int i = 0; i < MAX_STORAGE_REQUESTS; i++) {
+        StorageTask *task = &State.tasks[i];
+        if (task->handle == 0 || task->status != STORAGE_REQUEST_PENDING) continue;
+        if (IsTaskBlocked(task)) continue;
+        if (next == NULL || task->priority > next->priority ||
+            (task->priority == next->priority && (int)(task->sequence - next->sequence) < 0)) {
+            next = task;
+        }
+    }
+
+    if (next != NULL) next->status = STORAGE_REQUEST_RUNNING;
+
+    return next;
+}
+
+static void *StorageWorker(void *arg)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    for (;;) {
+        StorageTask *task = NULL;
+        while ((task = PopNextTask()) == NULL) {
+            pthread_cond_wait(&State.cond, &State.mutex);
+        }
+
+        // NOTE: The slot cannot be reused while RUNNING, we can work on it unlocked
+        pthread_mutex_unlock(&State.mutex);
+
+        bool success = false;
+
+        if (task->type == STORAGE_TASK_READ) {
+            task->data = ReadFromAppStorage(task->filepath, &task->dataSize);
+            success = (task->data != NULL);
+        } else {
+            // NOTE: Replaced atomically, a reader never sees a partially written file
+            success = WriteToAppStorageAtomic(task->filepath, task->data, (unsigned int)task->dataSize);
+        }
+
+        pthread_mutex_lock(&State.mutex);
+
+        if (task->cancelRequested) task->status = STORAGE_REQUEST_CANCELLED;
+        else task->status = success ? STORAGE_REQUEST_DONE : STORAGE_REQUEST_FAILED;
+
+        // The next request on the same file may be waiting for this one
+        pthread_cond_broadcast(&State.cond);
+    }
+
+    return NULL;
+}
+
+static void StartStorageWorkers(void)
+{
+    for (int i = 0; i < STORAGE_WORKER_COUNT; i++) {
+        if (pthread_create(&State.workers[i], NULL, StorageWorker, NULL) != 0) {
+            TraceLog(LOG_ERROR, "FILEIO: Failed to create storage worker thread");
+            continue;
+        }
+        pthread_setname_np(State.workers[i], "raymob-io");
+        pthread_detach(State.workers[i]);
+    }
+}
+
+static StorageRequest PushTask(StorageTaskType type, const char *filepath, void *data, int dataSize,
+                               StoragePriority priority, StorageCallback callback, void *userData)
+{
+    pthread_once(&workersOnce, StartStorageWorkers);
+
+    char *path = strdup(filepath);
+
+    if (path == NULL) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocate storage request", filepath);
+        return 0;
+    }
+
+    pthread_mutex_lock(&State.mutex);
+
+    StorageTask *task = NULL;
+
+    for (int i = 0; i < MAX_STORAGE_REQUESTS; i++) {
+        if (State.tasks[i].handle == 0) {
+            task = &State.tasks[i];
+            break;
+        }
+    }
+
+    if (task == NULL) {
+        pthread_mutex_unlock(&State.mutex);
+        free(path);
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Too many storage requests in flight", filepath);
+        return 0;
+    }
+
+    // NOTE: The handle encodes the slot index and a generation, so that
+    //       stale handles of recycled slots are never mistaken for new ones
+    int index = (int)(task - State.tasks);
+    if (++State.generation > UINT32_MAX/MAX_STORAGE_REQUESTS) State.generation = 1;
+
+    task->handle = State.generation*MAX_STORAGE_REQUESTS + index;
+    task->type = type;
+    task->priority = priority;
+    task->sequence = State.sequence++;
+    task->status = STORAGE_REQUEST_PENDING;
+    task->cancelRequested = false;
+    task->filepath = path;
+    task->data = data;
+    task->dataSize = dataSize;
+    task->callback = callback;
+    task->userData = userData;
+
+    StorageRequest handle = task->handle;
+
+    pthread_cond_signal(&State.cond);
+    pthread_mutex_unlock(&State.mutex);
+
+    return handle;
+}
+
+/* PUBLIC API */
+
+StorageRequest ReadFromAppStorageAsync(const char *filepath, StoragePriority priority, StorageCallback callback, void *userData)
+{
+    return PushTask(STORAGE_TASK_READ, filepath, NULL, 0, priority, callback, userData);
+}
+
+StorageRequest WriteToAppStorageAsync(const char *filepath, const void *data, unsigned int dataSize,
+                                      StoragePriority priority, StorageCallback callback, void *userData)
+{
+    // NOTE: The data is copied so the caller can release or reuse its buffer right away
+    void *copy = RL_MALLOC(dataSize);
+
+    if (copy == NULL) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocated memory for file writing", filepath);
+        return 0;
+    }
+
+    memcpy(copy, data, dataSize);
+
+    StorageRequest request = PushTask(STORAGE_TASK_WRITE, filepath, copy, (int)dataSize, priority, callback, userData);
+    if (request == 0) RL_FREE(copy);
+
+    return request;
+}
+
+bool CancelStorageRequest(StorageRequest request)
+{
+    bool cancelled = false;
+
+    pthread_mutex_lock(&State.mutex);
+
+    StorageTask *task = GetTask(request);
+
+    if (task != NULL) {
+        if (task->status == STORAGE_REQUEST_PENDING) {
+            task->status = STORAGE_REQUEST_CANCELLED;
+            cancelled = true;
+        } else if (task->status == STORAGE_REQUEST_RUNNING) {
+            // NOTE: The I/O cannot be interrupted, but its result will be discarded
+            task->cancelRequested = true;
+            cancelled = true;
+        }
+    }
+
+    pthread_mutex_unlock(&State.mutex);
+
+    return cancelled;
+}
+
+StorageRequestStatus GetStorageRequestStatus(StorageRequest request)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    StorageTask *task = GetTask(request);
+    StorageRequestStatus status = (task != NULL) ? task->status : STORAGE_REQUEST_INVALID;
+
+    pthread_mutex_unlock(&State.mutex);
+
+    return status;
+}
+
+int PollStorageRequests(void)
+{
+    StorageTask completed[MAX_STORAGE_REQUESTS];
+    int count = 0;
+
+    pthread_mutex_lock(&State.mutex);
+
+    for (int i = 0; i < MAX_STORAGE_REQUESTS; i++) {
+        StorageTask *task = &State.tasks[i];
+        if (task->handle == 0) continue;
+        if (task->status == STORAGE_REQUEST_DONE || task->status == STORAGE_REQUEST_FAILED ||
+            task->status == STORAGE_REQUEST_CANCELLED) {
+            completed[count++] = *task;
+            task->handle = 0;   // Release the slot
+        }
+    }
+
+    pthread_mutex_unlock(&State.mutex);
+
+    // Completed requests are reported in submission order
+    for (int i = 1; i < count; i++) {
+        StorageTask task = completed[i];
+        int j = i - 1;
+        for (; j >= 0 && (int)(completed[j].sequence - task.sequence) > 0; j--) completed[j + 1] = completed[j];
+        completed[j + 1] = task;
+    }
+
+    // NOTE: Callbacks are called outside of the lock so they can issue new requests
+
+    for (int i = 0; i < count; i++) {
+        StorageTask *task = &completed[i];
+
+        void *data = NULL;
+        int dataSize = 0;
+
+        if (task->type == STORAGE_TASK_READ && task->status == STORAGE_REQUEST_DONE) {
+            data = task->data;
+            dataSize = task->dataSize;
+        } else {
+            RL_FREE(task->data);    // Written copy or discarded result
+        }
+
+        if (task->callback != NULL) task->callback(task->handle, task->status, data, dataSize, task->userData);
+        else RL_FREE(data);
+
+        free(task->filepath);
+    }
+
+    return count;
+}
@@ -0,0 +1,306 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "raymob.h"
+#include "bridge.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+/* TYPES */
+
+typedef struct {
+    char *filepath;
+    void *data;
+    unsigned int dataSize;
+} JournalEntry;
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    pthread_mutex_t mutex;          // Protects the entries, the timer settings and the flush counters
+    pthread_mutex_t flushMutex;     // Serializes flushes, so an older batch never lands after a newer one
+    pthread_cond_t cond;            // Wakes the journal thread
+    pthread_cond_t flushedCond;     // Signaled by the journal thread after each requested flush
+
+    JournalEntry *entries;
+    int count;
+    int capacity;
+
+    float flushInterval;            // In seconds, 0 disables the timer
+    bool threadStarted;
+    pthread_t thread;
+
+    unsigned int flushRequested;    // Flushes requested from FlushStorageJournalTimeout()
+    unsigned int flushCompleted;    // Last request served by the journal thread
+    bool flushSucceeded;            // Result of the last served request
+
+} State = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .flushMutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .flushedCond = PTHREAD_COND_INITIALIZER
+};
+
+/* INTERNAL FUNCTIONS */
+
+static void FreeJournalEntry(JournalEntry *entry)
+{
+    RL_FREE(entry->filepath);
+    RL_FREE(entry->data);
+}
+
+static JournalEntry *FindJournalEntry(const char *filepath)
+{
+    for (int i = 0; i < State.count; i++) {
+        if (strcmp(State.entries[i].filepath, filepath) == 0) return &State.entries[i];
+    }
+
+    return NULL;
+}
+
+static bool AppendJournalEntry(JournalEntry entry)
+{
+    // NOTE: Called with the mutex held
+    if (State.count == State.capacity) {
+        int capacity = (State.capacity > 0) ? 2*State.capacity : 8;
+        JournalEntry *entries = RL_REALLOC(State.entries, capacity*sizeof(JournalEntry));
+        if (entries == NULL) return false;
+
+        State.entries = entries;
+        State.capacity = capacity;
+    }
+
+    State.entries[State.count++] = entry;
+
+    return true;
+}
+
+static void RequeueJournalEntry(JournalEntry entry)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    // A newer write of the same file was journaled during the flush, it wins
+    bool requeued = (FindJournalEntry(entry.filepath) == NULL) && AppendJournalEntry(entry);
+
+    pthread_mutex_unlock(&State.mutex);
+
+    if (!requeued) FreeJournalEntry(&entry);
+}
+
+static void *JournalThread(void *arg)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    for (;;) {
+        bool timedOut = false;
+
+        if (State.flushRequested == State.flushCompleted) {
+            if (State.flushInterval <= 0.0f) {
+                pthread_cond_wait(&State.cond, &State.mutex);
+                continue;
+            }
+
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+
+            long long ns = deadline.tv_nsec + (long long)(State.flushInterval*1e9f);
+            deadline.tv_sec += (time_t)(ns/1000000000LL);
+            deadline.tv_nsec = (long)(ns%1000000000LL);
+
+            // NOTE: Changing the interval or requesting a flush wakes us up early
+            timedOut = (pthread_cond_timedwait(&State.cond, &State.mutex, &deadline) != 0);
+        }
+
+        unsigned int requested = State.flushRequested;
+        if (!timedOut && requested == State.flushCompleted) continue;
+
+        pthread_mutex_unlock(&State.mutex);
+        bool success = FlushStorageJournal();
+        pthread_mutex_lock(&State.mutex);
+
+        if (requested != State.flushCompleted) {
+            State.flushCompleted = requested;
+            State.flushSucceeded = success;
+            pthread_cond_broadcast(&State.flushedCond);
+        }
+    }
+
+    return NULL;
+}
+
+static bool StartJournalThread(void)
+{
+    // NOTE: Called with the mutex held
+    if (State.threadStarted) return true;
+
+    if (pthread_create(&State.thread, NULL, JournalThread, NULL) != 0) {
+        TraceLog(LOG_ERROR, "FILEIO: Failed to create storage journal thread");
+        return false;
+    }
+
+    pthread_setname_np(State.thread, "raymob-journal");
+    pthread_detach(State.thread);
+    State.threadStarted = true;
+
+    return true;
+}
+
+/* PUBLIC API */
+
+bool WriteToAppStorageJournaled(const char *filepath, const void *data, unsigned int dataSize)
+{
+    void *copy = RL_MALLOC(dataSize);
+
+    if (copy == NULL) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocated memory for file writing", filepath);
+        return false;
+    }
+
+    memcpy(copy, data, dataSize);
+
+    // NOTE: The journal is flushed when the game thread handles APP_CMD_PAUSE, installed on
+    //       every write since raylib replaces the handler when its window is created
+    HookAppCommands();
+
+    pthread_mutex_lock(&State.mutex);
+
+    // Coalesce with a pending write of the same file, only the latest content matters
+
+    JournalEntry *pending = FindJournalEntry(filepath);
+
+    if (pending != NULL) {
+        RL_FREE(pending->data);
+        pending->data = copy;
+        pending->dataSize = dataSize;
+        pthread_mutex_unlock(&State.mutex);
+        return true;
+    }
+
+    size_t length = strlen(filepath);
+    JournalEntry entry = { RL_MALLOC(length + 1), copy, dataSize };
+    if (entry.filepath != NULL) memcpy(entry.filepath, filepath, length + 1);
+
+    bool success = (entry.filepath != NULL) && AppendJournalEntry(entry);
+
+    pthread_mutex_unlock(&State.mutex);
+
+    if (!success) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to allocated memory for file writing", filepath);
+        FreeJournalEntry(&entry);
+    }
+
+    return success;
+}
+
+bool FlushStorageJournal(void)
+{
+    pthread_mutex_lock(&State.flushMutex);
+
+    // Take the whole batch, new writes can be journaled while this one is flushed
+
+    pthread_mutex_lock(&State.mutex);
+
+    JournalEntry *entries = State.entries;
+    int count = State.count;
+
+    State.entries = NULL;
+    State.count = 0;
+    State.capacity = 0;
+
+    pthread_mutex_unlock(&State.mutex);
+
+    bool success = true;
+
+    for (int i = 0; i < count; i++) {
+        if (WriteToAppStorageAtomic(entries[i].filepath, entries[i].data, entries[i].dataSize)) {
+            FreeJournalEntry(&entries[i]);
+        }
+        else {
+            // NOTE: Kept for the next flush, the data is still dirty
+            RequeueJournalEntry(entries[i]);
+            success = false;
+        }
+    }
+
+    RL_FREE(entries);
+
+    pthread_mutex_unlock(&State.flushMutex);
+
+    return success;
+}
+
+bool FlushStorageJournalTimeout(float timeout)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+
+    long long ns = deadline.tv_nsec + (long long)(timeout*1e9f);
+    deadline.tv_sec += (time_t)(ns/1000000000LL);
+    deadline.tv_nsec = (long)(ns%1000000000LL);
+
+    pthread_mutex_lock(&State.mutex);
+
+    // NOTE: With the thread running, an empty journal may still have a batch being
+    //       written, the request then completes once that batch is on disk
+    if (State.count == 0 && !State.threadStarted) {
+        pthread_mutex_unlock(&State.mutex);
+        return true;
+    }
+
+    if (!StartJournalThread()) {
+        pthread_mutex_unlock(&State.mutex);
+        return false;
+    }
+
+    unsigned int request = ++State.flushRequested;
+    pthread_cond_signal(&State.cond);
+
+    bool timedOut = false;
+
+    while ((int)(State.flushCompleted - request) < 0 && !timedOut) {
+        timedOut = (pthread_cond_timedwait(&State.flushedCond, &State.mutex, &deadline) != 0);
+    }
+
+    bool success = !timedOut && State.flushSucceeded;
+
+    pthread_mutex_unlock(&State.mutex);
+
+    if (timedOut) TraceLog(LOG_WARNING, "FILEIO: Storage journal flush still running after %.2fs", timeout);
+
+    return success;
+}
+
+void SetStorageJournalFlushInterval(float seconds)
+{
+    pthread_mutex_lock(&State.mutex);
+
+    State.flushInterval = seconds;
+    if (seconds > 0.0f) StartJournalThread();
+
+    pthread_cond_signal(&State.cond);
+    pthread_mutex_unlock(&State.mutex);
+}
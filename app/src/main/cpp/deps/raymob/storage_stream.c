@@ -0,0 +1,149 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// NOTE: Required by glibc for the 64bit file API, bionic always exposes it
+#define _LARGEFILE64_SOURCE
+
+#include "raymob.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* TYPES */
+
+struct StorageStream {
+    int fd;
+    StreamMode mode;
+};
+
+/* PUBLIC API */
+
+StorageStream *OpenAppStorageStream(const char *filepath, StreamMode mode)
+{
+    char path[PATH_MAX];
+    if (JoinAppStoragePath(path, sizeof(path), filepath) < 0) return NULL;
+
+    // NOTE: O_LARGEFILE lets 32bit processes go past 2GB, offsets are always 64bit here
+    int flags = O_CLOEXEC | O_LARGEFILE;
+
+    switch (mode) {
+        case STREAM_READ: flags |= O_RDONLY; break;
+        case STREAM_WRITE: flags |= O_WRONLY | O_CREAT | O_TRUNC; break;
+        case STREAM_APPEND: flags |= O_WRONLY | O_CREAT | O_APPEND; break;
+        default: return NULL;
+    }
+
+    int fd = open(path, flags, 0644);
+
+    if (fd < 0) {
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to open file", path);
+        return NULL;
+    }
+
+    // Chunked reads are usually linear, let the kernel read ahead more aggressively
+    if (mode == STREAM_READ) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    StorageStream *stream = RL_MALLOC(sizeof(StorageStream));
+
+    if (stream == NULL) {
+        close(fd);
+        return NULL;
+    }
+
+    stream->fd = fd;
+    stream->mode = mode;
+
+    return stream;
+}
+
+bool CloseStorageStream(StorageStream *stream)
+{
+    if (stream == NULL) return false;
+
+    bool success = (close(stream->fd) == 0);
+    RL_FREE(stream);
+
+    return success;
+}
+
+int64_t ReadStorageChunk(StorageStream *stream, void *buffer, size_t size)
+{
+    if (stream == NULL || stream->mode != STREAM_READ) return -1;
+
+    unsigned char *bytes = buffer;
+    size_t total = 0;
+
+    // NOTE: read() may return less than requested, loop until the chunk is full or EOF
+    while (total < size) {
+        ssize_t count = read(stream->fd, bytes + total, size - total);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) return -1;
+        if (count == 0) break;
+        total += (size_t)count;
+    }
+
+    return (int64_t)total;
+}
+
+int64_t WriteStorageChunk(StorageStream *stream, const void *buffer, size_t size)
+{
+    if (stream == NULL || stream->mode == STREAM_READ) return -1;
+
+    const unsigned char *bytes = buffer;
+    size_t total = 0;
+
+    while (total < size) {
+        ssize_t count = write(stream->fd, bytes + total, size - total);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return -1;
+        total += (size_t)count;
+    }
+
+    return (int64_t)total;
+}
+
+bool SeekStorageStream(StorageStream *stream, int64_t offset, int origin)
+{
+    if (stream == NULL) return false;
+    return lseek64(stream->fd, (off64_t)offset, origin) >= 0;
+}
+
+int64_t TellStorageStream(StorageStream *stream)
+{
+    if (stream == NULL) return -1;
+    return (int64_t)lseek64(stream->fd, 0, SEEK_CUR);
+}
+
+int64_t GetStorageStreamSize(StorageStream *stream)
+{
+    if (stream == NULL) return -1;
+
+    struct stat64 st;
+    if (fstat64(stream->fd, &st) != 0) return -1;
+
+    return (int64_t)st.st_size;
+}
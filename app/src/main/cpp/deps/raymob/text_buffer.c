@@ -0,0 +1,408 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Gap buffer text model for soft keyboard text entry.
+ *
+ * The text is stored as UTF-8 with a gap, which is moved to the cursor on
+ * the first edit after the cursor moved, so that consecutive edits at the
+ * cursor only touch the gap. Reading the whole text moves the gap behind it.
+ * Offsets in the API are byte offsets in the text, excluding the gap, and
+ * always lie on code point boundaries.
+ *
+ * NOTE: Portable C without any Android dependency, it also builds on a host.
+ */
+
+#include "raymob.h"
+
+#include <string.h>
+
+/* DEFINES */
+
+#define TEXT_BUFFER_MIN_CAPACITY    64
+
+#define KEYCODE_DPAD_LEFT       21
+#define KEYCODE_DPAD_RIGHT      22
+#define KEYCODE_ENTER           66
+#define KEYCODE_DEL             67
+#define KEYCODE_FORWARD_DEL     112
+#define KEYCODE_MOVE_HOME       122
+#define KEYCODE_MOVE_END        123
+
+#define IS_UTF8_CONTINUATION(c) (((unsigned char)(c) & 0xC0) == 0x80)
+
+/* TYPES */
+
+struct TextBuffer {
+    char *data;
+    size_t capacity;        // Size of 'data', text and gap included
+    size_t gapStart;
+    size_t gapEnd;          // The gap is never empty, it holds the terminator for GetTextBufferText()
+    size_t cursor;
+    size_t anchor;          // Other end of the selection, equal to the cursor if none
+};
+
+/* INTERNAL FUNCTIONS */
+
+static size_t GetGapSize(const TextBuffer *buffer)
+{
+    return buffer->gapEnd - buffer->gapStart;
+}
+
+static char GetTextByte(const TextBuffer *buffer, size_t offset)
+{
+    return (offset < buffer->gapStart) ? buffer->data[offset] : buffer->data[offset + GetGapSize(buffer)];
+}
+
+static void MoveGap(TextBuffer *buffer, size_t offset)
+{
+    if (offset < buffer->gapStart) {
+        size_t count = buffer->gapStart - offset;
+        memmove(buffer->data + buffer->gapEnd - count, buffer->data + offset, count);
+        buffer->gapStart -= count;
+        buffer->gapEnd -= count;
+    } else if (offset > buffer->gapStart) {
+        size_t count = offset - buffer->gapStart;
+        memmove(buffer->data + buffer->gapStart, buffer->data + buffer->gapEnd, count);
+        buffer->gapStart += count;
+        buffer->gapEnd += count;
+    }
+}
+
+static bool ReserveGap(TextBuffer *buffer, size_t size)
+{
+    size++;     // Room for the terminator
+    if (GetGapSize(buffer) >= size) return true;
+
+    // NOTE: The capacity grows geometrically, so that inserts stay O(1) amortized
+    size_t length = buffer->capacity - GetGapSize(buffer);
+    size_t capacity = (buffer->capacity > TEXT_BUFFER_MIN_CAPACITY) ? buffer->capacity : TEXT_BUFFER_MIN_CAPACITY;
+    while (capacity < length + size) capacity *= 2;
+
+    char *data = RL_REALLOC(buffer->data, capacity);
+    if (data == NULL) return false;
+
+    // Move the text after the gap to the end of the new storage
+    size_t tail = buffer->capacity - buffer->gapEnd;
+    memmove(data + capacity - tail, data + buffer->gapEnd, tail);
+
+    buffer->data = data;
+    buffer->gapEnd = capacity - tail;
+    buffer->capacity = capacity;
+
+    return true;
+}
+
+static size_t GetPrevCodepointOffset(const TextBuffer *buffer, size_t offset)
+{
+    if (offset == 0) return 0;
+    do offset--; while (offset > 0 && IS_UTF8_CONTINUATION(GetTextByte(buffer, offset)));
+    return offset;
+}
+
+static size_t GetNextCodepointOffset(const TextBuffer *buffer, size_t offset)
+{
+    size_t length = GetTextBufferLength(buffer);
+    if (offset >= length) return length;
+    do offset++; while (offset < length && IS_UTF8_CONTINUATION(GetTextByte(buffer, offset)));
+    return offset;
+}
+
+static bool DeleteSelection(TextBuffer *buffer)
+{
+    size_t start, end;
+    if (!GetTextBufferSelection(buffer, &start, &end)) return false;
+
+    MoveGap(buffer, start);
+    buffer->gapEnd += end - start;
+    buffer->cursor = buffer->anchor = start;
+
+    return true;
+}
+
+static int EncodeUTF8(int codepoint, char *utf8)
+{
+    if (codepoint < 0) return 0;
+
+    if (codepoint < 0x80) {
+        utf8[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        utf8[0] = (char)(0xC0 | (codepoint >> 6));
+        utf8[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        if (codepoint >= 0xD800 && codepoint <= 0xDFFF) return 0;   // Surrogate halves are not characters
+        utf8[0] = (char)(0xE0 | (codepoint >> 12));
+        utf8[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    if (codepoint <= 0x10FFFF) {
+        utf8[0] = (char)(0xF0 | (codepoint >> 18));
+        utf8[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (codepoint & 0x3F));
+        return 4;
+    }
+
+    return 0;
+}
+
+static bool InsertText(TextBuffer *buffer, const char *text, size_t size)
+{
+    bool deleted = DeleteSelection(buffer);
+
+    if (size == 0) return deleted;
+    if (!ReserveGap(buffer, size)) return deleted;
+
+    MoveGap(buffer, buffer->cursor);
+    memcpy(buffer->data + buffer->gapStart, text, size);
+    buffer->gapStart += size;
+    buffer->cursor = buffer->anchor = buffer->gapStart;
+
+    return true;
+}
+
+// Applies input method text, where '\b' and DEL stand for backward and forward deletions
+static bool DeleteUTF16Units(TextBuffer *buffer, size_t units, bool backward)
+{
+    bool changed = false;
+
+    // NOTE: The input method counts UTF-16 units, a character outside of the BMP
+    //       (4 bytes in UTF-8, e.g. an emoji) is a surrogate pair, so two units
+    while (units > 0) {
+        size_t start, end;
+        size_t size = 0;
+
+        if (!GetTextBufferSelection(buffer, &start, &end)) {
+            size = backward ? buffer->cursor - GetPrevCodepointOffset(buffer, buffer->cursor)
+                            : GetNextCodepointOffset(buffer, buffer->cursor) - buffer->cursor;
+        }
+
+        if (!(backward ? DeleteTextBufferBackward(buffer) : DeleteTextBufferForward(buffer))) break;
+
+        changed = true;
+        units -= (size == 4 && units > 1) ? 2 : 1;
+    }
+
+    return changed;
+}
+
+static bool ApplyCommittedText(TextBuffer *buffer, const char *text)
+{
+    bool changed = false;
+
+    while (*text != '\0') {
+        size_t run = strcspn(text, "\b\x7f");
+
+        if (run > 0) {
+            changed |= InsertText(buffer, text, run);
+            text += run;
+        } else {
+            // A run of deletions is one deleteSurroundingText() call, in UTF-16 units
+            char control = *text;
+            size_t units = strspn(text, (control == '\b') ? "\b" : "\x7f");
+
+            changed |= DeleteUTF16Units(buffer, units, control == '\b');
+            text += units;
+        }
+    }
+
+    return changed;
+}
+
+/* PUBLIC API */
+
+TextBuffer *LoadTextBuffer(const char *text)
+{
+    TextBuffer *buffer = RL_CALLOC(1, sizeof(TextBuffer));
+    if (buffer == NULL) return NULL;
+
+    size_t length = (text != NULL) ? strlen(text) : 0;
+
+    if (!ReserveGap(buffer, length)) {
+        RL_FREE(buffer);
+        return NULL;
+    }
+
+    if (length > 0) {
+        memcpy(buffer->data, text, length);
+        buffer->gapStart = buffer->cursor = buffer->anchor = length;
+    }
+
+    return buffer;
+}
+
+void UnloadTextBuffer(TextBuffer *buffer)
+{
+    if (buffer == NULL) return;
+
+    RL_FREE(buffer->data);
+    RL_FREE(buffer);
+}
+
+bool InsertTextBufferString(TextBuffer *buffer, const char *text)
+{
+    if (buffer == NULL || text == NULL) return false;
+    return InsertText(buffer, text, strlen(text));
+}
+
+bool InsertTextBufferCodepoint(TextBuffer *buffer, int codepoint)
+{
+    char utf8[5] = { 0 };
+    if (EncodeUTF8(codepoint, utf8) == 0) return false;
+
+    return InsertTextBufferString(buffer, utf8);
+}
+
+bool DeleteTextBufferBackward(TextBuffer *buffer)
+{
+    if (buffer == NULL) return false;
+    if (DeleteSelection(buffer)) return true;
+    if (buffer->cursor == 0) return false;
+
+    MoveGap(buffer, buffer->cursor);
+    buffer->gapStart = GetPrevCodepointOffset(buffer, buffer->gapStart);
+    buffer->cursor = buffer->anchor = buffer->gapStart;
+
+    return true;
+}
+
+bool DeleteTextBufferForward(TextBuffer *buffer)
+{
+    if (buffer == NULL) return false;
+    if (DeleteSelection(buffer)) return true;
+    if (buffer->cursor == GetTextBufferLength(buffer)) return false;
+
+    MoveGap(buffer, buffer->cursor);
+    do buffer->gapEnd++; while (buffer->gapEnd < buffer->capacity && IS_UTF8_CONTINUATION(buffer->data[buffer->gapEnd]));
+
+    return true;
+}
+
+void MoveTextBufferCursor(TextBuffer *buffer, int codepoints, bool select)
+{
+    if (buffer == NULL) return;
+
+    size_t offset = buffer->cursor;
+
+    for (; codepoints < 0 && offset > 0; codepoints++) offset = GetPrevCodepointOffset(buffer, offset);
+    for (; codepoints > 0 && offset < GetTextBufferLength(buffer); codepoints--) offset = GetNextCodepointOffset(buffer, offset);
+
+    buffer->cursor = offset;
+    if (!select) buffer->anchor = offset;
+}
+
+void SetTextBufferCursor(TextBuffer *buffer, size_t offset, bool select)
+{
+    if (buffer == NULL) return;
+
+    size_t length = GetTextBufferLength(buffer);
+    if (offset > length) offset = length;
+
+    // Snap to the start of the code point containing the offset
+    while (offset > 0 && offset < length && IS_UTF8_CONTINUATION(GetTextByte(buffer, offset))) offset--;
+
+    buffer->cursor = offset;
+    if (!select) buffer->anchor = offset;
+}
+
+void SelectTextBufferRange(TextBuffer *buffer, size_t start, size_t end)
+{
+    if (buffer == NULL) return;
+
+    SetTextBufferCursor(buffer, start, false);
+    SetTextBufferCursor(buffer, end, true);
+}
+
+size_t GetTextBufferCursor(const TextBuffer *buffer)
+{
+    return (buffer != NULL) ? buffer->cursor : 0;
+}
+
+bool GetTextBufferSelection(const TextBuffer *buffer, size_t *start, size_t *end)
+{
+    if (buffer == NULL) return false;
+
+    size_t a = buffer->anchor, b = buffer->cursor;
+    if (start != NULL) *start = (a < b) ? a : b;
+    if (end != NULL) *end = (a < b) ? b : a;
+
+    return a != b;
+}
+
+size_t GetTextBufferLength(const TextBuffer *buffer)
+{
+    return (buffer != NULL) ? buffer->capacity - GetGapSize(buffer) : 0;
+}
+
+const char *GetTextBufferText(TextBuffer *buffer)
+{
+    if (buffer == NULL) return NULL;
+
+    // NOTE: Free when the text did not change since the last call, the gap is already at the end
+    size_t length = GetTextBufferLength(buffer);
+
+    MoveGap(buffer, length);
+    buffer->data[length] = '\0';
+
+    return buffer->data;
+}
+
+bool SoftKeyboardEditTextBuffer(TextBuffer *buffer)
+{
+    if (buffer == NULL) return false;
+
+    SoftKeyEvent events[16];
+    bool changed = false;
+    int count = 0;
+
+    while ((count = PollSoftKeyEvents(events, 16)) > 0) {
+        for (int i = 0; i < count; i++) {
+            switch (events[i].keyCode) {
+                case KEYCODE_DEL: changed |= DeleteTextBufferBackward(buffer); break;
+                case KEYCODE_FORWARD_DEL: changed |= DeleteTextBufferForward(buffer); break;
+                case KEYCODE_ENTER: changed |= InsertTextBufferCodepoint(buffer, '\n'); break;
+                case KEYCODE_DPAD_LEFT: MoveTextBufferCursor(buffer, -1, false); break;
+                case KEYCODE_DPAD_RIGHT: MoveTextBufferCursor(buffer, 1, false); break;
+                case KEYCODE_MOVE_HOME: SetTextBufferCursor(buffer, 0, false); break;
+                case KEYCODE_MOVE_END: SetTextBufferCursor(buffer, GetTextBufferLength(buffer), false); break;
+                default:
+                    // Control characters other than tabulation are not text
+                    if (events[i].unicode >= 0x20 || events[i].unicode == '\t') {
+                        changed |= InsertTextBufferCodepoint(buffer, events[i].unicode);
+                    }
+                    break;
+            }
+        }
+    }
+
+    changed |= ApplyCommittedText(buffer, GetSoftKeyboardCommittedText());
+
+    return changed;
+}
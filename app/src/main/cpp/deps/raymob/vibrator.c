@@ -22,37 +22,180 @@
  *  SOFTWARE.
  */
 
+
 #include "raymob.h"
+#include "bridge.h"
+#include "haptics.h"
 
-void Vibrate(float seconds)
+#include <pthread.h>
+
+/* DEFINES */
+
+#define MAX_HAPTIC_PATTERNS     64
+
+/* TYPES */
+
+typedef struct {
+    HapticPattern handle;       // 0 when the slot is free
+    jobject effect;             // Global reference to the VibrationEffect, NULL below API 26
+    jlongArray timings;         // Global reference, used instead of 'effect' below API 26
+} HapticPatternSlot;
+
+/* GLOBAL VARIABLES */
+
+static struct {
+    pthread_mutex_t mutex;
+    HapticPatternSlot slots[MAX_HAPTIC_PATTERNS];
+    unsigned int generation;
+} Patterns = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+// NOTE: Only used by the haptics worker thread
+static struct {
+    jobject vibrator;       // Global reference, NULL until the first command
+    bool hasVibrator;
+    bool initialized;
+} Worker = { 0 };
+
+/* INTERNAL FUNCTIONS */
+
+static bool InitVibrator(JNIEnv *env, const RaymobBridge *bridge)
 {
-    VibrateMS((uint64_t)(1000 * seconds));
+    if (Worker.initialized) return Worker.hasVibrator;
+    Worker.initialized = true;
+
+    jobject vibrator = (*env)->CallObjectMethod(env, bridge->nativeLoader, bridge->getSystemService, bridge->vibratorService);
+    if (vibrator == NULL) return false;
+
+    Worker.vibrator = (*env)->NewGlobalRef(env, vibrator);
+    Worker.hasVibrator = (*env)->CallBooleanMethod(env, Worker.vibrator, bridge->hasVibrator);
+    (*env)->DeleteLocalRef(env, vibrator);
+
+    return Worker.hasVibrator;
 }
 
-void VibrateMS(uint64_t ms)
+static HapticPatternSlot *GetPatternSlot(HapticPattern pattern)
 {
-    jobject nativeLoaderInst = GetNativeLoaderInstance();
-    JNIEnv* env = AttachCurrentThread();
+    if (pattern == 0) return NULL;
 
-    jclass nativeLoaderClass = (*env)->GetObjectClass(env, nativeLoaderInst);
-    jmethodID getSystemServiceMethod = (*env)->GetMethodID(env, nativeLoaderClass, "getSystemService", "(Ljava/lang/String;)Ljava/lang/Object;");
+    HapticPatternSlot *slot = &Patterns.slots[pattern%MAX_HAPTIC_PATTERNS];
+    return (slot->handle == pattern) ? slot : NULL;
+}
 
-    jstring vibratorService = (*env)->NewStringUTF(env, "vibrator");
-    jobject vibrator = (*env)->CallObjectMethod(env, nativeLoaderInst, getSystemServiceMethod, vibratorService);
-    (*env)->DeleteLocalRef(env, vibratorService);
+static HapticPattern AddPattern(JNIEnv *env, jobject effect, jlongArray timings)
+{
+    pthread_mutex_lock(&Patterns.mutex);
 
-    jclass vibratorClass = (*env)->GetObjectClass(env, vibrator);
-    jmethodID hasVibratorMethod = (*env)->GetMethodID(env, vibratorClass, "hasVibrator", "()Z");
-    jboolean hasVibrator = (*env)->CallBooleanMethod(env, vibrator, hasVibratorMethod);
+    HapticPatternSlot *slot = NULL;
 
-    if (hasVibrator) {
-        jmethodID vibrateMethod = (*env)->GetMethodID(env, vibratorClass, "vibrate", "(J)V");
-        if (vibrateMethod != NULL) {
-            (*env)->CallVoidMethod(env, vibrator, vibrateMethod, (jlong)ms);
+    for (int i = 0; i < MAX_HAPTIC_PATTERNS; i++) {
+        if (Patterns.slots[i].handle == 0) {
+            slot = &Patterns.slots[i];
+            break;
         }
     }
 
-    DetachCurrentThread();
+    if (slot == NULL) {
+        pthread_mutex_unlock(&Patterns.mutex);
+        TraceLog(LOG_WARNING, "RAYMOB: Too many haptic patterns loaded");
+        return 0;
+    }
+
+    // NOTE: Same handle scheme as storage requests, stale handles never match a reused slot
+    int index = (int)(slot - Patterns.slots);
+    if (++Patterns.generation > UINT32_MAX/MAX_HAPTIC_PATTERNS) Patterns.generation = 1;
+
+    slot->handle = Patterns.generation*MAX_HAPTIC_PATTERNS + index;
+    slot->effect = (effect != NULL) ? (*env)->NewGlobalRef(env, effect) : NULL;
+    slot->timings = (timings != NULL) ? (jlongArray)(*env)->NewGlobalRef(env, timings) : NULL;
+
+    HapticPattern handle = slot->handle;
+
+    pthread_mutex_unlock(&Patterns.mutex);
+
+    return handle;
+}
+
+static void PlayPattern(JNIEnv *env, const RaymobBridge *bridge, HapticPattern pattern)
+{
+    // NOTE: Local references keep the objects alive if the pattern is unloaded meanwhile
+    pthread_mutex_lock(&Patterns.mutex);
+
+    HapticPatternSlot *slot = GetPatternSlot(pattern);
+    jobject effect = (slot != NULL && slot->effect != NULL) ? (*env)->NewLocalRef(env, slot->effect) : NULL;
+    jobject timings = (slot != NULL && slot->timings != NULL) ? (*env)->NewLocalRef(env, slot->timings) : NULL;
+
+    pthread_mutex_unlock(&Patterns.mutex);
+
+    if (effect != NULL) {
+        (*env)->CallVoidMethod(env, Worker.vibrator, bridge->vibrateEffect, effect);
+        (*env)->DeleteLocalRef(env, effect);
+    }
+
+    if (timings != NULL) {
+        (*env)->CallVoidMethod(env, Worker.vibrator, bridge->vibratePattern, (jlongArray)timings, (jint)-1);
+        (*env)->DeleteLocalRef(env, timings);
+    }
+}
+
+static void ExecuteVibratorCommand(const HapticCommand *command)
+{
+    const RaymobBridge *bridge = GetBridge();
+    if (bridge == NULL) return;
+
+    JNIEnv* env = GetThreadJNIEnv();
+    if (!InitVibrator(env, bridge)) return;
+
+    switch (command->type) {
+        case HAPTIC_ONE_SHOT:
+            // NOTE: Without VibrationEffect (API < 26) the intensity cannot be controlled
+            if (bridge->vibrationEffectClass == NULL || command->amplitude == HAPTIC_DEFAULT_AMPLITUDE) {
+                if (bridge->vibrate != NULL) {
+                    (*env)->CallVoidMethod(env, Worker.vibrator, bridge->vibrate, (jlong)command->duration);
+                }
+            } else {
+                jobject vibrationEffect = (*env)->CallStaticObjectMethod(env, bridge->vibrationEffectClass, bridge->createOneShot, (jlong)command->duration, (jint)command->amplitude);
+
+                if (vibrationEffect != NULL) {
+                    (*env)->CallVoidMethod(env, Worker.vibrator, bridge->vibrateEffect, vibrationEffect);
+                    (*env)->DeleteLocalRef(env, vibrationEffect);
+                }
+            }
+            break;
+
+        case HAPTIC_CANCEL:
+            (*env)->CallVoidMethod(env, Worker.vibrator, bridge->cancelVibration);
+            break;
+
+        case HAPTIC_PATTERN:
+            PlayPattern(env, bridge, command->pattern);
+            break;
+
+        default: break;
+    }
+
+    // NOTE: A failing call must not leave an exception pending on the worker
+    if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+}
+
+static void PushVibratorCommand(HapticCommand command)
+{
+    if (!StartHaptics(ExecuteVibratorCommand)) return;
+
+    if (!PushHapticCommand(command)) {
+        TraceLog(LOG_DEBUG, "RAYMOB: Haptics queue is full, vibration dropped");
+    }
+}
+
+/* PUBLIC API */
+
+void Vibrate(float seconds)
+{
+    VibrateMS((uint64_t)(1000 * seconds));
+}
+
+void VibrateMS(uint64_t ms)
+{
+    PushVibratorCommand((HapticCommand){ .type = HAPTIC_ONE_SHOT, .duration = (int64_t)ms, .amplitude = HAPTIC_DEFAULT_AMPLITUDE });
 }
 
 void VibrateEx(float seconds, float intensity)
@@ -62,35 +205,137 @@ void VibrateEx(float seconds, float intensity)
 
 void VibrateExMS(uint64_t ms, float intensity)
 {
-    jobject nativeLoaderInst = GetNativeLoaderInstance();
-    JNIEnv* env = AttachCurrentThread();
+    int amplitude = (int)(intensity * 255);
+    if (amplitude > 255) amplitude = 255;
+    if (amplitude < 1) amplitude = 1;
+
+    PushVibratorCommand((HapticCommand){ .type = HAPTIC_ONE_SHOT, .duration = (int64_t)ms, .amplitude = amplitude });
+}
+
+void CancelVibration(void)
+{
+    PushVibratorCommand((HapticCommand){ .type = HAPTIC_CANCEL });
+}
+
+HapticPattern LoadHapticPattern(const int64_t *timings, const int *amplitudes, int count)
+{
+    if (timings == NULL || count <= 0) return 0;
+
+    const RaymobBridge *bridge = GetBridge();
+    if (bridge == NULL) return 0;
+
+    JNIEnv* env = GetThreadJNIEnv();
+
+    jlongArray timingArray = (*env)->NewLongArray(env, count);
+    if (timingArray == NULL) return 0;
+
+    jlong *timingValues = (*env)->GetLongArrayElements(env, timingArray, NULL);
+
+    if (timingValues == NULL) {
+        (*env)->DeleteLocalRef(env, timingArray);
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) timingValues[i] = (timings[i] > 0) ? (jlong)timings[i] : 0;
+    (*env)->ReleaseLongArrayElements(env, timingArray, timingValues, 0);
+
+    HapticPattern pattern = 0;
+
+    // NOTE: Without VibrationEffect (API < 26) the amplitudes cannot be controlled
+    if (bridge->vibrationEffectClass == NULL || bridge->createWaveform == NULL) {
+        pattern = AddPattern(env, NULL, timingArray);
+    } else {
+        jintArray amplitudeArray = (*env)->NewIntArray(env, count);
+        jint *amplitudeValues = (amplitudeArray != NULL) ? (*env)->GetIntArrayElements(env, amplitudeArray, NULL) : NULL;
 
-    jclass nativeLoaderClass = (*env)->GetObjectClass(env, nativeLoaderInst);
-    jmethodID getSystemServiceMethod = (*env)->GetMethodID(env, nativeLoaderClass, "getSystemService", "(Ljava/lang/String;)Ljava/lang/Object;");
+        if (amplitudeValues != NULL) {
+            for (int i = 0; i < count; i++) {
+                int amplitude = (amplitudes != NULL) ? amplitudes[i] : ((i%2 == 1) ? HAPTIC_DEFAULT_AMPLITUDE : 0);
+                if (amplitude > 255) amplitude = 255;
+                if (amplitude < 0 && amplitude != HAPTIC_DEFAULT_AMPLITUDE) amplitude = 0;
+                amplitudeValues[i] = amplitude;
+            }
 
-    jstring vibratorService = (*env)->NewStringUTF(env, "vibrator");
-    jobject vibrator = (*env)->CallObjectMethod(env, nativeLoaderInst, getSystemServiceMethod, vibratorService);
-    (*env)->DeleteLocalRef(env, vibratorService);
+            (*env)->ReleaseIntArrayElements(env, amplitudeArray, amplitudeValues, 0);
 
-    jclass vibratorClass = (*env)->GetObjectClass(env, vibrator);
-    jmethodID hasVibratorMethod = (*env)->GetMethodID(env, vibratorClass, "hasVibrator", "()Z");
-    jboolean hasVibrator = (*env)->CallBooleanMethod(env, vibrator, hasVibratorMethod);
+            jobject effect = (*env)->CallStaticObjectMethod(env, bridge->vibrationEffectClass, bridge->createWaveform, timingArray, amplitudeArray, (jint)-1);
 
-    if (hasVibrator) {
-        jclass vibrationEffectClass = (*env)->FindClass(env, "android/os/VibrationEffect");
-        jmethodID createOneShotMethod = (*env)->GetStaticMethodID(env, vibrationEffectClass, "createOneShot", "(JI)Landroid/os/VibrationEffect;");
+            // NOTE: createWaveform() throws on invalid patterns (e.g. all timings zero)
+            if ((*env)->ExceptionCheck(env)) {
+                (*env)->ExceptionClear(env);
+                effect = NULL;
+            }
 
-        int intensityValue = (int)(intensity * 255);
-        if (intensityValue > 255) intensityValue = 255;
-        if (intensityValue < 1) intensityValue = 1;
+            if (effect != NULL) {
+                pattern = AddPattern(env, effect, NULL);
+                (*env)->DeleteLocalRef(env, effect);
+            }
+        }
+
+        if (amplitudeArray != NULL) (*env)->DeleteLocalRef(env, amplitudeArray);
+    }
+
+    (*env)->DeleteLocalRef(env, timingArray);
 
-        jobject vibrationEffect = (*env)->CallStaticObjectMethod(env, vibrationEffectClass, createOneShotMethod, (jlong)ms, (jint)intensityValue);
+    return pattern;
+}
+
+HapticPattern LoadHapticEffect(HapticEffect effect)
+{
+    const RaymobBridge *bridge = GetBridge();
+    if (bridge == NULL) return 0;
 
-        if (vibrationEffect != NULL) {
-            jmethodID vibrateMethod = (*env)->GetMethodID(env, vibratorClass, "vibrate", "(Landroid/os/VibrationEffect;)V");
-            (*env)->CallVoidMethod(env, vibrator, vibrateMethod, vibrationEffect);
+    if (bridge->vibrationEffectClass != NULL && bridge->createPredefined != NULL) {
+        JNIEnv* env = GetThreadJNIEnv();
+
+        jobject predefined = (*env)->CallStaticObjectMethod(env, bridge->vibrationEffectClass, bridge->createPredefined, (jint)effect);
+
+        if ((*env)->ExceptionCheck(env)) {
+            (*env)->ExceptionClear(env);
+            predefined = NULL;
+        }
+
+        if (predefined != NULL) {
+            HapticPattern pattern = AddPattern(env, predefined, NULL);
+            (*env)->DeleteLocalRef(env, predefined);
+            return pattern;
         }
     }
 
-    DetachCurrentThread();
+    // Approximations of the predefined effects as plain waveforms (off, on, ...)
+    switch (effect) {
+        case HAPTIC_EFFECT_CLICK: return LoadHapticPattern((int64_t[]){ 0, 20 }, (int[]){ 0, 200 }, 2);
+        case HAPTIC_EFFECT_DOUBLE_CLICK: return LoadHapticPattern((int64_t[]){ 0, 20, 80, 20 }, (int[]){ 0, 200, 0, 200 }, 4);
+        case HAPTIC_EFFECT_TICK: return LoadHapticPattern((int64_t[]){ 0, 10 }, (int[]){ 0, 100 }, 2);
+        case HAPTIC_EFFECT_HEAVY_CLICK: return LoadHapticPattern((int64_t[]){ 0, 30 }, (int[]){ 0, 255 }, 2);
+        default: break;
+    }
+
+    return 0;
+}
+
+void UnloadHapticPattern(HapticPattern pattern)
+{
+    const RaymobBridge *bridge = GetBridge();
+    if (bridge == NULL) return;
+
+    JNIEnv* env = GetThreadJNIEnv();
+
+    pthread_mutex_lock(&Patterns.mutex);
+
+    HapticPatternSlot *slot = GetPatternSlot(pattern);
+
+    if (slot != NULL) {
+        if (slot->effect != NULL) (*env)->DeleteGlobalRef(env, slot->effect);
+        if (slot->timings != NULL) (*env)->DeleteGlobalRef(env, slot->timings);
+        *slot = (HapticPatternSlot){ 0 };
+    }
+
+    pthread_mutex_unlock(&Patterns.mutex);
+}
+
+void PlayHapticPattern(HapticPattern pattern)
+{
+    if (pattern == 0) return;
+    PushVibratorCommand((HapticCommand){ .type = HAPTIC_PATTERN, .pattern = pattern });
 }
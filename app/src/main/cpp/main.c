@@ -27,12 +27,16 @@ int main(void)
     // Initialization
     //--------------------------------------------------------------------------------------
     InitWindow(0, 0, "raylib [core] example - basic window");
-    SetTargetFPS(60);               // Set our game to run at 60 frames-per-second
+
+    // Set our game to run at 60 frames-per-second, paced on the display vsync when available
+    if (!InitFramePacer(60)) SetTargetFPS(60);
     //--------------------------------------------------------------------------------------
 
     // Main game loop
     while (!WindowShouldClose())    // Detect window close button or ESC key
     {
+        WaitNextPacedFrame();       // Starts the frame just ahead of its vsync (no-op without pacer)
+
         // Update
         //----------------------------------------------------------------------------------
         // TODO: Update your variables here
@@ -42,7 +46,11 @@ int main(void)
         //----------------------------------------------------------------------------------
         BeginDrawing();
 
-        ClearBackground(RAYWHITE);
+            BeginDynamicResolution();   // Scene drawn at a variable resolution (no-op unless enabled)
+
+                ClearBackground(RAYWHITE);
+
+            EndDynamicResolution();
 
         DrawText("Congrats! You created your first window!", 190, 200, 20, LIGHTGRAY);
 
@@ -52,6 +60,7 @@ int main(void)
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+    CloseFramePacer();
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
 
@@ -1,15 +1,30 @@
 package com.raylib.raymob;
 
 import android.os.Build;
+import android.os.Handler;
+import android.os.Looper;
 import android.view.Display;
+import android.view.DisplayCutout;
 import android.view.View;
+import android.view.WindowInsets;
 import android.app.NativeActivity;
+import android.content.Context;
+import android.graphics.Insets;
+import android.graphics.Rect;
 import android.view.WindowManager.LayoutParams;
 
+import java.util.TreeSet;
+
 public class DisplayManager {
 
     NativeActivity activity;
     public Display display;
+    public volatile boolean nativeDisplay = false;  // Set by raymob once onDisplayState is registered
+
+    private final Rect safeArea = new Rect();
+    private final Rect cutout = new Rect();
+    private int imeHeight = 0;
+    private android.hardware.display.DisplayManager.DisplayListener displayListener;
 
     public DisplayManager(android.content.Context context) {
         activity = (NativeActivity)(context);
@@ -53,6 +68,117 @@ public class DisplayManager {
         return display != null ? display.getRotation() : -1;
     }
 
+    // Refresh rates the display can switch to without changing its resolution, in ascending order
+    public float[] getSupportedRefreshRates() {
+        if (display == null) {
+            return new float[0];
+        }
+        if (Build.VERSION.SDK_INT < Build.VERSION_CODES.M) {
+            return new float[] { display.getRefreshRate() };
+        }
+
+        Display.Mode current = display.getMode();
+        TreeSet<Float> rates = new TreeSet<>();
+
+        for (Display.Mode mode : display.getSupportedModes()) {
+            if (mode.getPhysicalWidth() == current.getPhysicalWidth() &&
+                mode.getPhysicalHeight() == current.getPhysicalHeight()) {
+                rates.add(mode.getRefreshRate());
+            }
+        }
+
+        float[] result = new float[rates.size()];
+        int i = 0;
+        for (float rate : rates) {
+            result[i++] = rate;
+        }
+
+        return result;
+    }
+
+    // Starts pushing the display state to raymob, on every display or insets change
+    public void startListening() {
+        activity.runOnUiThread(() -> {
+            if (displayListener != null) {
+                return;     // Already listening
+            }
+
+            android.hardware.display.DisplayManager displayService =
+                (android.hardware.display.DisplayManager)activity.getSystemService(Context.DISPLAY_SERVICE);
+
+            displayListener = new android.hardware.display.DisplayManager.DisplayListener() {
+                @Override public void onDisplayAdded(int displayId) { }
+                @Override public void onDisplayRemoved(int displayId) { }
+                @Override public void onDisplayChanged(int displayId) {
+                    if (display != null && display.getDisplayId() == displayId) {
+                        pushDisplayState();
+                    }
+                }
+            };
+
+            displayService.registerDisplayListener(displayListener, new Handler(Looper.getMainLooper()));
+
+            View decorView = activity.getWindow().getDecorView();
+
+            decorView.setOnApplyWindowInsetsListener((view, insets) -> {
+                readInsets(insets);
+                pushDisplayState();
+                return view.onApplyWindowInsets(insets);
+            });
+
+            decorView.requestApplyInsets();
+            pushDisplayState();
+        });
+    }
+
+    // Stops pushing the display state, must be called from the UI thread (e.g. onDestroy)
+    public void stopListening() {
+        if (displayListener == null) {
+            return;
+        }
+
+        android.hardware.display.DisplayManager displayService =
+            (android.hardware.display.DisplayManager)activity.getSystemService(Context.DISPLAY_SERVICE);
+
+        // NOTE: The service holds the listener, which holds the activity
+        displayService.unregisterDisplayListener(displayListener);
+        displayListener = null;
+
+        activity.getWindow().getDecorView().setOnApplyWindowInsetsListener(null);
+    }
+
+    private void readInsets(WindowInsets insets) {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.R) {
+            Insets bars = insets.getInsets(WindowInsets.Type.systemBars() | WindowInsets.Type.displayCutout());
+            safeArea.set(bars.left, bars.top, bars.right, bars.bottom);
+            imeHeight = insets.getInsets(WindowInsets.Type.ime()).bottom;
+        } else {
+            safeArea.set(insets.getSystemWindowInsetLeft(), insets.getSystemWindowInsetTop(),
+                         insets.getSystemWindowInsetRight(), insets.getSystemWindowInsetBottom());
+            imeHeight = 0;  // Not told apart from the navigation bar before API 30
+        }
+
+        cutout.setEmpty();
+
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.P) {
+            DisplayCutout displayCutout = insets.getDisplayCutout();
+            if (displayCutout != null) {
+                cutout.set(displayCutout.getSafeInsetLeft(), displayCutout.getSafeInsetTop(),
+                           displayCutout.getSafeInsetRight(), displayCutout.getSafeInsetBottom());
+                safeArea.set(Math.max(safeArea.left, cutout.left), Math.max(safeArea.top, cutout.top),
+                             Math.max(safeArea.right, cutout.right), Math.max(safeArea.bottom, cutout.bottom));
+            }
+        }
+    }
+
+    private void pushDisplayState() {
+        if (nativeDisplay && display != null) {
+            onDisplayState(display.getRotation(), display.getRefreshRate(),
+                           safeArea.left, safeArea.top, safeArea.right, safeArea.bottom,
+                           cutout.left, cutout.top, cutout.right, cutout.bottom, imeHeight);
+        }
+    }
+
     public void renderIntoCutoutArea() {
         if (android.os.Build.VERSION.SDK_INT >= android.os.Build.VERSION_CODES.P) {
             LayoutParams lp = activity.getWindow().getAttributes();
@@ -61,4 +187,11 @@ public class DisplayManager {
         }
     }
 
+    /* NATIVE METHODS (display.c) */
+
+    private native void onDisplayState(int rotation, float refreshRate,
+                                       int safeLeft, int safeTop, int safeRight, int safeBottom,
+                                       int cutoutLeft, int cutoutTop, int cutoutRight, int cutoutBottom,
+                                       int imeHeight);
+
 }
@@ -25,14 +25,22 @@
 package com.raylib.raymob;  // Don't change the package name (see gradle.properties)
 
 import android.app.NativeActivity;
+import android.content.res.Configuration;
+import android.content.res.Resources;
 import android.view.KeyEvent;
 import android.os.Bundle;
 
+import java.io.ByteArrayOutputStream;
+import java.lang.reflect.Field;
+import java.nio.charset.StandardCharsets;
+
 public class NativeLoader extends NativeActivity {
 
     public DisplayManager displayManager;
     public SoftKeyboard softKeyboard;
-    public boolean initCallback = false;
+    public volatile boolean initCallback = false;
+    public volatile boolean nativeBridge = false;   // Set by raymob once its native methods are registered
+    private String currentLocales;
 
     // Loading method of your native application
     @Override
@@ -40,6 +48,7 @@ public class NativeLoader extends NativeActivity {
         super.onCreate(savedInstanceState);
         displayManager = new DisplayManager(this);
         softKeyboard = new SoftKeyboard(this);
+        currentLocales = getResources().getConfiguration().getLocales().toLanguageTags();
         System.loadLibrary("raymob");   // Load your game library (don't change raymob, see gradle.properties)
     }
 
@@ -52,6 +61,37 @@ public class NativeLoader extends NativeActivity {
         }
     }
 
+    // Notify raymob when the locale changes so it can reload its strings
+    @Override
+    public void onConfigurationChanged(Configuration newConfig) {
+        super.onConfigurationChanged(newConfig);
+        String locales = newConfig.getLocales().toLanguageTags();
+        if (!locales.equals(currentLocales)) {
+            currentLocales = locales;
+            if (nativeBridge) {
+                onLocaleChanged();
+            }
+        }
+    }
+
+    // Packs all string resources as UTF-8 "name\0value\0" pairs, loaded at once by raymob
+    public byte[] getPackedStrings() {
+        ByteArrayOutputStream packed = new ByteArrayOutputStream();
+        for (Field field : R.string.class.getFields()) {
+            try {
+                byte[] name = field.getName().getBytes(StandardCharsets.UTF_8);
+                byte[] value = getString(field.getInt(null)).getBytes(StandardCharsets.UTF_8);
+                packed.write(name, 0, name.length);
+                packed.write(0);
+                packed.write(value, 0, value.length);
+                packed.write(0);
+            } catch (IllegalAccessException | Resources.NotFoundException e) {
+                // Not a string resource of this configuration, skip it
+            }
+        }
+        return packed.toByteArray();
+    }
+
     // Callback methods for managing the Android software keyboard
     @Override
     public boolean onKeyUp(int keyCode, KeyEvent event) {
@@ -91,9 +131,17 @@ public class NativeLoader extends NativeActivity {
         }
     }
 
+    @Override
+    protected void onDestroy() {
+        displayManager.stopListening();
+        super.onDestroy();
+    }
+
     private native void onAppStart();
     private native void onAppResume();
     private native void onAppPause();
     private native void onAppStop();
 
+    private native void onLocaleChanged();
+
 }
\ No newline at end of file
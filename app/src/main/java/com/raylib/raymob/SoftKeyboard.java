@@ -24,54 +24,163 @@
 
 package com.raylib.raymob;
 
+import android.view.inputmethod.BaseInputConnection;
 import android.view.inputmethod.InputMethodManager;
+import android.view.inputmethod.InputConnection;
+import android.view.inputmethod.EditorInfo;
 import android.app.NativeActivity;
 import android.content.Context;
+import android.text.InputType;
+import android.view.ViewGroup;
 import android.view.KeyEvent;
+import android.view.View;
+
+import java.nio.charset.StandardCharsets;
 
 public class SoftKeyboard {
 
     private final Context context;
     private final InputMethodManager imm;
-    private KeyEvent lastKeyEvent = null;
+    private final TextInputView textInputView;
+    private volatile boolean textInput = false;
+
+    public volatile boolean nativeQueue = false;    // Set by raymob once onKeyEvent and onTextInput are registered
 
     public SoftKeyboard(Context context) {
         imm = (InputMethodManager)context.getSystemService(Context.INPUT_METHOD_SERVICE);
         this.context = context;
+
+        // Invisible view owning the input connection, only focused while text input is enabled
+        textInputView = new TextInputView(context);
+        ((NativeActivity)context).addContentView(textInputView, new ViewGroup.LayoutParams(1, 1));
     }
 
     /* PUBLIC FOR JNI (raymob.h) */
 
     public void showKeyboard() {
-        imm.showSoftInput(((NativeActivity)context).getWindow().getDecorView(), InputMethodManager.SHOW_FORCED);
+        if (textInput) {
+            ((NativeActivity)context).runOnUiThread(() -> {
+                textInputView.setFocusable(true);
+                textInputView.setFocusableInTouchMode(true);
+                textInputView.requestFocus();
+                imm.showSoftInput(textInputView, InputMethodManager.SHOW_FORCED);
+            });
+        } else {
+            imm.showSoftInput(((NativeActivity)context).getWindow().getDecorView(), InputMethodManager.SHOW_FORCED);
+        }
     }
 
     public void hideKeyboard() {
         imm.hideSoftInputFromWindow(((NativeActivity)context).getWindow().getDecorView().getWindowToken(), 0);
+        ((NativeActivity)context).runOnUiThread(this::releaseTextInputView);
     }
 
-    public int getLastKeyCode() {
-        if (lastKeyEvent != null) return lastKeyEvent.getKeyCode();
-        return 0;
+    public void setTextInput(boolean enabled) {
+        textInput = enabled;
+        if (!enabled) {
+            ((NativeActivity)context).runOnUiThread(this::releaseTextInputView);
+        }
     }
 
-    public char getLastKeyLabel() {
-        if (lastKeyEvent != null) return lastKeyEvent.getDisplayLabel();
-        return '\0';
+    /* PRIVATE FOR JNI (raymob.h) */
+
+    public void onKeyUpEvent(KeyEvent event) {
+        if (nativeQueue) {
+            onKeyEvent(event.getKeyCode(), event.getUnicodeChar(), event.getDisplayLabel(), event.getEventTime());
+        }
     }
 
-    public int getLastKeyUnicode() {
-        if (lastKeyEvent != null) return lastKeyEvent.getUnicodeChar();
-        return 0;
+    /* TEXT INPUT */
+
+    private void releaseTextInputView() {
+        textInputView.clearFocus();
+        textInputView.setFocusable(false);
+        textInputView.setFocusableInTouchMode(false);
     }
 
-    public void clearLastKeyEvent() {
-        lastKeyEvent = null;
+    // Sends committed and composing text in a single call, null when unchanged
+    private void sendTextInput(String committed, String composing) {
+        if (nativeQueue) {
+            onTextInput(committed != null ? committed.getBytes(StandardCharsets.UTF_8) : null,
+                        composing != null ? composing.getBytes(StandardCharsets.UTF_8) : null);
+        }
     }
 
-    /* PRIVATE FOR JNI (raymob.h) */
+    private class TextInputView extends View {
 
-    public void onKeyUpEvent(KeyEvent event) {
-        lastKeyEvent = event;
+        TextInputView(Context context) {
+            super(context);
+            setFocusable(false);
+        }
+
+        @Override
+        public boolean onCheckIsTextEditor() {
+            return true;
+        }
+
+        @Override
+        public InputConnection onCreateInputConnection(EditorInfo outAttrs) {
+            outAttrs.inputType = InputType.TYPE_CLASS_TEXT;
+            outAttrs.imeOptions = EditorInfo.IME_FLAG_NO_FULLSCREEN | EditorInfo.IME_FLAG_NO_EXTRACT_UI;
+            return new TextInputConnection(this);
+        }
     }
+
+    // NOTE: The text itself lives on the native side, this connection has no editable
+    //       of its own and only forwards what the input method does to it
+    private class TextInputConnection extends BaseInputConnection {
+
+        private String composing = "";
+
+        TextInputConnection(View view) {
+            super(view, false);
+        }
+
+        @Override
+        public boolean commitText(CharSequence text, int newCursorPosition) {
+            composing = "";
+            sendTextInput(text.toString(), composing);
+            return true;
+        }
+
+        @Override
+        public boolean setComposingText(CharSequence text, int newCursorPosition) {
+            composing = text.toString();
+            sendTextInput(null, composing);
+            return true;
+        }
+
+        @Override
+        public boolean finishComposingText() {
+            if (!composing.isEmpty()) {
+                String committed = composing;
+                composing = "";
+                sendTextInput(committed, composing);
+            }
+            return true;
+        }
+
+        @Override
+        public boolean deleteSurroundingText(int beforeLength, int afterLength) {
+            // Deletions are sent as control characters ('\b' before, DEL after)
+            // so that they keep their order with the committed text.
+            // NOTE: One per UTF-16 unit, raymob deletes a surrogate pair for two of them
+            StringBuilder deletions = new StringBuilder();
+            for (int i = 0; i < beforeLength; i++) deletions.append('\b');
+            for (int i = 0; i < afterLength; i++) deletions.append('\u007f');
+            sendTextInput(deletions.toString(), null);
+            return true;
+        }
+
+        @Override
+        public boolean performEditorAction(int editorAction) {
+            sendTextInput("\n", null);
+            return true;
+        }
+    }
+
+    /* NATIVE METHODS (soft_keyboard.c) */
+
+    private native void onKeyEvent(int keyCode, int unicode, char label, long eventTime);
+    private native void onTextInput(byte[] committed, byte[] composing);
 }
@@ -0,0 +1,159 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Measures the time the game thread is stalled by autosaves, written
+ * synchronously with WriteToAppStorageAtomic() and then asynchronously with
+ * WriteToAppStorageAsync(), in a loop polling the completions every frame.
+ *
+ *     bench_storage_async [save size in MB] [number of saves]
+ *
+ * Also checks that the asynchronous saves complete in order and that the
+ * last one is what ends up on disk.
+ */
+
+#include "raymob.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <string.h>
+#include <time.h>
+
+#define FRAME_TIME          (1.0/60.0)
+#define FRAMES_PER_SAVE     10
+#define SAVE_PATH           "autosave.bin"
+
+typedef struct StallStats {
+    double total;
+    double max;
+} StallStats;
+
+static int completed = 0;
+static int failed = 0;
+static StorageRequest lastCompleted = 0;
+
+static double GetSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec*1e-9;
+}
+
+static void WaitNextFrame(double frameStart)
+{
+    while (GetSeconds() - frameStart < FRAME_TIME) {
+        struct timespec wait = { 0, 500000 };
+        nanosleep(&wait, NULL);
+    }
+}
+
+static void AddStall(StallStats *stats, double stall)
+{
+    stats->total += stall;
+    if (stall > stats->max) stats->max = stall;
+}
+
+static void OnSaved(StorageRequest request, StorageRequestStatus status, void *data, int dataSize, void *userData)
+{
+    if (status == STORAGE_REQUEST_DONE) completed++;
+    else failed++;
+
+    if (request < lastCompleted) failed++;     // Out of submission order
+    lastCompleted = request;
+}
+
+static StallStats RunSynchronous(unsigned char *save, unsigned int size, int saves)
+{
+    StallStats stats = { 0 };
+
+    for (int frame = 0; frame < saves*FRAMES_PER_SAVE; frame++) {
+        double frameStart = GetSeconds();
+
+        if (frame%FRAMES_PER_SAVE == 0) {
+            save[0] = (unsigned char)frame;
+            CHECK(WriteToAppStorageAtomic(SAVE_PATH, save, size));
+            AddStall(&stats, GetSeconds() - frameStart);
+        }
+
+        WaitNextFrame(frameStart);
+    }
+
+    return stats;
+}
+
+static StallStats RunAsynchronous(unsigned char *save, unsigned int size, int saves)
+{
+    StallStats stats = { 0 };
+    int frame = 0;
+
+    for (; frame < saves*FRAMES_PER_SAVE || completed + failed < saves; frame++) {
+        double frameStart = GetSeconds();
+
+        if (frame%FRAMES_PER_SAVE == 0 && frame < saves*FRAMES_PER_SAVE) {
+            save[0] = (unsigned char)frame;
+            CHECK(WriteToAppStorageAsync(SAVE_PATH, save, size, STORAGE_PRIORITY_NORMAL, OnSaved, NULL) != 0);
+        }
+
+        PollStorageRequests();
+        AddStall(&stats, GetSeconds() - frameStart);
+
+        WaitNextFrame(frameStart);
+    }
+
+    return stats;
+}
+
+int main(int argc, char **argv)
+{
+    int sizeMB = (argc > 1) ? atoi(argv[1]) : 2;
+    int saves = (argc > 2) ? atoi(argv[2]) : 4;
+
+    if (sizeMB <= 0 || saves <= 0 || !InitMockAndroid()) return 1;
+
+    unsigned int size = (unsigned int)sizeMB*1024*1024;
+    unsigned char *save = malloc(size);
+    if (save == NULL) return 1;
+
+    for (unsigned int i = 0; i < size; i++) save[i] = (unsigned char)(i*31);
+
+    StallStats sync = RunSynchronous(save, size, saves);
+    StallStats async = RunAsynchronous(save, size, saves);
+
+    printf("%d saves of %d MB, game thread stall per save:\n", saves, sizeMB);
+    printf("    synchronous:  %8.3f ms average, %8.3f ms max\n", 1000.0*sync.total/saves, 1000.0*sync.max);
+    printf("    asynchronous: %8.3f ms average, %8.3f ms max\n", 1000.0*async.total/saves, 1000.0*async.max);
+
+    CHECK(completed == saves && failed == 0);
+
+    // The last save wins
+    int readSize = 0;
+    unsigned char *saved = ReadFromAppStorage(SAVE_PATH, &readSize);
+    CHECK(saved != NULL && readSize == (int)size && memcmp(saved, save, size) == 0);
+
+    free(saved);
+    free(save);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,213 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Compares the chunked StorageStream reader to the whole-file
+ * ReadFromAppStorage() on a sparse file, and measures the chunked writer.
+ *
+ *     bench_storage_stream [file size in MB] [chunk size in KB]
+ *
+ * Beyond 2047 MB the whole-file path is expected to reject the file, while
+ * the stream still reads it with a buffer of one chunk. Also checks the data
+ * read back, and 64bit seeks to the end of the file.
+ */
+
+#include "raymob.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define PACK_PATH       "pack.bin"
+#define WRITE_PATH      "written.bin"
+#define MARKER_SIZE     16
+#define MAX_WRITE_MB    256     // The written file is not sparse, keep it reasonable
+
+static const char header[MARKER_SIZE] = "RAYMOB PACK HEAD";
+static const char trailer[MARKER_SIZE] = "RAYMOB PACK TAIL";
+
+static double GetSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec*1e-9;
+}
+
+static double GetRate(int64_t bytes, double seconds)
+{
+    return (seconds > 0.0) ? (double)bytes/(1024.0*1024.0)/seconds : 0.0;
+}
+
+static bool CreateSparseFile(int64_t size)
+{
+    StorageStream *stream = OpenAppStorageStream(PACK_PATH, STREAM_WRITE);
+    if (stream == NULL) return false;
+
+    // Only the markers are written, the rest of the file is a hole
+    bool success = WriteStorageChunk(stream, header, MARKER_SIZE) == MARKER_SIZE &&
+                   SeekStorageStream(stream, size - MARKER_SIZE, SEEK_SET) &&
+                   WriteStorageChunk(stream, trailer, MARKER_SIZE) == MARKER_SIZE;
+
+    return CloseStorageStream(stream) && success;
+}
+
+static void BenchWholeFile(int64_t size)
+{
+    double start = GetSeconds();
+
+    int dataSize = 0;
+    unsigned char *data = ReadFromAppStorage(PACK_PATH, &dataSize);
+
+    double seconds = GetSeconds() - start;
+
+    if (size > INT_MAX) {
+        CHECK(data == NULL);
+        printf("    whole file:   rejected, the file is bigger than INT_MAX\n");
+        return;
+    }
+
+    CHECK(data != NULL && dataSize == size);
+
+    if (data != NULL) {
+        CHECK(memcmp(data, header, MARKER_SIZE) == 0);
+        CHECK(memcmp(data + size - MARKER_SIZE, trailer, MARKER_SIZE) == 0);
+    }
+
+    printf("    whole file:   %8.1f MB/s, %lld bytes of memory\n", GetRate(size, seconds), (long long)size);
+
+    free(data);
+}
+
+static void BenchStream(int64_t size, size_t chunkSize)
+{
+    unsigned char *chunk = malloc(chunkSize);
+    if (chunk == NULL) return;
+
+    StorageStream *stream = OpenAppStorageStream(PACK_PATH, STREAM_READ);
+    CHECK(stream != NULL);
+    if (stream == NULL) return;
+
+    CHECK(GetStorageStreamSize(stream) == size);
+
+    double start = GetSeconds();
+
+    int64_t total = 0;
+    int64_t count = 0;
+    unsigned char last[MARKER_SIZE] = { 0 };
+
+    while ((count = ReadStorageChunk(stream, chunk, chunkSize)) > 0) {
+        if (total == 0) CHECK(count >= MARKER_SIZE && memcmp(chunk, header, MARKER_SIZE) == 0);
+
+        // NOTE: The trailer may straddle two chunks, keep a sliding copy of the last bytes
+        if (count >= MARKER_SIZE) memcpy(last, chunk + count - MARKER_SIZE, MARKER_SIZE);
+        else {
+            memmove(last, last + count, MARKER_SIZE - count);
+            memcpy(last + MARKER_SIZE - count, chunk, count);
+        }
+
+        total += count;
+    }
+
+    double seconds = GetSeconds() - start;
+
+    CHECK(count == 0 && total == size);
+    CHECK(memcmp(last, trailer, MARKER_SIZE) == 0);
+
+    printf("    stream:       %8.1f MB/s, %zu bytes of memory\n", GetRate(total, seconds), chunkSize);
+
+    // Range read at a 64bit offset, without touching the rest of the file
+    start = GetSeconds();
+
+    CHECK(SeekStorageStream(stream, -MARKER_SIZE, SEEK_END));
+    CHECK(TellStorageStream(stream) == size - MARKER_SIZE);
+    CHECK(ReadStorageChunk(stream, last, MARKER_SIZE) == MARKER_SIZE);
+    CHECK(memcmp(last, trailer, MARKER_SIZE) == 0);
+
+    printf("    range read:   %8.3f ms for the last %d bytes\n", 1000.0*(GetSeconds() - start), MARKER_SIZE);
+
+    CHECK(CloseStorageStream(stream));
+    free(chunk);
+}
+
+static void BenchWriter(int64_t size, size_t chunkSize)
+{
+    unsigned char *chunk = malloc(chunkSize);
+    if (chunk == NULL) return;
+
+    for (size_t i = 0; i < chunkSize; i++) chunk[i] = (unsigned char)(i*7);
+
+    StorageStream *stream = OpenAppStorageStream(WRITE_PATH, STREAM_WRITE);
+    CHECK(stream != NULL);
+    if (stream == NULL) return;
+
+    double start = GetSeconds();
+
+    int64_t total = 0;
+
+    while (total < size) {
+        size_t count = (size - total < (int64_t)chunkSize) ? (size_t)(size - total) : chunkSize;
+        if (WriteStorageChunk(stream, chunk, count) != (int64_t)count) break;
+        total += count;
+    }
+
+    CHECK(total == size && GetStorageStreamSize(stream) == size);
+    CHECK(CloseStorageStream(stream));
+
+    double seconds = GetSeconds() - start;
+
+    printf("    writer:       %8.1f MB/s over %lld MB\n", GetRate(total, seconds), (long long)(size/(1024*1024)));
+
+    RemoveFileInAppStorage(WRITE_PATH);
+    free(chunk);
+}
+
+int main(int argc, char **argv)
+{
+    int64_t sizeMB = (argc > 1) ? atoll(argv[1]) : 64;
+    int64_t chunkKB = (argc > 2) ? atoll(argv[2]) : 1024;
+
+    if (sizeMB <= 0 || chunkKB <= 0 || !InitMockAndroid()) return 1;
+
+    int64_t size = sizeMB*1024*1024;
+    size_t chunkSize = (size_t)chunkKB*1024;
+
+    if (!CreateSparseFile(size)) {
+        fprintf(stderr, "Failed to create a sparse file of %lld MB\n", (long long)sizeMB);
+        return 1;
+    }
+
+    printf("Sparse file of %lld MB, chunks of %lld KB:\n", (long long)sizeMB, (long long)chunkKB);
+
+    BenchWholeFile(size);
+    BenchStream(size, chunkSize);
+    BenchWriter((sizeMB < MAX_WRITE_MB) ? size : (int64_t)MAX_WRITE_MB*1024*1024, chunkSize);
+
+    RemoveFileInAppStorage(PACK_PATH);
+
+    return TEST_RESULT();
+}
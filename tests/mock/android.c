@@ -0,0 +1,498 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#include "android.h"
+#include "input_record.h"
+
+#include <ftw.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* DEFINES */
+
+#define MOCK_MAX_MEMBERS    64
+#define MOCK_MAX_NAME       64
+#define MOCK_MAX_PATH       256
+#define MOCK_MAX_SENSORS    32
+#define MOCK_MAX_VALUES     16
+
+/* TYPES */
+
+typedef enum {
+    MOCK_CLASS,
+    MOCK_INSTANCE,
+    MOCK_STRING,
+    MOCK_ARRAY,
+} MockKind;
+
+struct _jobject {
+    MockKind kind;
+    const char *name;               // Class name, or string value
+    struct _jobject *clazz;         // Class of an instance
+    void *data;                     // Array elements, path of a java.io.File, or MockActivity of a NativeLoader
+    int size;                       // Array length
+};
+
+typedef struct MockActivity {
+    struct _jobject nativeLoader;   // Its data is the MockActivity
+    struct _jobject softKeyboard, displayManager;
+} MockActivity;
+
+typedef struct MockMember {
+    char name[MOCK_MAX_NAME];
+    int calls;                      // Method calls
+    jboolean value;                 // Boolean field value
+} MockMember;
+
+/* GLOBAL VARIABLES */
+
+static struct {
+
+    struct _jobject nativeLoaderClass, softKeyboardClass, displayManagerClass;
+    struct _jobject fileClass, vibratorClass, vibrationEffectClass;
+
+    MockActivity activity;          // The first one, see RecreateMockActivity()
+    struct _jobject vibrator, effect;
+    struct _jobject storageDir, cacheDir;
+    struct _jobject storagePath, cachePath;
+    struct _jobject packedStrings;
+
+    MockMember methods[MOCK_MAX_MEMBERS];
+    MockMember fields[MOCK_MAX_MEMBERS];
+    int methodCount;
+    int fieldCount;
+
+    char storageRoot[MOCK_MAX_PATH];
+    char cacheRoot[MOCK_MAX_PATH];
+
+    int calls;                      // Atomic, the vibrator worker also calls into Java
+    bool storageUnavailable;        // getExternalFilesDir() returns null while set
+
+    float sensorValues[MOCK_MAX_SENSORS][MOCK_MAX_VALUES];
+    int sensorEvents[MOCK_MAX_SENSORS];
+
+} Mock = {
+
+    .nativeLoaderClass = { MOCK_CLASS, "com/raylib/raymob/NativeLoader" },
+    .softKeyboardClass = { MOCK_CLASS, "com/raylib/raymob/SoftKeyboard" },
+    .displayManagerClass = { MOCK_CLASS, "com/raylib/raymob/DisplayManager" },
+    .fileClass = { MOCK_CLASS, "java/io/File" },
+    .vibratorClass = { MOCK_CLASS, "android/os/Vibrator" },
+    .vibrationEffectClass = { MOCK_CLASS, "android/os/VibrationEffect" },
+
+    .activity = {
+        .nativeLoader = { MOCK_INSTANCE, NULL, &Mock.nativeLoaderClass, &Mock.activity },
+        .softKeyboard = { MOCK_INSTANCE, NULL, &Mock.softKeyboardClass },
+        .displayManager = { MOCK_INSTANCE, NULL, &Mock.displayManagerClass },
+    },
+    .vibrator = { MOCK_INSTANCE, NULL, &Mock.vibratorClass },
+    .effect = { MOCK_INSTANCE, NULL, &Mock.vibrationEffectClass },
+    .storageDir = { MOCK_INSTANCE, NULL, &Mock.fileClass, &Mock.storagePath },
+    .cacheDir = { MOCK_INSTANCE, NULL, &Mock.fileClass, &Mock.cachePath },
+    .storagePath = { MOCK_STRING, "" },
+    .cachePath = { MOCK_STRING, "" },
+    .packedStrings = { MOCK_ARRAY },
+};
+
+static pthread_mutex_t memberMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t packedMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static JNIEnv mockEnv;
+static JavaVM mockVM;
+static ANativeActivity mockActivity = { &mockVM, &mockEnv, &Mock.activity.nativeLoader };
+static struct android_app mockApp = { .activity = &mockActivity };
+
+/* INTERNAL FUNCTIONS */
+
+static void CountCall(void)
+{
+    __atomic_add_fetch(&Mock.calls, 1, __ATOMIC_RELAXED);
+}
+
+static MockMember *FindMember(MockMember *members, int *count, const char *name)
+{
+    pthread_mutex_lock(&memberMutex);
+
+    MockMember *member = NULL;
+
+    for (int i = 0; i < *count && member == NULL; i++) {
+        if (strcmp(members[i].name, name) == 0) member = &members[i];
+    }
+
+    if (member == NULL && *count < MOCK_MAX_MEMBERS) {
+        member = &members[(*count)++];
+        snprintf(member->name, sizeof(member->name), "%s", name);
+    }
+
+    pthread_mutex_unlock(&memberMutex);
+
+    return member;
+}
+
+static jobject NewArray(int size, int elementSize)
+{
+    struct _jobject *array = calloc(1, sizeof(struct _jobject));
+    if (array == NULL) return NULL;
+
+    array->kind = MOCK_ARRAY;
+    array->data = calloc((size > 0) ? size : 1, elementSize);
+    array->size = size;
+
+    return array;
+}
+
+static jobject NewPackedStrings(void)
+{
+    // NOTE: A copy, the strings may be replaced while raymob reads them on another thread
+    pthread_mutex_lock(&packedMutex);
+
+    jobject array = NewArray(Mock.packedStrings.size, 1);
+    if (array != NULL) memcpy(array->data, Mock.packedStrings.data, Mock.packedStrings.size);
+
+    pthread_mutex_unlock(&packedMutex);
+
+    return array;
+}
+
+static jobject CallMethod(jobject obj, jmethodID method)
+{
+    MockMember *member = (MockMember *)method;
+    __atomic_add_fetch(&member->calls, 1, __ATOMIC_RELAXED);
+
+    if (strcmp(member->name, "getExternalFilesDir") == 0) return Mock.storageUnavailable ? NULL : &Mock.storageDir;
+    if (strcmp(member->name, "getCacheDir") == 0) return &Mock.cacheDir;
+    if (strcmp(member->name, "getPath") == 0 || strcmp(member->name, "getAbsolutePath") == 0) return obj->data;
+    if (strcmp(member->name, "getPackedStrings") == 0) return NewPackedStrings();
+    if (strcmp(member->name, "getSystemService") == 0) return &Mock.vibrator;
+    if (strncmp(member->name, "create", 6) == 0) return &Mock.effect;
+
+    return NULL;
+}
+
+static int RemovePath(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+    return remove(path);
+}
+
+static void RemoveMockDirs(void)
+{
+    if (Mock.storageRoot[0] != '\0') nftw(Mock.storageRoot, RemovePath, 16, FTW_DEPTH | FTW_PHYS);
+    if (Mock.cacheRoot[0] != '\0') nftw(Mock.cacheRoot, RemovePath, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+static bool MakeTempDir(char *dst, const char *name)
+{
+    const char *tmp = getenv("TMPDIR");
+    snprintf(dst, MOCK_MAX_PATH, "%s/raymob-%s-XXXXXX", (tmp != NULL) ? tmp : "/tmp", name);
+
+    if (mkdtemp(dst) == NULL) {
+        dst[0] = '\0';
+        return false;
+    }
+
+    return true;
+}
+
+/* MOCK JNIENV */
+
+static jclass FindClass(JNIEnv *env, const char *name)
+{
+    CountCall();
+
+    struct _jobject *classes[] = { &Mock.fileClass, &Mock.vibratorClass, &Mock.vibrationEffectClass };
+
+    for (int i = 0; i < (int)(sizeof(classes)/sizeof(classes[0])); i++) {
+        if (strcmp(classes[i]->name, name) == 0) return classes[i];
+    }
+
+    return NULL;
+}
+
+static jclass GetObjectClass(JNIEnv *env, jobject obj) { CountCall(); return obj->clazz; }
+static jobject NewGlobalRef(JNIEnv *env, jobject obj) { CountCall(); return obj; }
+static void DeleteGlobalRef(JNIEnv *env, jobject obj) { CountCall(); }
+static jobject NewLocalRef(JNIEnv *env, jobject obj) { CountCall(); return obj; }
+static void DeleteLocalRef(JNIEnv *env, jobject obj) { CountCall(); }
+static jboolean ExceptionCheck(JNIEnv *env) { CountCall(); return JNI_FALSE; }
+static void ExceptionClear(JNIEnv *env) { CountCall(); }
+static jint RegisterNatives(JNIEnv *env, jclass clazz, const JNINativeMethod *methods, jint count) { CountCall(); return JNI_OK; }
+
+static jfieldID GetFieldID(JNIEnv *env, jclass clazz, const char *name, const char *sig)
+{
+    CountCall();
+    return (jfieldID)FindMember(Mock.fields, &Mock.fieldCount, name);
+}
+
+static jobject GetObjectField(JNIEnv *env, jobject obj, jfieldID field)
+{
+    CountCall();
+
+    const char *name = ((MockMember *)field)->name;
+    MockActivity *activity = (MockActivity *)obj->data;
+
+    if (strcmp(name, "softKeyboard") == 0) return &activity->softKeyboard;
+    if (strcmp(name, "displayManager") == 0) return &activity->displayManager;
+
+    return NULL;
+}
+
+static void SetBooleanField(JNIEnv *env, jobject obj, jfieldID field, jboolean value)
+{
+    CountCall();
+    ((MockMember *)field)->value = value;
+}
+
+static jmethodID GetMethodID(JNIEnv *env, jclass clazz, const char *name, const char *sig)
+{
+    CountCall();
+    return (jmethodID)FindMember(Mock.methods, &Mock.methodCount, name);
+}
+
+static jobject CallObjectMethod(JNIEnv *env, jobject obj, jmethodID method, ...) { CountCall(); return CallMethod(obj, method); }
+static jboolean CallBooleanMethod(JNIEnv *env, jobject obj, jmethodID method, ...) { CountCall(); CallMethod(obj, method); return JNI_TRUE; }
+static jint CallIntMethod(JNIEnv *env, jobject obj, jmethodID method, ...) { CountCall(); CallMethod(obj, method); return 0; }
+static void CallVoidMethod(JNIEnv *env, jobject obj, jmethodID method, ...) { CountCall(); CallMethod(obj, method); }
+static jobject CallStaticObjectMethod(JNIEnv *env, jclass clazz, jmethodID method, ...) { CountCall(); return CallMethod(clazz, method); }
+
+static jstring NewStringUTF(JNIEnv *env, const char *chars)
+{
+    CountCall();
+
+    struct _jobject *string = calloc(1, sizeof(struct _jobject));
+    if (string == NULL) return NULL;
+
+    string->kind = MOCK_STRING;
+    string->name = strdup(chars);
+
+    return string;
+}
+
+static const char *GetStringUTFChars(JNIEnv *env, jstring string, jboolean *isCopy)
+{
+    CountCall();
+    if (isCopy != NULL) *isCopy = JNI_FALSE;
+    return string->name;
+}
+
+static void ReleaseStringUTFChars(JNIEnv *env, jstring string, const char *chars) { CountCall(); }
+
+static jsize GetArrayLength(JNIEnv *env, jarray array) { CountCall(); return array->size; }
+
+static void GetByteArrayRegion(JNIEnv *env, jbyteArray array, jsize start, jsize length, jbyte *buffer)
+{
+    CountCall();
+    memcpy(buffer, (jbyte *)array->data + start, length);
+}
+
+static void GetFloatArrayRegion(JNIEnv *env, jfloatArray array, jsize start, jsize length, jfloat *buffer)
+{
+    CountCall();
+    memcpy(buffer, (jfloat *)array->data + start, length*sizeof(jfloat));
+}
+
+static jintArray NewIntArray(JNIEnv *env, jsize length) { CountCall(); return NewArray(length, sizeof(jint)); }
+static jint *GetIntArrayElements(JNIEnv *env, jintArray array, jboolean *isCopy) { CountCall(); return array->data; }
+static void ReleaseIntArrayElements(JNIEnv *env, jintArray array, jint *elements, jint mode) { CountCall(); }
+static jlongArray NewLongArray(JNIEnv *env, jsize length) { CountCall(); return NewArray(length, sizeof(jlong)); }
+static jlong *GetLongArrayElements(JNIEnv *env, jlongArray array, jboolean *isCopy) { CountCall(); return array->data; }
+static void ReleaseLongArrayElements(JNIEnv *env, jlongArray array, jlong *elements, jint mode) { CountCall(); }
+
+static const struct JNINativeInterface mockEnvFunctions = {
+    .FindClass = FindClass,
+    .GetObjectClass = GetObjectClass,
+    .NewGlobalRef = NewGlobalRef,
+    .DeleteGlobalRef = DeleteGlobalRef,
+    .NewLocalRef = NewLocalRef,
+    .DeleteLocalRef = DeleteLocalRef,
+    .ExceptionCheck = ExceptionCheck,
+    .ExceptionClear = ExceptionClear,
+    .RegisterNatives = RegisterNatives,
+    .GetFieldID = GetFieldID,
+    .GetObjectField = GetObjectField,
+    .SetBooleanField = SetBooleanField,
+    .GetMethodID = GetMethodID,
+    .GetStaticMethodID = GetMethodID,
+    .CallObjectMethod = CallObjectMethod,
+    .CallBooleanMethod = CallBooleanMethod,
+    .CallIntMethod = CallIntMethod,
+    .CallVoidMethod = CallVoidMethod,
+    .CallStaticObjectMethod = CallStaticObjectMethod,
+    .NewStringUTF = NewStringUTF,
+    .GetStringUTFChars = GetStringUTFChars,
+    .ReleaseStringUTFChars = ReleaseStringUTFChars,
+    .GetArrayLength = GetArrayLength,
+    .GetByteArrayRegion = GetByteArrayRegion,
+    .GetFloatArrayRegion = GetFloatArrayRegion,
+    .NewIntArray = NewIntArray,
+    .GetIntArrayElements = GetIntArrayElements,
+    .ReleaseIntArrayElements = ReleaseIntArrayElements,
+    .NewLongArray = NewLongArray,
+    .GetLongArrayElements = GetLongArrayElements,
+    .ReleaseLongArrayElements = ReleaseLongArrayElements,
+};
+
+static JNIEnv mockEnv = &mockEnvFunctions;
+
+/* MOCK JAVAVM */
+
+static jint VMAttachCurrentThread(JavaVM *vm, JNIEnv **env, void *args) { *env = &mockEnv; return JNI_OK; }
+static jint VMDetachCurrentThread(JavaVM *vm) { return JNI_OK; }
+static jint VMGetEnv(JavaVM *vm, void **env, jint version) { *env = &mockEnv; return JNI_OK; }
+
+static const struct JNIInvokeInterface mockVMFunctions = {
+    .AttachCurrentThread = VMAttachCurrentThread,
+    .DetachCurrentThread = VMDetachCurrentThread,
+    .GetEnv = VMGetEnv,
+};
+
+static JavaVM mockVM = &mockVMFunctions;
+
+/* SENSOR SINKS */
+
+// NOTE: sensor.c needs the NDK sensor API, which is not mocked, replayed samples are only counted
+
+void ReplaySensorEvent(Sensor sensor, int64_t timestamp, const float *values, int count)
+{
+    if ((int)sensor < 0 || (int)sensor >= MOCK_MAX_SENSORS) return;
+    if (count > MOCK_MAX_VALUES) count = MOCK_MAX_VALUES;
+
+    memcpy(Mock.sensorValues[sensor], values, count*sizeof(float));
+    Mock.sensorEvents[sensor]++;
+}
+
+void FlushReplayedSensorEvents(void) { }
+
+/* PUBLIC API */
+
+struct android_app *GetAndroidApp(void)
+{
+    return &mockApp;
+}
+
+bool InitMockAndroid(void)
+{
+    if (!MakeTempDir(Mock.storageRoot, "storage") || !MakeTempDir(Mock.cacheRoot, "cache")) {
+        fprintf(stderr, "Failed to create the mock app directories\n");
+        return false;
+    }
+
+    atexit(RemoveMockDirs);
+
+    Mock.storagePath.name = Mock.storageRoot;
+    Mock.cachePath.name = Mock.cacheRoot;
+
+    return true;
+}
+
+const char *GetMockStorageDir(void)
+{
+    return Mock.storageRoot;
+}
+
+int GetMockJNICalls(void)
+{
+    return __atomic_load_n(&Mock.calls, __ATOMIC_RELAXED);
+}
+
+int GetMockMethodCalls(const char *name)
+{
+    MockMember *member = FindMember(Mock.methods, &Mock.methodCount, name);
+    return (member != NULL) ? __atomic_load_n(&member->calls, __ATOMIC_RELAXED) : 0;
+}
+
+bool GetMockBooleanField(const char *name)
+{
+    MockMember *member = FindMember(Mock.fields, &Mock.fieldCount, name);
+    return (member != NULL) && member->value;
+}
+
+void SetMockPackedStrings(const void *data, int size)
+{
+    pthread_mutex_lock(&packedMutex);
+
+    free(Mock.packedStrings.data);
+
+    Mock.packedStrings.data = malloc((size > 0) ? size : 1);
+    Mock.packedStrings.size = size;
+    memcpy(Mock.packedStrings.data, data, size);
+
+    pthread_mutex_unlock(&packedMutex);
+}
+
+void RecreateMockActivity(void)
+{
+    // NOTE: Never released, the objects of the previous activity may still be used
+    MockActivity *activity = calloc(1, sizeof(MockActivity));
+    if (activity == NULL) return;
+
+    activity->nativeLoader = (struct _jobject){ MOCK_INSTANCE, NULL, &Mock.nativeLoaderClass, activity };
+    activity->softKeyboard = (struct _jobject){ MOCK_INSTANCE, NULL, &Mock.softKeyboardClass };
+    activity->displayManager = (struct _jobject){ MOCK_INSTANCE, NULL, &Mock.displayManagerClass };
+
+    // The fields of the new objects are not set yet
+    pthread_mutex_lock(&memberMutex);
+    for (int i = 0; i < Mock.fieldCount; i++) Mock.fields[i].value = JNI_FALSE;
+    pthread_mutex_unlock(&memberMutex);
+
+    mockActivity.clazz = &activity->nativeLoader;
+}
+
+void SetMockStorageAvailable(bool available)
+{
+    Mock.storageUnavailable = !available;
+}
+
+void DestroyMockActivity(void)
+{
+    mockActivity.clazz = NULL;
+}
+
+jobject GetMockNativeLoader(void)
+{
+    return mockActivity.clazz;
+}
+
+int GetMockReplayedSensorEvents(Sensor sensor, float *lastValues)
+{
+    if ((int)sensor < 0 || (int)sensor >= MOCK_MAX_SENSORS) return 0;
+    if (lastValues != NULL) memcpy(lastValues, Mock.sensorValues[sensor], sizeof(Mock.sensorValues[sensor]));
+
+    return Mock.sensorEvents[sensor];
+}
+
+jbyteArray NewMockByteArray(const void *data, int size)
+{
+    jbyteArray array = NewArray(size, 1);
+    if (array != NULL) memcpy(array->data, data, size);
+
+    return array;
+}
+
+JNIEnv *GetMockJNIEnv(void)
+{
+    return &mockEnv;
+}
@@ -0,0 +1,113 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef RAYMOB_MOCK_ANDROID_H
+#define RAYMOB_MOCK_ANDROID_H
+
+/*
+ * Mock of the Java side of raymob (NativeLoader, SoftKeyboard, DisplayManager,
+ * java.io.File and the Vibrator), behind a JNIEnv that counts every call.
+ * Link it instead of raylib's android_main to run the Android modules on a host.
+ *
+ * NOTE: Every thread is reported as already attached to the mock VM.
+ */
+
+#include "raymob.h"
+
+/**
+ * @brief Creates the temporary directories returned by getExternalFilesDir() and getCacheDir().
+ *
+ * Must be called before the first raymob call, both are removed at exit.
+ *
+ * @return false if the directories could not be created.
+ */
+bool InitMockAndroid(void);
+
+/**
+ * @brief Returns the directory of the app specific storage.
+ */
+const char *GetMockStorageDir(void);
+
+/**
+ * @brief Number of JNIEnv functions called since the start, from every thread.
+ */
+int GetMockJNICalls(void);
+
+/**
+ * @brief Number of calls to a Java method, e.g. "showKeyboard".
+ */
+int GetMockMethodCalls(const char *name);
+
+/**
+ * @brief Value of a boolean field set by raymob, e.g. "nativeQueue".
+ */
+bool GetMockBooleanField(const char *name);
+
+/**
+ * @brief Sets the array returned by NativeLoader.getPackedStrings(), the data is copied.
+ */
+void SetMockPackedStrings(const void *data, int size);
+
+/**
+ * @brief Makes getExternalFilesDir() return null, as when the storage is not mounted.
+ */
+void SetMockStorageAvailable(bool available);
+
+/**
+ * @brief Replaces the activity by a new one, with its own SoftKeyboard and DisplayManager.
+ *
+ * As after a configuration change or a destroy in background, every boolean
+ * field is reset to false as for new Java objects.
+ */
+void RecreateMockActivity(void);
+
+/**
+ * @brief Removes the activity, as before the first one is created, until RecreateMockActivity().
+ */
+void DestroyMockActivity(void);
+
+/**
+ * @brief Returns the NativeLoader instance of the current activity.
+ */
+jobject GetMockNativeLoader(void);
+
+/**
+ * @brief Number of sensor events replayed so far, and the values of the last one.
+ *
+ * 'lastValues' may be NULL, otherwise it must hold 16 floats.
+ */
+int GetMockReplayedSensorEvents(Sensor sensor, float *lastValues);
+
+/**
+ * @brief Creates a byte[] to pass to the native methods, never released.
+ */
+jbyteArray NewMockByteArray(const void *data, int size);
+
+/**
+ * @brief Returns the JNIEnv of the mock VM.
+ */
+JNIEnv *GetMockJNIEnv(void);
+
+#endif //RAYMOB_MOCK_ANDROID_H
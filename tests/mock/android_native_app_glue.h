@@ -0,0 +1,79 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef RAYMOB_MOCK_ANDROID_NATIVE_APP_GLUE_H
+#define RAYMOB_MOCK_ANDROID_NATIVE_APP_GLUE_H
+
+/*
+ * Subset of android_native_app_glue.h used by raymob, for the host tests only.
+ */
+
+#include "jni.h"
+#include "android/native_window.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>      // NOTE: Reached through the NDK headers, raymob relies on it
+
+typedef struct ALooper ALooper;
+
+typedef struct ANativeActivity {
+    JavaVM *vm;
+    JNIEnv *env;
+    jobject clazz;                  // The NativeLoader instance, a global reference
+    const char *internalDataPath;
+    const char *externalDataPath;
+    int32_t sdkVersion;
+} ANativeActivity;
+
+enum {
+    APP_CMD_INPUT_CHANGED,
+    APP_CMD_INIT_WINDOW,
+    APP_CMD_TERM_WINDOW,
+    APP_CMD_WINDOW_RESIZED,
+    APP_CMD_WINDOW_REDRAW_NEEDED,
+    APP_CMD_CONTENT_RECT_CHANGED,
+    APP_CMD_GAINED_FOCUS,
+    APP_CMD_LOST_FOCUS,
+    APP_CMD_CONFIG_CHANGED,
+    APP_CMD_LOW_MEMORY,
+    APP_CMD_START,
+    APP_CMD_RESUME,
+    APP_CMD_SAVE_STATE,
+    APP_CMD_PAUSE,
+    APP_CMD_STOP,
+    APP_CMD_DESTROY,
+};
+
+struct android_app {
+    void *userData;
+    void (*onAppCmd)(struct android_app *app, int32_t cmd);
+    ANativeActivity *activity;
+    ALooper *looper;
+    ANativeWindow *window;
+};
+
+#endif //RAYMOB_MOCK_ANDROID_NATIVE_APP_GLUE_H
@@ -0,0 +1,143 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef RAYMOB_MOCK_JNI_H
+#define RAYMOB_MOCK_JNI_H
+
+/*
+ * Subset of jni.h used by raymob, for the host tests only.
+ *
+ * The function tables only hold the functions raymob calls, in any order,
+ * so this header is not ABI compatible with a real VM: both tables are
+ * filled by the mock Java side (android.c).
+ */
+
+#include <stdint.h>
+
+#define JNIEXPORT   __attribute__((visibility("default")))
+#define JNICALL
+
+#define JNI_FALSE   0
+#define JNI_TRUE    1
+
+#define JNI_OK          0
+#define JNI_ERR         (-1)
+#define JNI_EDETACHED   (-2)
+
+#define JNI_VERSION_1_6     0x00010006
+
+#define JNI_COMMIT  1
+#define JNI_ABORT   2
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+typedef struct _jobject *jobject;
+typedef jobject jclass;
+typedef jobject jstring;
+typedef jobject jthrowable;
+typedef jobject jarray;
+typedef jarray jbyteArray;
+typedef jarray jintArray;
+typedef jarray jlongArray;
+typedef jarray jfloatArray;
+
+typedef struct _jfieldID *jfieldID;
+typedef struct _jmethodID *jmethodID;
+
+typedef struct {
+    const char *name;
+    const char *signature;
+    void *fnPtr;
+} JNINativeMethod;
+
+typedef const struct JNINativeInterface *JNIEnv;
+typedef const struct JNIInvokeInterface *JavaVM;
+
+typedef struct {
+    jint version;
+    const char *name;
+    jobject group;
+} JavaVMAttachArgs;
+
+struct JNINativeInterface {
+
+    /* Classes, references and exceptions */
+
+    jclass (*FindClass)(JNIEnv *env, const char *name);
+    jclass (*GetObjectClass)(JNIEnv *env, jobject obj);
+    jobject (*NewGlobalRef)(JNIEnv *env, jobject obj);
+    void (*DeleteGlobalRef)(JNIEnv *env, jobject obj);
+    jobject (*NewLocalRef)(JNIEnv *env, jobject obj);
+    void (*DeleteLocalRef)(JNIEnv *env, jobject obj);
+    jboolean (*ExceptionCheck)(JNIEnv *env);
+    void (*ExceptionClear)(JNIEnv *env);
+    jint (*RegisterNatives)(JNIEnv *env, jclass clazz, const JNINativeMethod *methods, jint count);
+
+    /* Fields and methods */
+
+    jfieldID (*GetFieldID)(JNIEnv *env, jclass clazz, const char *name, const char *sig);
+    jobject (*GetObjectField)(JNIEnv *env, jobject obj, jfieldID field);
+    void (*SetBooleanField)(JNIEnv *env, jobject obj, jfieldID field, jboolean value);
+
+    jmethodID (*GetMethodID)(JNIEnv *env, jclass clazz, const char *name, const char *sig);
+    jmethodID (*GetStaticMethodID)(JNIEnv *env, jclass clazz, const char *name, const char *sig);
+    jobject (*CallObjectMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+    jboolean (*CallBooleanMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+    jint (*CallIntMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+    void (*CallVoidMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+    jobject (*CallStaticObjectMethod)(JNIEnv *env, jclass clazz, jmethodID method, ...);
+
+    /* Strings and arrays */
+
+    jstring (*NewStringUTF)(JNIEnv *env, const char *chars);
+    const char *(*GetStringUTFChars)(JNIEnv *env, jstring string, jboolean *isCopy);
+    void (*ReleaseStringUTFChars)(JNIEnv *env, jstring string, const char *chars);
+
+    jsize (*GetArrayLength)(JNIEnv *env, jarray array);
+    void (*GetByteArrayRegion)(JNIEnv *env, jbyteArray array, jsize start, jsize length, jbyte *buffer);
+    void (*GetFloatArrayRegion)(JNIEnv *env, jfloatArray array, jsize start, jsize length, jfloat *buffer);
+    jintArray (*NewIntArray)(JNIEnv *env, jsize length);
+    jint *(*GetIntArrayElements)(JNIEnv *env, jintArray array, jboolean *isCopy);
+    void (*ReleaseIntArrayElements)(JNIEnv *env, jintArray array, jint *elements, jint mode);
+    jlongArray (*NewLongArray)(JNIEnv *env, jsize length);
+    jlong *(*GetLongArrayElements)(JNIEnv *env, jlongArray array, jboolean *isCopy);
+    void (*ReleaseLongArrayElements)(JNIEnv *env, jlongArray array, jlong *elements, jint mode);
+};
+
+struct JNIInvokeInterface {
+    jint (*AttachCurrentThread)(JavaVM *vm, JNIEnv **env, void *args);
+    jint (*DetachCurrentThread)(JavaVM *vm);
+    jint (*GetEnv)(JavaVM *vm, void **env, jint version);
+};
+
+#endif //RAYMOB_MOCK_JNI_H
@@ -0,0 +1,90 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Definitions of the raylib functions declared by the mock raylib.h.
+ */
+
+#include "raylib.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+static int logLevel = LOG_WARNING;
+static TraceLogCallback logCallback = NULL;
+
+static int drawingCalls = 0;
+
+void TraceLog(int level, const char *text, ...)
+{
+    if (level < logLevel) return;
+
+    va_list args;
+    va_start(args, text);
+
+    if (logCallback != NULL) {
+        logCallback(level, text, args);
+        va_end(args);
+        return;
+    }
+
+    vfprintf(stderr, text, args);
+    va_end(args);
+
+    fputc('\n', stderr);
+}
+
+void SetTraceLogLevel(int level)
+{
+    logLevel = level;
+}
+
+void SetTraceLogCallback(TraceLogCallback callback)
+{
+    logCallback = callback;
+}
+
+void BeginDrawing(void)
+{
+    drawingCalls++;
+}
+
+void EndDrawing(void)
+{
+    drawingCalls++;
+}
+
+int GetMockDrawingCalls(void)
+{
+    return drawingCalls;
+}
+
+double GetTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec*1e-9;
+}
@@ -0,0 +1,70 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef RAYMOB_MOCK_RAYLIB_H
+#define RAYMOB_MOCK_RAYLIB_H
+
+/*
+ * Subset of raylib.h used by the raymob modules built by the host tests,
+ * the raylib submodule is not needed (see raylib.c for the definitions).
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define RL_MALLOC(sz)       malloc(sz)
+#define RL_CALLOC(n,sz)     calloc(n,sz)
+#define RL_REALLOC(ptr,sz)  realloc(ptr,sz)
+#define RL_FREE(ptr)        free(ptr)
+
+typedef struct Vector2 { float x, y; } Vector2;
+typedef struct Vector3 { float x, y, z; } Vector3;
+typedef struct Vector4 { float x, y, z, w; } Vector4;
+typedef Vector4 Quaternion;
+
+typedef enum {
+    LOG_ALL = 0,
+    LOG_TRACE,
+    LOG_DEBUG,
+    LOG_INFO,
+    LOG_WARNING,
+    LOG_ERROR,
+    LOG_FATAL,
+    LOG_NONE
+} TraceLogLevel;
+
+typedef void (*TraceLogCallback)(int logLevel, const char *text, va_list args);
+
+void TraceLog(int logLevel, const char *text, ...);
+void SetTraceLogLevel(int logLevel);
+void SetTraceLogCallback(TraceLogCallback callback);
+double GetTime(void);
+
+// NOTE: Only count their calls, see GetMockDrawingCalls()
+void BeginDrawing(void);
+void EndDrawing(void);
+int GetMockDrawingCalls(void);
+
+#endif //RAYMOB_MOCK_RAYLIB_H
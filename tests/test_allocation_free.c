@@ -0,0 +1,170 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks that the ...Into() variants make no allocation once warmed up,
+ * and that they behave like snprintf() when the buffer is too small.
+ *
+ * NOTE: Allocations are counted by wrapping the glibc allocator, which
+ *       the sanitizers replace, so the test is skipped under them.
+ */
+
+#include "raymob.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <limits.h>
+#include <string.h>
+
+#define STEADY_ITERATIONS   1000
+#define SKIP_RETURN_CODE    77
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    #define ALLOCATIONS_COUNTED     0
+#elif defined(__GLIBC__)
+    #define ALLOCATIONS_COUNTED     1
+#else
+    #define ALLOCATIONS_COUNTED     0
+#endif
+
+#if ALLOCATIONS_COUNTED
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static int allocations = 0;
+
+void *malloc(size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+static int GetAllocations(void)
+{
+    return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+
+// One frame of a HUD using every allocation-free variant
+static int RunFrame(char *path, char *text, unsigned char *save)
+{
+    int total = 0;
+
+    total += GetCacheDirInto(path, PATH_MAX);
+    total += GetAppStoragePathInto(path, PATH_MAX);
+    total += JoinAppStoragePath(path, PATH_MAX, "save.bin");
+    total += JoinCacheDirPath(path, PATH_MAX, "cache.txt");
+    total += ReadFromAppStorageInto("save.bin", save, 64);
+    total += LoadCacheFileInto("cache.txt", text, 64);
+    total += GetL10NStringInto("score", text, 64);
+    total += GetL10NStringInto("title", text, 64);
+
+    return total;
+}
+
+int main(void)
+{
+    if (!InitMockAndroid()) return 1;
+
+    static const char packed[] = "title\0Caf\xC3\xA9 Raymob\0score\0Score\0";
+    SetMockPackedStrings(packed, sizeof(packed) - 1);
+
+    unsigned char save[64] = { 1, 2, 3, 4 };
+    CHECK(WriteToAppStorageAtomic("save.bin", save, sizeof(save)));
+
+    char path[PATH_MAX];
+    char text[64];
+
+    CHECK(JoinCacheDirPath(path, sizeof(path), "cache.txt") > 0);
+
+    FILE *file = fopen(path, "w");
+    CHECK(file != NULL);
+    if (file != NULL) {
+        fputs("cached", file);
+        fclose(file);
+    }
+
+    // Warm up, the directories and the strings are loaded on first use
+    int expected = RunFrame(path, text, save);
+
+    int before = GetAllocations();
+
+    for (int i = 0; i < STEADY_ITERATIONS; i++) {
+        if (RunFrame(path, text, save) != expected) {
+            CHECK(false);
+            break;
+        }
+    }
+
+    int steady = GetAllocations() - before;
+    printf("%d allocations over %d frames\n", steady, STEADY_ITERATIONS);
+    CHECK(steady == 0);
+
+    // The wrappers still allocate, which shows the counter works
+    before = GetAllocations();
+    char *title = GetL10NString("title");
+    CHECK(GetAllocations() > before);
+    CHECK(title != NULL && strcmp(title, "Caf\xC3\xA9 Raymob") == 0);
+    free(title);
+
+    // snprintf() semantics, never cutting a UTF-8 sequence in half
+
+    int length = (int)strlen("Caf\xC3\xA9 Raymob");
+
+    CHECK(GetL10NStringInto("title", NULL, 0) == length);
+    CHECK(GetL10NStringInto("title", text, sizeof(text)) == length && strcmp(text, "Caf\xC3\xA9 Raymob") == 0);
+    CHECK(GetL10NStringInto("title", text, 5) == length && strcmp(text, "Caf") == 0);
+    CHECK(GetL10NStringInto("title", text, 6) == length && strcmp(text, "Caf\xC3\xA9") == 0);
+    CHECK(GetL10NStringInto("missing", text, sizeof(text)) == -1);
+
+    char cacheDir[PATH_MAX];
+    int cacheLength = GetCacheDirInto(cacheDir, sizeof(cacheDir));
+    CHECK(GetCacheDirInto(path, 4) == cacheLength && strlen(path) == 3 && strncmp(path, cacheDir, 3) == 0);
+
+    return TEST_RESULT();
+}
+
+#else
+
+int main(void)
+{
+    printf("Allocations can only be counted with glibc, without sanitizer\n");
+    return SKIP_RETURN_CODE;
+}
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks that the bridge resolves the Java side once, that the public
+ * functions then only pay for the Java call they actually need, and that
+ * the bridge follows the activity when it is recreated.
+ */
+
+#include "raymob.h"
+#include "bridge.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define KEYCODE_A   29
+
+// Checks the number of JNI calls made by a statement
+#define CHECK_JNI_CALLS(expected, statement) do {                               \
+    int before = GetMockJNICalls();                                             \
+    statement;                                                                  \
+    int calls = GetMockJNICalls() - before;                                     \
+    if (calls != (expected)) {                                                  \
+        fprintf(stderr, "%s:%d: %s made %d JNI calls, expected %d\n",           \
+                __FILE__, __LINE__, #statement, calls, (expected));             \
+        testFailures++;                                                         \
+    }                                                                           \
+} while (0)
+
+int main(void)
+{
+    if (!InitMockAndroid()) return 1;
+
+    // Nothing is resolved before the activity exists, and nothing is lost by asking too early
+
+    DestroyMockActivity();
+    CHECK(GetBridge() == NULL);
+    CHECK_JNI_CALLS(0, GetScreenOrientation());
+    RecreateMockActivity();
+
+    // Resolved once, with the natives registered and Java told about it
+
+    int before = GetMockJNICalls();
+    CHECK(GetBridge() != NULL);
+    CHECK(GetMockJNICalls() > before);
+
+    CHECK(GetMockBooleanField("nativeBridge"));
+    CHECK(GetMockBooleanField("nativeQueue"));
+    CHECK(GetMockBooleanField("nativeDisplay"));
+
+    CHECK_JNI_CALLS(0, GetBridge());
+
+    // One crossing per Java method called
+
+    CHECK_JNI_CALLS(1, ShowSoftKeyboard());
+    CHECK_JNI_CALLS(1, HideSoftKeyboard());
+    CHECK_JNI_CALLS(1, SetSoftKeyboardTextInput(true));
+    CHECK_JNI_CALLS(1, KeepScreenOn(true));
+
+    CHECK(GetMockMethodCalls("showKeyboard") == 1);
+    CHECK(GetMockMethodCalls("keepScreenOn") == 1);
+
+    // An unavailable storage is asked for again until it is available
+
+    SetMockStorageAvailable(false);
+    CHECK(GetAppStoragePath() == NULL);
+    CHECK(GetAppStoragePath() == NULL);
+    CHECK(GetMockMethodCalls("getExternalFilesDir") == 2);
+
+    SetMockStorageAvailable(true);
+    char *storageDir = GetAppStoragePath();
+    CHECK(storageDir != NULL && GetMockMethodCalls("getExternalFilesDir") == 3);
+    free(storageDir);
+
+    // Only the first successful call asks Java for the directories
+
+    char *cacheDir = GetCacheDir();
+    CHECK(cacheDir != NULL);
+    free(cacheDir);
+
+    CHECK_JNI_CALLS(0, cacheDir = GetCacheDir());
+    free(cacheDir);
+
+    char *storagePath = NULL;
+    CHECK_JNI_CALLS(0, storagePath = GetAppStoragePath());
+    CHECK(storagePath != NULL && strcmp(storagePath, GetMockStorageDir()) == 0);
+    free(storagePath);
+
+    // Keys and display state are pushed by Java, reading them is free
+
+    JNIEnv *env = GetMockJNIEnv();
+    OnSoftKeyEvent(env, NULL, KEYCODE_A, 'a', 'A', 1000);
+
+    char key = 0;
+    CHECK_JNI_CALLS(0, key = GetLastSoftKeyChar());
+    CHECK(key == 'a');
+
+    SoftKeyEvent events[4];
+    int count = 0;
+    CHECK_JNI_CALLS(0, count = PollSoftKeyEvents(events, 4));
+    CHECK(count == 1 && events[0].keyCode == KEYCODE_A && events[0].label == 'A');
+
+    // NOTE: The first call starts the display listener, then the orientation
+    //       is asked to Java until the first state is pushed
+    CHECK_JNI_CALLS(2, GetScreenOrientation());
+    CHECK_JNI_CALLS(1, GetScreenOrientation());
+    CHECK(GetMockMethodCalls("startListening") == 1);
+
+    OnDisplayState(env, NULL, 1, 60.0f, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    Orientation orientation = ORIENTATION_OTHER;
+    CHECK_JNI_CALLS(0, orientation = GetScreenOrientation());
+    CHECK(orientation == ORIENTATION_LANDSCAPE);
+
+    // A recreated activity gets a new bridge, with the same classes and IDs,
+    // and its own objects are told that the natives are registered
+
+    const RaymobBridge *first = GetBridge();
+    unsigned int generation = first->generation;
+    jmethodID showKeyboard = first->showKeyboard;
+
+    RecreateMockActivity();
+    CHECK(!GetMockBooleanField("nativeQueue"));
+
+    const RaymobBridge *second = GetBridge();
+
+    CHECK(second != NULL && second != first && second->generation == generation + 1);
+    CHECK(second->nativeLoader == GetMockNativeLoader());
+    CHECK(second->showKeyboard == showKeyboard);
+    CHECK(GetMockBooleanField("nativeBridge"));
+    CHECK(GetMockBooleanField("nativeQueue"));
+    CHECK(GetMockBooleanField("nativeDisplay"));
+
+    CHECK_JNI_CALLS(0, GetBridge());
+    CHECK_JNI_CALLS(1, ShowSoftKeyboard());
+
+    // The new DisplayManager is started as well, the last state is kept until it pushes one
+    CHECK_JNI_CALLS(1, orientation = GetScreenOrientation());
+    CHECK(GetMockMethodCalls("startListening") == 2 && orientation == ORIENTATION_LANDSCAPE);
+    CHECK_JNI_CALLS(0, GetScreenOrientation());
+
+    // The slot of the activity before the previous one is reused
+
+    RecreateMockActivity();
+
+    const RaymobBridge *third = GetBridge();
+    CHECK(third == first && third->generation == generation + 2);
+    CHECK(third->nativeLoader == GetMockNativeLoader());
+
+    return TEST_RESULT();
+}
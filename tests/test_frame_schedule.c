@@ -0,0 +1,236 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks the vsync divisor and deadline math, then drives the frame schedule
+ * with a simulated vsync clock and game work, and checks that frames are
+ * presented at a steady interval without missing their deadline.
+ */
+
+#include "frame_schedule.h"
+#include "test.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define SIMULATED_FRAMES    20000
+#define VSYNC_JITTER_NS     200000LL        // Of the reported vsync timestamps
+#define START_TIME_NS       1000000000LL
+#define MAX_MISSED_FRAMES   (SIMULATED_FRAMES/100)  // The work estimate decays, a slow frame after a fast run can be late
+
+typedef struct SimulationResult {
+    double meanInterval;    // Between two presented frames, in ms
+    double deviation;       // Standard deviation of the interval, in ms
+    int missed;             // Frames presented after their deadline
+} SimulationResult;
+
+static uint32_t randomState = 1;
+
+static double GetRandom(void)
+{
+    // NOTE: xorshift32, the simulation must be the same on every host
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState/4294967296.0;
+}
+
+static int64_t GetPeriod(double refreshRate)
+{
+    return (int64_t)(1e9/refreshRate);
+}
+
+static int GetDivisor(int targetFPS, double refreshRate)
+{
+    VsyncClock clock;
+    InitVsyncClock(&clock, GetPeriod(refreshRate));
+
+    FrameSchedule schedule = { 0 };
+    SetFrameScheduleTarget(&schedule, targetFPS);
+    ScheduleNextFrame(&schedule, &clock, START_TIME_NS);
+
+    return schedule.divisor;
+}
+
+// Frames are presented on the first vsync after their work is done, the clock
+// only sees the vsyncs up to the current time, with jitter
+static SimulationResult Simulate(double refreshRate, int targetFPS, double minWork, double maxWork, int spikePeriod)
+{
+    int64_t period = GetPeriod(refreshRate);
+
+    VsyncClock clock;
+    InitVsyncClock(&clock, 0);
+
+    FrameSchedule schedule = { 0 };
+    SetFrameScheduleTarget(&schedule, targetFPS);
+
+    int64_t now = START_TIME_NS;
+    int64_t nextVsync = START_TIME_NS;
+    int64_t lastPresent = 0;
+
+    double sum = 0.0, sumSquares = 0.0;
+    int intervals = 0;
+    int missed = 0;
+
+    for (int i = 0; i < SIMULATED_FRAMES; i++) {
+        for (; nextVsync <= now; nextVsync += period) {
+            UpdateVsyncClock(&clock, nextVsync + (int64_t)((GetRandom() - 0.5)*VSYNC_JITTER_NS));
+        }
+
+        int64_t start = ScheduleNextFrame(&schedule, &clock, now);
+        CHECK(start >= now);
+
+        for (; nextVsync <= start; nextVsync += period) {
+            UpdateVsyncClock(&clock, nextVsync + (int64_t)((GetRandom() - 0.5)*VSYNC_JITTER_NS));
+        }
+
+        double work = (minWork + (maxWork - minWork)*GetRandom())*1e6;
+        if (spikePeriod > 0 && i%spikePeriod == 0) work *= 3;
+
+        int64_t done = start + (int64_t)work;
+        int64_t present = START_TIME_NS + (done - START_TIME_NS + period - 1)/period*period;
+
+        if (present > schedule.deadline + period/2) missed++;
+
+        if (lastPresent != 0) {
+            double interval = (present - lastPresent)/1e6;
+            sum += interval;
+            sumSquares += interval*interval;
+            intervals++;
+        }
+
+        lastPresent = present;
+        now = done;
+    }
+
+    SimulationResult result = { 0 };
+    result.meanInterval = sum/intervals;
+    result.deviation = sqrt(sumSquares/intervals - result.meanInterval*result.meanInterval);
+    result.missed = missed;
+
+    return result;
+}
+
+static void TestDivisor(void)
+{
+    CHECK(GetDivisor(60, 60.0) == 1);
+    CHECK(GetDivisor(60, 120.0) == 2);
+    CHECK(GetDivisor(60, 90.0) == 2);       // 45 FPS rather than above the target
+    CHECK(GetDivisor(120, 120.0) == 1);
+    CHECK(GetDivisor(30, 60.0) == 2);
+    CHECK(GetDivisor(30, 120.0) == 4);
+    CHECK(GetDivisor(58, 60.0) == 1);       // Within the tolerance
+    CHECK(GetDivisor(0, 120.0) == 1);
+    CHECK(GetDivisor(240, 60.0) == 1);
+}
+
+static void TestVsyncClock(void)
+{
+    VsyncClock clock;
+    InitVsyncClock(&clock, 0);
+    CHECK(clock.period == FRAME_DEFAULT_VSYNC_PERIOD);
+
+    // Follows a refresh rate change within a few frames, missed vsyncs included
+
+    int64_t period = GetPeriod(120.0);
+    int64_t time = START_TIME_NS;
+
+    for (int i = 0; i < 60; i++) {
+        UpdateVsyncClock(&clock, time);
+        time += (i%5 == 4) ? 3*period : period;
+    }
+
+    CHECK(llabs(clock.period - period) < 10000);
+
+    // Going down as well, and older timestamps are ignored
+
+    // NOTE: Not to 60Hz, half the rate looks the same as every other vsync missed
+    period = GetPeriod(90.0);
+    for (int i = 0; i < 60; i++) {
+        UpdateVsyncClock(&clock, time);
+        time += period;
+    }
+
+    UpdateVsyncClock(&clock, time - 5*period);
+
+    CHECK(llabs(clock.period - period) < 10000);
+    CHECK(clock.time == time - period);
+
+    // The next vsync is on the estimated grid, a time on a vsync is that vsync
+
+    int64_t last = clock.time;
+    CHECK(GetNextVsync(&clock, last - 1) == last);
+    CHECK(GetNextVsync(&clock, last) == last);
+    CHECK(GetNextVsync(&clock, last + 1) == last + clock.period);
+    CHECK(GetNextVsync(&clock, last + clock.period) == last + clock.period);
+}
+
+static void TestSchedule(void)
+{
+    const struct {
+        double refreshRate;
+        int targetFPS;
+        double minWork, maxWork;    // In ms
+        double interval;            // Expected, in ms
+    } cases[] = {
+        { 60.0, 60, 3.0, 8.0, 1000.0/60 },
+        { 120.0, 60, 3.0, 8.0, 1000.0/60 },
+        { 120.0, 120, 2.0, 5.0, 1000.0/120 },
+        { 90.0, 60, 3.0, 8.0, 1000.0/45 },
+        { 60.0, 30, 5.0, 12.0, 1000.0/30 },
+        { 120.0, 0, 2.0, 5.0, 1000.0/120 },
+    };
+
+    for (int i = 0; i < (int)(sizeof(cases)/sizeof(cases[0])); i++) {
+        SimulationResult result = Simulate(cases[i].refreshRate, cases[i].targetFPS, cases[i].minWork, cases[i].maxWork, 0);
+
+        printf("%3.0f Hz, target %3d FPS, work %2.0f-%2.0f ms: interval %.2f ms (deviation %.3f ms), %d/%d missed\n",
+               cases[i].refreshRate, cases[i].targetFPS, cases[i].minWork, cases[i].maxWork,
+               result.meanInterval, result.deviation, result.missed, SIMULATED_FRAMES);
+
+        CHECK(fabs(result.meanInterval - cases[i].interval) < 0.05);
+        CHECK(result.deviation < cases[i].interval/10);
+        CHECK(result.missed <= MAX_MISSED_FRAMES);
+    }
+
+    // Spikes of three times the usual work, late themselves but without disturbing the others
+
+    SimulationResult result = Simulate(120.0, 60, 3.0, 8.0, 500);
+
+    printf("120 Hz, target  60 FPS, work  3- 8 ms with spikes: interval %.2f ms, %d/%d missed\n",
+           result.meanInterval, result.missed, SIMULATED_FRAMES);
+
+    CHECK(result.missed <= MAX_MISSED_FRAMES + SIMULATED_FRAMES/500);
+    CHECK(fabs(result.meanInterval - 1000.0/60) < 0.5);
+}
+
+int main(void)
+{
+    TestDivisor();
+    TestVsyncClock();
+    TestSchedule();
+
+    return TEST_RESULT();
+}
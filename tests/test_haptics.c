@@ -0,0 +1,169 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks the haptics queue with a recording executor: commands are executed
+ * in order, one-shots close in time are merged, and the redundant ones dropped.
+ */
+
+#include "haptics.h"
+#include "test.h"
+
+#include <sched.h>
+#include <string.h>
+
+#define MAX_EXECUTED        256
+#define WINDOW              HAPTIC_COALESCE_WINDOW_NS
+#define MS                  1000000LL
+
+static HapticCommand executed[MAX_EXECUTED];
+static int executedCount = 0;       // Atomic, written by the worker
+
+static void RecordCommand(const HapticCommand *command)
+{
+    int index = __atomic_load_n(&executedCount, __ATOMIC_RELAXED);
+
+    if (index < MAX_EXECUTED) {
+        executed[index] = *command;
+        __atomic_store_n(&executedCount, index + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static HapticCommand OneShot(int64_t timestamp, int64_t duration, int amplitude)
+{
+    return (HapticCommand){ .type = HAPTIC_ONE_SHOT, .timestamp = timestamp, .duration = duration, .amplitude = amplitude };
+}
+
+static HapticCommand Pattern(int64_t timestamp, unsigned int pattern)
+{
+    return (HapticCommand){ .type = HAPTIC_PATTERN, .timestamp = timestamp, .pattern = pattern };
+}
+
+static HapticCommand Cancel(int64_t timestamp)
+{
+    return (HapticCommand){ .type = HAPTIC_CANCEL, .timestamp = timestamp };
+}
+
+static int Execute(const HapticCommand *commands, int count)
+{
+    HapticCommand last = { 0 };
+    executedCount = 0;
+
+    return ExecuteHapticCommands(commands, count, &last, RecordCommand);
+}
+
+static void TestCoalescing(void)
+{
+    // One-shots inside the window are merged, keeping the longest and the strongest
+
+    const HapticCommand burst[] = {
+        OneShot(1000*MS, 10, 100), OneShot(1005*MS, 30, 50), OneShot(1015*MS, 20, 200),
+        OneShot(1100*MS, 10, 80)
+    };
+
+    CHECK(Execute(burst, 4) == 2);
+    CHECK(executed[0].duration == 30 && executed[0].amplitude == 200 && executed[0].timestamp == 1000*MS);
+    CHECK(executed[1].duration == 10 && executed[1].amplitude == 80);
+
+    // The window starts at the first one-shot, it does not slide
+
+    const HapticCommand chain[] = { OneShot(MS, 10, 100), OneShot(15*MS, 10, 100), OneShot(25*MS, 10, 100) };
+    CHECK(Execute(chain, 3) == 2);
+
+    // The default amplitude is the strongest
+
+    const HapticCommand defaults[] = { OneShot(MS, 10, 200), OneShot(2*MS, 10, HAPTIC_DEFAULT_AMPLITUDE) };
+    CHECK(Execute(defaults, 2) == 1 && executed[0].amplitude == HAPTIC_DEFAULT_AMPLITUDE);
+
+    // Across batches, a repeat that is neither longer nor stronger is dropped
+
+    HapticCommand last = { 0 };
+    HapticCommand first = OneShot(MS, 20, 100), weaker = OneShot(10*MS, 20, 90), stronger = OneShot(15*MS, 20, 150);
+
+    executedCount = 0;
+    CHECK(ExecuteHapticCommands(&first, 1, &last, RecordCommand) == 1);
+    CHECK(ExecuteHapticCommands(&weaker, 1, &last, RecordCommand) == 0);
+    CHECK(ExecuteHapticCommands(&stronger, 1, &last, RecordCommand) == 1);
+    CHECK(executedCount == 2 && executed[1].amplitude == 150);
+
+    // A pattern replayed within the window is only played once, another one is played
+
+    const HapticCommand patterns[] = { Pattern(MS, 1), Pattern(5*MS, 1), Pattern(6*MS, 2), Pattern(6*MS + WINDOW, 2) };
+    CHECK(Execute(patterns, 4) == 3);
+    CHECK(executed[0].pattern == 1 && executed[1].pattern == 2 && executed[2].pattern == 2);
+
+    // A cancel is never merged, and the one-shots on both sides of it are kept
+
+    const HapticCommand cancelled[] = { OneShot(MS, 50, 100), Cancel(2*MS), OneShot(3*MS, 50, 100) };
+    CHECK(Execute(cancelled, 3) == 3);
+    CHECK(executed[0].type == HAPTIC_ONE_SHOT && executed[1].type == HAPTIC_CANCEL && executed[2].type == HAPTIC_ONE_SHOT);
+
+    const HapticCommand cancels[] = { Cancel(MS), Cancel(2*MS) };
+    CHECK(Execute(cancels, 2) == 2);
+}
+
+static void TestQueue(void)
+{
+    // Commands pushed from the game thread are executed in order by the worker
+
+    executedCount = 0;
+    CHECK(StartHaptics(RecordCommand));
+
+    const int count = 100;
+    int pushed = 0;
+
+    for (int i = 0; i < count; i++) {
+        // Spaced by the window, none of them is merged
+        HapticCommand command = (i%3 == 2) ? Cancel((i + 1)*WINDOW) : OneShot((i + 1)*WINDOW, i + 1, 100);
+
+        // NOTE: Retried when full, the worker may not have caught up yet
+        while (!PushHapticCommand(command)) sched_yield();
+        pushed++;
+    }
+
+    while (__atomic_load_n(&executedCount, __ATOMIC_ACQUIRE) < pushed) sched_yield();
+
+    bool ordered = true;
+    for (int i = 0; i < count; i++) ordered &= executed[i].timestamp == (i + 1)*WINDOW;
+
+    CHECK(ordered);
+    CHECK(executedCount == count);
+
+    // The timestamp is set on push when missing
+
+    HapticCommand command = OneShot(0, 5, 100);
+    CHECK(PushHapticCommand(command));
+
+    while (__atomic_load_n(&executedCount, __ATOMIC_ACQUIRE) < count + 1) sched_yield();
+    CHECK(executed[count].timestamp != 0);
+}
+
+int main(void)
+{
+    TestCoalescing();
+    TestQueue();
+
+    return TEST_RESULT();
+}
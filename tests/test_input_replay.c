@@ -0,0 +1,275 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Records sensor samples and soft keys, then replays the recording in fixed
+ * steps and checks that every event comes back in order, in the step of its
+ * timestamp, with the exact recorded values and timestamp.
+ */
+
+#include "raymob.h"
+#include "bridge.h"
+#include "input_record.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SAMPLE_COUNT        100
+#define SAMPLE_PERIOD_NS    5000000LL       // 200 Hz
+#define BATCH_SIZE          10              // Samples of each sensor delivered at once, as by the NDK
+#define FRAME_TIME          (1.0f/64)       // Exact in ns, so that the expected steps are exact too
+#define FRAME_TIME_NS       15625000LL
+
+#define KEYCODE_A           29
+
+#define STREAM_COUNT        10000           // More than the recorder ring holds, so drained while recording
+#define STREAM_BATCH        1000
+
+static int64_t GetClockTime(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (int64_t)now.tv_sec*1000000000LL + now.tv_nsec;
+}
+
+static void RecordSample(Sensor sensor, int64_t timestamp, float x, float y, float z)
+{
+    InputRecord record = { .kind = INPUT_RECORD_SENSOR, .id = (unsigned char)sensor, .count = 3, .timestamp = timestamp };
+
+    record.values[0] = x;
+    record.values[1] = y;
+    record.values[2] = z;
+
+    RecordInput(&record);
+}
+
+static void TestFormat(void)
+{
+    // Deltas of any sign and size, including the worst case varint
+
+    const int64_t timestamps[] = { 0, 1, -1, 5000000, 1000000000000LL, -1000000000000LL, INT64_MAX/2, INT64_MIN/2 };
+    const int count = sizeof(timestamps)/sizeof(timestamps[0]);
+
+    unsigned char data[INPUT_RECORD_MAX_SIZE];
+    int64_t previous = 0;
+
+    for (int i = 0; i < count; i++) {
+        InputRecord record = { .kind = INPUT_RECORD_SENSOR, .id = SENSOR_GYROSCOPE, .count = INPUT_RECORD_MAX_VALUES, .timestamp = timestamps[i] };
+        for (int j = 0; j < INPUT_RECORD_MAX_VALUES; j++) record.values[j] = (float)(i*j) - 0.5f;
+
+        int size = EncodeInputRecord(&record, previous, data);
+
+        InputRecord decoded = { 0 };
+        CHECK(DecodeInputRecord(data, size, previous, &decoded) == size);
+        CHECK(decoded.kind == record.kind && decoded.id == record.id && decoded.count == record.count);
+        CHECK(decoded.timestamp == record.timestamp);
+        CHECK(memcmp(decoded.values, record.values, sizeof(record.values)) == 0);
+
+        // Any truncation is detected
+        CHECK(DecodeInputRecord(data, size - 1, previous, &decoded) == -1);
+
+        previous = timestamps[i];
+    }
+}
+
+static void TestRoundTrip(void)
+{
+    SoftKeyEvent events[8];
+
+    // Recording, sensors are batched independently so their timestamps go back and forth,
+    // and the samples are one second old as with the NDK, so the clear recorded now comes last
+
+    CHECK(StartInputRecording("input.rmir"));
+    CHECK(!StartInputRecording("other.rmir"));
+
+    int64_t start = GetClockTime(CLOCK_BOOTTIME) - 1000000000LL;
+    int64_t startUptimeMillis = GetClockTime(CLOCK_MONOTONIC)/1000000 - 1000;
+
+    for (int batch = 0; batch < SAMPLE_COUNT/BATCH_SIZE; batch++) {
+        for (int i = batch*BATCH_SIZE; i < (batch + 1)*BATCH_SIZE; i++) {
+            RecordSample(SENSOR_ACCELEROMETER, start + i*SAMPLE_PERIOD_NS, (float)i, (float)-i, 9.81f);
+        }
+        for (int i = batch*BATCH_SIZE; i < (batch + 1)*BATCH_SIZE; i++) {
+            RecordSample(SENSOR_GYROSCOPE, start + i*SAMPLE_PERIOD_NS + SAMPLE_PERIOD_NS/2, 0.01f*i, 0.0f, 0.0f);
+        }
+
+        // A key typed 100 ms after the start, recorded before the samples of the following
+        // batches but after the ones it precedes, and the last key cleared later
+        if (batch == 1) OnSoftKeyEvent(GetMockJNIEnv(), NULL, KEYCODE_A, 'a', 'A', startUptimeMillis + 100);
+        if (batch == 5) ClearLastSoftKey();
+    }
+
+    CHECK(StopInputRecording());
+    CHECK(!StopInputRecording());
+
+    // The live key went through as usual
+    CHECK(PollSoftKeyEvents(events, 8) == 1);
+    int64_t keyTimestamp = events[0].timestamp;
+
+    // Replay in fixed steps, the records are sorted when saved so each
+    // sample and key is applied in the step of its timestamp
+
+    CHECK(LoadInputReplay("input.rmir"));
+    CHECK(IsInputReplayActive() && !IsInputReplayFinished());
+
+    // Live input is ignored during the replay
+    OnSoftKeyEvent(GetMockJNIEnv(), NULL, KEYCODE_A, 'b', 'B', startUptimeMillis);
+    CHECK(PollSoftKeyEvents(events, 8) == 0);
+
+    int applied = 0;
+    int keyFrame = -1;
+    float values[16];
+
+    for (int frame = 1; !IsInputReplayFinished() && frame < 1000; frame++) {
+        applied += UpdateInputReplay(FRAME_TIME);
+
+        int64_t cursor = frame*FRAME_TIME_NS;
+        int expected = (int)(cursor/SAMPLE_PERIOD_NS) + 1;
+        if (expected > SAMPLE_COUNT) expected = SAMPLE_COUNT;
+
+        int accelerometer = GetMockReplayedSensorEvents(SENSOR_ACCELEROMETER, values);
+        CHECK(accelerometer == expected);
+        CHECK(values[0] == (float)(accelerometer - 1) && values[1] == (float)(1 - accelerometer) && values[2] == 9.81f);
+
+        int gyroscope = GetMockReplayedSensorEvents(SENSOR_GYROSCOPE, values);
+        expected = (int)((cursor - SAMPLE_PERIOD_NS/2)/SAMPLE_PERIOD_NS) + 1;
+        CHECK(gyroscope == ((expected < SAMPLE_COUNT) ? expected : SAMPLE_COUNT));
+
+        int keys = PollSoftKeyEvents(events, 8);
+
+        if (keys > 0) {
+            CHECK(keys == 1 && keyFrame == -1);
+            CHECK(events[0].keyCode == KEYCODE_A && events[0].unicode == 'a' && events[0].label == 'A');
+            CHECK(events[0].timestamp == keyTimestamp);
+            keyFrame = frame;
+        }
+    }
+
+    // 100 ms is between the 6th and the 7th steps
+    CHECK(keyFrame == 7);
+    CHECK(IsInputReplayFinished());
+    CHECK(applied == 2*SAMPLE_COUNT + 2);
+
+    CHECK(GetMockReplayedSensorEvents(SENSOR_GYROSCOPE, values) == SAMPLE_COUNT);
+    CHECK(values[0] == 0.01f*(SAMPLE_COUNT - 1));
+    CHECK(GetLastSoftKeyChar() == '\0');
+
+    // Same input when replayed again, whatever the steps
+
+    CHECK(LoadInputReplay("input.rmir"));
+    CHECK(UpdateInputReplay(10.0f) == 2*SAMPLE_COUNT + 2);
+    CHECK(IsInputReplayFinished());
+    CHECK(GetMockReplayedSensorEvents(SENSOR_ACCELEROMETER, NULL) == 2*SAMPLE_COUNT);
+    CHECK(PollSoftKeyEvents(events, 8) == 1);
+
+    UnloadInputReplay();
+    CHECK(!IsInputReplayActive());
+
+    // Live input is back once unloaded
+    OnSoftKeyEvent(GetMockJNIEnv(), NULL, KEYCODE_A, 'b', 'B', startUptimeMillis);
+    CHECK(PollSoftKeyEvents(events, 8) == 1 && events[0].unicode == 'b');
+}
+
+static void TestInvalidRecordings(void)
+{
+    int size = 0;
+    unsigned char *data = ReadFromAppStorage("input.rmir", &size);
+    CHECK(data != NULL && size > INPUT_RECORD_HEADER_SIZE);
+    if (data == NULL) return;
+
+    // Truncated in the middle of a record, the complete ones are replayed
+    CHECK(WriteToAppStorage("truncated.rmir", data, size - 2));
+    CHECK(LoadInputReplay("truncated.rmir"));
+    CHECK(UpdateInputReplay(10.0f) == 2*SAMPLE_COUNT + 1);
+    CHECK(IsInputReplayFinished());
+
+    // Wrong version
+    data[4] = INPUT_RECORD_VERSION + 1;
+    CHECK(WriteToAppStorage("version.rmir", data, size));
+    CHECK(!LoadInputReplay("version.rmir"));
+    CHECK(!IsInputReplayActive());
+
+    CHECK(!LoadInputReplay("missing.rmir"));
+
+    RL_FREE(data);
+}
+
+static void *StreamSamples(void *arg)
+{
+    for (int i = 0; i < STREAM_COUNT; i++) {
+        RecordSample(SENSOR_MAGNETIC_FIELD, 2*i*SAMPLE_PERIOD_NS, (float)i, 0.0f, 0.0f);
+        if (i % STREAM_BATCH == STREAM_BATCH - 1) usleep(100000);   // Two drain periods
+    }
+    return NULL;
+}
+
+static void TestConcurrentRecording(void)
+{
+    // Sensor records come from their own thread while keys are recorded by another,
+    // none is lost and they are saved in timestamp order
+
+    CHECK(StartInputRecording("stream.rmir"));
+
+    pthread_t sensorThread;
+    pthread_create(&sensorThread, NULL, StreamSamples, NULL);
+
+    for (int i = 0; i < 10; i++) {
+        InputRecord key = { .kind = INPUT_RECORD_SOFT_KEY, .count = 3, .timestamp = (2*i + 1)*STREAM_BATCH*SAMPLE_PERIOD_NS };
+        RecordInput(&key);
+        usleep(10000);
+    }
+
+    pthread_join(sensorThread, NULL);
+    CHECK(StopInputRecording());
+
+    float values[16];
+    int before = GetMockReplayedSensorEvents(SENSOR_MAGNETIC_FIELD, NULL);
+
+    CHECK(LoadInputReplay("stream.rmir"));
+    CHECK(UpdateInputReplay(0.0f) == 1);
+    CHECK(UpdateInputReplay(1000.0f) == STREAM_COUNT + 10 - 1);
+    CHECK(GetMockReplayedSensorEvents(SENSOR_MAGNETIC_FIELD, values) - before == STREAM_COUNT);
+    CHECK(values[0] == (float)(STREAM_COUNT - 1));
+
+    UnloadInputReplay();
+}
+
+int main(void)
+{
+    if (!InitMockAndroid()) return 1;
+
+    SetTraceLogLevel(LOG_ERROR);
+
+    TestFormat();
+    TestRoundTrip();
+    TestInvalidRecordings();
+    TestConcurrentRecording();
+
+    return TEST_RESULT();
+}
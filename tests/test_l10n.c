@@ -0,0 +1,155 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks the loading of the packed "name\0value\0" strings into the L10N
+ * table, and their reload on locale changes while other threads read them.
+ */
+
+#include "raymob.h"
+#include "bridge.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define STRING_COUNT        2000
+#define LOCALE_CHANGES      50
+#define READER_COUNT        2
+
+static char *packedData = NULL;
+static int packedSize = 0;
+
+static bool readersDone = false;
+static int readerErrors = 0;
+
+static void PackStrings(const char *suffix)
+{
+    free(packedData);
+    packedData = malloc(STRING_COUNT*64);
+    packedSize = 0;
+
+    for (int i = 0; i < STRING_COUNT; i++) {
+        packedSize += sprintf(packedData + packedSize, "string_%d", i) + 1;
+        packedSize += sprintf(packedData + packedSize, "value %d %s", i, suffix) + 1;
+    }
+
+    SetMockPackedStrings(packedData, packedSize);
+}
+
+static void *ReadStrings(void *arg)
+{
+    char name[32];
+    char expected[2][64];
+    int i = 0;
+
+    while (!__atomic_load_n(&readersDone, __ATOMIC_ACQUIRE)) {
+        i = (i + 7)%STRING_COUNT;
+        sprintf(name, "string_%d", i);
+        sprintf(expected[0], "value %d en", i);
+        sprintf(expected[1], "value %d fr", i);
+
+        // Either locale is fine, a mix or a missing string is not
+        const char *value = LookupL10NString(name);
+
+        if (value == NULL || (strcmp(value, expected[0]) != 0 && strcmp(value, expected[1]) != 0)) {
+            __atomic_add_fetch(&readerErrors, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    if (!InitMockAndroid()) return 1;
+
+    PackStrings("en");
+
+    // Every string loaded with a single Java call
+
+    char name[32];
+    char expected[64];
+    int found = 0;
+
+    for (int i = 0; i < STRING_COUNT; i++) {
+        sprintf(name, "string_%d", i);
+        sprintf(expected, "value %d en", i);
+
+        const char *value = LookupL10NString(name);
+        if (value != NULL && strcmp(value, expected) == 0) found++;
+    }
+
+    CHECK(found == STRING_COUNT);
+    CHECK(GetMockMethodCalls("getPackedStrings") == 1);
+    CHECK(LookupL10NString("missing") == NULL);
+    CHECK(LookupL10NString(NULL) == NULL);
+
+    // Reloaded on a locale change, previous strings stay valid
+
+    const char *english = LookupL10NString("string_42");
+
+    PackStrings("fr");
+    OnLocaleChanged(GetMockJNIEnv(), NULL);
+
+    CHECK(strcmp(LookupL10NString("string_42"), "value 42 fr") == 0);
+    CHECK(strcmp(english, "value 42 en") == 0);
+    CHECK(GetMockMethodCalls("getPackedStrings") == 2);
+
+    // Empty values are valid, a trailing name without value is ignored
+
+    static const char edge[] = "empty\0\0name\0value\0dangling";
+    SetMockPackedStrings(edge, sizeof(edge) - 1);
+    OnLocaleChanged(GetMockJNIEnv(), NULL);
+
+    CHECK(LookupL10NString("empty") != NULL && LookupL10NString("empty")[0] == '\0');
+    CHECK(strcmp(LookupL10NString("name"), "value") == 0);
+    CHECK(LookupL10NString("dangling") == NULL);
+
+    // Locale changes while other threads read the strings
+
+    PackStrings("en");
+    OnLocaleChanged(GetMockJNIEnv(), NULL);
+    LookupL10NString("string_0");
+
+    pthread_t readers[READER_COUNT];
+    for (int i = 0; i < READER_COUNT; i++) pthread_create(&readers[i], NULL, ReadStrings, NULL);
+
+    for (int i = 0; i < LOCALE_CHANGES; i++) {
+        PackStrings((i%2 == 0) ? "fr" : "en");
+        OnLocaleChanged(GetMockJNIEnv(), NULL);
+        LookupL10NString("string_0");
+    }
+
+    __atomic_store_n(&readersDone, true, __ATOMIC_RELEASE);
+    for (int i = 0; i < READER_COUNT; i++) pthread_join(readers[i], NULL);
+
+    CHECK(readerErrors == 0);
+
+    free(packedData);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,144 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Runs frames through the drawing hooks of raymob.h (built with
+ * RAYMOB_PERFORMANCE_HINT) against the host stand-in of the performance hint
+ * session, and checks the durations it is given through its log.
+ */
+
+#include "raymob.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define FRAME_WORK_NS       2000000L
+#define FRAME_COUNT         10
+
+static struct {
+    int sessions;
+    int closes;
+    int reports;
+    int targets;
+    double lastActual;      // In ms
+    double lastTarget;      // In ms
+} Session = { 0 };
+
+static void ReadSessionLog(int logLevel, const char *text, va_list args)
+{
+    char message[256];
+    vsnprintf(message, sizeof(message), text, args);
+
+    int threads = 0;
+
+    if (sscanf(message, "RAYMOB: Performance hint session created (%d threads, target %lf ms)", &threads, &Session.lastTarget) == 2) Session.sessions++;
+    else if (sscanf(message, "RAYMOB: Performance hint actual %lf ms", &Session.lastActual) == 1) Session.reports++;
+    else if (sscanf(message, "RAYMOB: Performance hint target %lf ms", &Session.lastTarget) == 1) Session.targets++;
+    else if (strcmp(message, "RAYMOB: Performance hint session closed") == 0) Session.closes++;
+}
+
+static void DoFrameWork(void)
+{
+    struct timespec work = { 0, FRAME_WORK_NS };
+    nanosleep(&work, NULL);
+}
+
+static void RunFrame(void)
+{
+    // NOTE: Remapped to BeginHintedDrawing() and EndHintedDrawing()
+    BeginDrawing();
+    DoFrameWork();
+    EndDrawing();
+}
+
+int main(void)
+{
+    SetTraceLogLevel(LOG_DEBUG);
+    SetTraceLogCallback(ReadSessionLog);
+
+    // The session is opened by the first frame, at 60 FPS by default
+
+    CHECK(!IsPerformanceHintReady());
+    RunFrame();
+
+    CHECK(IsPerformanceHintReady());
+    CHECK(Session.sessions == 1 && Session.lastTarget > 16.66 && Session.lastTarget < 16.67);
+
+    // The raylib functions are still called once per frame, through the hooks
+    CHECK(GetMockDrawingCalls() == 2);
+
+    // Every frame reports its work, measured from the end of the previous one
+
+    for (int i = 0; i < FRAME_COUNT; i++) RunFrame();
+
+    CHECK(GetMockDrawingCalls() == 2*(FRAME_COUNT + 1));
+    CHECK(Session.reports == FRAME_COUNT + 1);
+    CHECK(Session.lastActual >= FRAME_WORK_NS*1e-6);
+    CHECK(Session.targets == 0);
+
+    // Target changes under 1% are not reported, larger ones once
+
+    SetPerformanceHintTarget(1.005f/60);
+    RunFrame();
+    CHECK(Session.targets == 0);
+
+    SetPerformanceHintTarget(1.0f/30);
+    RunFrame();
+    RunFrame();
+    CHECK(Session.targets == 1 && Session.lastTarget > 33.33 && Session.lastTarget < 33.34);
+
+    SetPerformanceHintTarget(0.0f);
+    RunFrame();
+    CHECK(Session.targets == 2 && Session.lastTarget > 16.66 && Session.lastTarget < 16.67);
+
+    // Frames measured by hand, only reported once started
+
+    int reports = Session.reports;
+
+    EndPerformanceHintFrame();
+    EndPerformanceHintFrame();
+    CHECK(Session.reports == reports + 1);
+
+    BeginPerformanceHintFrame();
+    DoFrameWork();
+    EndPerformanceHintFrame();
+    CHECK(Session.reports == reports + 2 && Session.lastActual >= FRAME_WORK_NS*1e-6);
+
+    // Nothing is reported once closed, the frames still go to raylib
+
+    ClosePerformanceHint();
+    CHECK(Session.closes == 1 && !IsPerformanceHintReady());
+
+    reports = Session.reports;
+    int drawingCalls = GetMockDrawingCalls();
+
+    RunFrame();
+    CHECK(Session.reports == reports);
+    CHECK(GetMockDrawingCalls() == drawingCalls + 2);
+
+    return TEST_RESULT();
+}
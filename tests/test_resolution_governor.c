@@ -0,0 +1,153 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Replays a synthetic frame time trace, with a light, a heavy and a light
+ * load again, and checks that the resolution governor meets the budget
+ * quickly, settles without oscillating and gives the resolution back.
+ */
+
+#include "resolution_governor.h"
+#include "test.h"
+
+#include <stdint.h>
+
+#define BUDGET              (1.0f/60)
+#define CPU_TIME            0.004f          // Frame time that does not depend on the scale
+#define NOISE_TIME          0.002f
+#define PHASE_FRAMES        2000
+#define CONVERGENCE_FRAMES  300             // Allowed to meet the budget after a load change
+
+typedef struct PhaseResult {
+    float scale;            // At the end of the phase
+    int changes;
+    int settledChanges;     // After the convergence frames
+    int settledOver;        // Frames over budget after the convergence frames
+} PhaseResult;
+
+static uint32_t randomState = 3;
+
+static float GetRandom(void)
+{
+    // NOTE: xorshift32, the trace must be the same on every host
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState/4294967296.0f;
+}
+
+// The render time follows the number of pixels, the square of the scale
+static PhaseResult RunPhase(Governor *governor, float gpuTime)
+{
+    PhaseResult result = { governor->scale };
+
+    for (int i = 0; i < PHASE_FRAMES; i++) {
+        float frameTime = CPU_TIME + gpuTime*result.scale*result.scale + GetRandom()*NOISE_TIME;
+        float scale = UpdateGovernor(governor, frameTime);
+
+        if (scale != result.scale) {
+            result.changes++;
+            if (i >= CONVERGENCE_FRAMES) result.settledChanges++;
+        }
+
+        if (i >= CONVERGENCE_FRAMES && frameTime > BUDGET) result.settledOver++;
+
+        result.scale = scale;
+    }
+
+    return result;
+}
+
+static void TestPercentile(void)
+{
+    const float frameTimes[] = { 5.0f, 1.0f, 3.0f, 2.0f, 4.0f };
+
+    CHECK(GetFrameTimePercentile(frameTimes, 5, 0.5f) == 3.0f);
+    CHECK(GetFrameTimePercentile(frameTimes, 5, 0.9f) == 5.0f);
+    CHECK(GetFrameTimePercentile(frameTimes, 5, 0.0f) == 1.0f);
+    CHECK(GetFrameTimePercentile(frameTimes, 5, 1.0f) == 5.0f);
+    CHECK(GetFrameTimePercentile(frameTimes, 1, 0.9f) == 5.0f);
+    CHECK(GetFrameTimePercentile(frameTimes, 0, 0.9f) == 0.0f);
+}
+
+static void TestTrace(void)
+{
+    Governor governor;
+    InitGovernor(&governor, GetDefaultGovernorConfig(0.5f, 1.0f, BUDGET));
+    CHECK(governor.scale == 1.0f);
+
+    // Fits the budget at full resolution, nothing to do
+
+    PhaseResult light = RunPhase(&governor, 0.008f);
+    CHECK(light.changes == 0 && light.scale == 1.0f);
+
+    // Nearly twice the budget, the scale goes down then holds still
+
+    PhaseResult heavy = RunPhase(&governor, 0.024f);
+
+    printf("Heavy load: scale %.3f after %d changes, %d changes and %d frames over budget once settled\n",
+           heavy.scale, heavy.changes, heavy.settledChanges, heavy.settledOver);
+
+    CHECK(heavy.scale > 0.5f && heavy.scale < 0.8f);
+    CHECK(heavy.settledChanges == 0);
+    CHECK(heavy.settledOver <= (PHASE_FRAMES - CONVERGENCE_FRAMES)/10);
+
+    // Light again, the full resolution comes back one step at a time, never going down
+
+    PhaseResult back = RunPhase(&governor, 0.008f);
+
+    printf("Light load again: scale %.3f after %d changes\n", back.scale, back.changes);
+
+    CHECK(back.scale == 1.0f);
+    CHECK(back.changes <= (int)((1.0f - heavy.scale)/governor.config.step) + 1);
+
+    // Out of reach, the scale stops at the minimum
+
+    PhaseResult overload = RunPhase(&governor, 0.100f);
+    CHECK(overload.scale == 0.5f);
+}
+
+static void TestNoBudget(void)
+{
+    Governor governor;
+    InitGovernor(&governor, GetDefaultGovernorConfig(0.5f, 1.0f, 0.0f));
+
+    for (int i = 0; i < PHASE_FRAMES; i++) CHECK(UpdateGovernor(&governor, 0.1f) == 1.0f);
+
+    // A minimum above the maximum is the maximum
+    InitGovernor(&governor, GetDefaultGovernorConfig(1.5f, 1.0f, BUDGET));
+    CHECK(governor.config.minScale == 1.0f);
+
+    for (int i = 0; i < PHASE_FRAMES; i++) CHECK(UpdateGovernor(&governor, 0.1f) == 1.0f);
+}
+
+int main(void)
+{
+    TestPercentile();
+    TestTrace();
+    TestNoBudget();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,119 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks the ring buffer on its own, then under a producer and a consumer
+ * thread pushing and popping batches of different sizes.
+ */
+
+#include "ring_buffer.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+#define STRESS_COUNT    1000000
+#define PUSH_BATCH      7
+#define POP_BATCH       13
+
+static RingBuffer stressRing;
+
+static void *Produce(void *arg)
+{
+    uint64_t batch[PUSH_BATCH];
+    uint64_t next = 0;
+
+    while (next < STRESS_COUNT) {
+        int count = 0;
+        while (count < PUSH_BATCH && next + count < STRESS_COUNT) {
+            batch[count] = next + count;
+            count++;
+        }
+
+        int pushed = PushRingBuffer(&stressRing, batch, count);
+        if (pushed == 0) sched_yield();     // Full, let the consumer run
+
+        next += pushed;
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    RingBuffer ring;
+
+    // Capacity rounded up to a power of two, nothing overwritten when full
+
+    CHECK(LoadRingBuffer(&ring, sizeof(int), 6));
+    CHECK(ring.mask + 1 == 8);
+
+    int values[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    int out[10] = { 0 };
+
+    CHECK(PushRingBuffer(&ring, values, 10) == 8);
+    CHECK(GetRingBufferCount(&ring) == 8);
+    CHECK(PushRingBuffer(&ring, values, 1) == 0);
+
+    CHECK(PopRingBuffer(&ring, out, 3) == 3);
+    CHECK(out[0] == 0 && out[1] == 1 && out[2] == 2);
+
+    // Wraps around the end of the storage
+    CHECK(PushRingBuffer(&ring, values + 8, 2) == 2);
+    CHECK(PopRingBuffer(&ring, out, 10) == 7);
+    CHECK(out[0] == 3 && out[4] == 7 && out[5] == 8 && out[6] == 9);
+    CHECK(GetRingBufferCount(&ring) == 0 && PopRingBuffer(&ring, out, 10) == 0);
+
+    UnloadRingBuffer(&ring);
+
+    // Concurrent producer and consumer, every element comes out once and in order
+
+    CHECK(LoadRingBuffer(&stressRing, sizeof(uint64_t), 1000));
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, Produce, NULL);
+
+    uint64_t batch[POP_BATCH];
+    uint64_t expected = 0;
+    bool ordered = true;
+
+    while (expected < STRESS_COUNT && ordered) {
+        int count = PopRingBuffer(&stressRing, batch, POP_BATCH);
+        if (count == 0) sched_yield();
+        for (int i = 0; i < count; i++) {
+            if (batch[i] != expected++) ordered = false;
+        }
+    }
+
+    pthread_join(producer, NULL);
+
+    CHECK(ordered && expected == STRESS_COUNT);
+    CHECK(GetRingBufferCount(&stressRing) == 0);
+
+    UnloadRingBuffer(&stressRing);
+
+    return TEST_RESULT();
+}
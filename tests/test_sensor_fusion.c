@@ -0,0 +1,258 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Regression test of the sensor fusion against a synthetic recording: a
+ * device tumbling along a known path, sampled at 200Hz with sensor noise,
+ * the fused orientation must follow the true one. Then measures the
+ * throughput of the filter.
+ *
+ *     test_sensor_fusion [benchmark samples]
+ */
+
+#include "sensor_fusion.h"
+#include "test.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define GRAVITY             9.80665f
+#define SAMPLE_PERIOD_NS    5000000LL       // 200Hz, a common game sensor rate
+#define TRACE_SECONDS       60
+#define TRUTH_SUBSTEPS      10              // Integration steps of the true path per sample
+
+#define MAX_TILT_ERROR      2.0f            // Degrees, once converged
+#define MAX_HEADING_DRIFT   3.0f            // Degrees, the accelerometer cannot correct it
+
+typedef struct Quat { float w, x, y, z; } Quat;
+
+static uint32_t randomState = 12345;
+
+/* HELPERS */
+
+static float GetNoise(float amplitude)
+{
+    // xorshift32, deterministic across hosts
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return amplitude*((float)(randomState & 0xFFFF)/32767.5f - 1.0f);
+}
+
+static Quat MultiplyQuat(Quat a, Quat b)
+{
+    return (Quat){
+        a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z,
+        a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
+        a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x,
+        a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w
+    };
+}
+
+static Quat NormalizeQuat(Quat q)
+{
+    float n = sqrtf(q.w*q.w + q.x*q.x + q.y*q.y + q.z*q.z);
+    return (Quat){ q.w/n, q.x/n, q.y/n, q.z/n };
+}
+
+// Rotates an earth frame vector into the device frame
+static void RotateToDevice(Quat q, const float in[3], float out[3])
+{
+    Quat conj = { q.w, -q.x, -q.y, -q.z };
+    Quat v = MultiplyQuat(MultiplyQuat(conj, (Quat){ 0.0f, in[0], in[1], in[2] }), q);
+
+    out[0] = v.x;
+    out[1] = v.y;
+    out[2] = v.z;
+}
+
+static float GetAngleBetween(Quat a, Quat b)
+{
+    float dot = fabsf(a.w*b.w + a.x*b.x + a.y*b.y + a.z*b.z);
+    if (dot > 1.0f) dot = 1.0f;
+    return 2.0f*acosf(dot)*180.0f/(float)M_PI;
+}
+
+// Rotation taking the true orientation to the estimated one, in the earth frame
+static Quat GetOffset(Quat estimate, Quat truth)
+{
+    return MultiplyQuat(estimate, (Quat){ truth.w, -truth.x, -truth.y, -truth.z });
+}
+
+static float GetTiltError(Quat estimate, Quat truth)
+{
+    const float up[3] = { 0.0f, 0.0f, 1.0f };
+    float a[3], b[3];
+
+    RotateToDevice(estimate, up, a);
+    RotateToDevice(truth, up, b);
+
+    float dot = a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    if (dot > 1.0f) dot = 1.0f;
+    return acosf(dot)*180.0f/(float)M_PI;
+}
+
+// Angular velocity of the recorded path in the device frame, in rad/s
+static void GetTrueRate(double t, float rate[3])
+{
+    rate[0] = 0.6f*sinf((float)(0.9*t));
+    rate[1] = 0.4f*cosf((float)(0.5*t));
+    rate[2] = 0.3f*sinf((float)(0.3*t) + 1.0f);
+}
+
+/* TESTS */
+
+static void TestTrace(void)
+{
+    FusionState fusion;
+    InitFusion(&fusion, FUSION_DEFAULT_BETA);
+
+    // Starts tilted, the filter has to find the gravity first
+    Quat truth = NormalizeQuat((Quat){ 0.9f, 0.3f, -0.2f, 0.1f });
+    int64_t timestamp = 1000000000LL;
+
+    float maxTilt = 0.0f;
+    float maxLinear = 0.0f;
+    Quat convergedOffset = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+    int samples = TRACE_SECONDS*(int)(1000000000LL/SAMPLE_PERIOD_NS);
+
+    for (int i = 0; i < samples; i++) {
+        double t = (double)i*SAMPLE_PERIOD_NS*1e-9;
+
+        // True path, integrated finer than the sensor rate
+        for (int s = 0; s < TRUTH_SUBSTEPS; s++) {
+            float rate[3];
+            GetTrueRate(t + (double)s*SAMPLE_PERIOD_NS*1e-9/TRUTH_SUBSTEPS, rate);
+
+            float dt = (float)(SAMPLE_PERIOD_NS*1e-9/TRUTH_SUBSTEPS);
+            Quat spin = MultiplyQuat(truth, (Quat){ 0.0f, rate[0], rate[1], rate[2] });
+
+            truth.w += 0.5f*spin.w*dt;
+            truth.x += 0.5f*spin.x*dt;
+            truth.y += 0.5f*spin.y*dt;
+            truth.z += 0.5f*spin.z*dt;
+            truth = NormalizeQuat(truth);
+        }
+
+        // Noisy samples, as the sensors would report them
+        const float gravity[3] = { 0.0f, 0.0f, GRAVITY };
+        float accel[3], rate[3];
+
+        RotateToDevice(truth, gravity, accel);
+        GetTrueRate(t + SAMPLE_PERIOD_NS*1e-9, rate);
+
+        UpdateFusionAccel(&fusion, accel[0] + GetNoise(0.05f), accel[1] + GetNoise(0.05f), accel[2] + GetNoise(0.05f));
+        UpdateFusionGyro(&fusion, timestamp, rate[0] + GetNoise(0.005f), rate[1] + GetNoise(0.005f), rate[2] + GetNoise(0.005f));
+        timestamp += SAMPLE_PERIOD_NS;
+
+        // Checked once converged, the initial heading is never found
+        // since the accelerometer cannot see it, only its drift is checked
+        Quat estimate = { fusion.q[0], fusion.q[1], fusion.q[2], fusion.q[3] };
+
+        if (i == 5*(int)(1000000000LL/SAMPLE_PERIOD_NS)) convergedOffset = GetOffset(estimate, truth);
+
+        if (t >= 5.0) {
+            float tilt = GetTiltError(estimate, truth);
+            if (tilt > maxTilt) maxTilt = tilt;
+
+            float linear[3];
+            GetFusionLinearAccel(&fusion, linear);
+
+            float norm = sqrtf(linear[0]*linear[0] + linear[1]*linear[1] + linear[2]*linear[2]);
+            if (norm > maxLinear) maxLinear = norm;
+        }
+    }
+
+    Quat estimate = { fusion.q[0], fusion.q[1], fusion.q[2], fusion.q[3] };
+    float drift = GetAngleBetween(GetOffset(estimate, truth), convergedOffset);
+
+    printf("Trace of %d s: max tilt error %.2f deg, heading drift %.2f deg, max linear accel %.3f m/s^2\n",
+           TRACE_SECONDS, maxTilt, drift, maxLinear);
+
+    CHECK(maxTilt < MAX_TILT_ERROR);
+    CHECK(drift < MAX_HEADING_DRIFT);
+    CHECK(maxLinear < 0.5f);
+}
+
+static void TestGyroIntegration(void)
+{
+    FusionState fusion;
+    InitFusion(&fusion, 0.0f);
+
+    // One second at 1 rad/s around Z, lying flat
+    int64_t timestamp = 1;
+
+    for (int i = 0; i <= 200; i++) {
+        UpdateFusionAccel(&fusion, 0.0f, 0.0f, GRAVITY);
+        UpdateFusionGyro(&fusion, timestamp, 0.0f, 0.0f, 1.0f);
+        timestamp += SAMPLE_PERIOD_NS;
+    }
+
+    float yaw = 2.0f*atan2f(fusion.q[3], fusion.q[0]);
+    CHECK(fabsf(yaw - 1.0f) < 0.01f);
+
+    // Gaps between samples (e.g. a paused sensor) must not be integrated
+    UpdateFusionGyro(&fusion, timestamp + 10000000000LL, 0.0f, 0.0f, 1.0f);
+    CHECK(fabsf(2.0f*atan2f(fusion.q[3], fusion.q[0]) - yaw) < 0.1f);
+}
+
+static void BenchThroughput(int samples)
+{
+    FusionState fusion;
+    InitFusion(&fusion, FUSION_DEFAULT_BETA);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int64_t timestamp = 1;
+
+    for (int i = 0; i < samples; i++) {
+        UpdateFusionAccel(&fusion, 0.1f, 0.2f*(i & 1), GRAVITY);
+        UpdateFusionGyro(&fusion, timestamp, 0.01f, -0.02f, 0.03f*(i & 3));
+        timestamp += SAMPLE_PERIOD_NS;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec)*1e-9;
+
+    printf("Throughput: %.1f M samples/s (%.1f ns per accel + gyro update)\n",
+           samples/seconds*1e-6, seconds*1e9/samples);
+
+    CHECK(isfinite(fusion.q[0]) && isfinite(fusion.q[1]) && isfinite(fusion.q[2]) && isfinite(fusion.q[3]));
+}
+
+int main(int argc, char **argv)
+{
+    int samples = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    TestTrace();
+    TestGyroIntegration();
+    BenchThroughput((samples > 0) ? samples : 1);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,80 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks the resolution of the sampling period and batch latency against
+ * the limits reported by a sensor, for the usual kinds of sensors.
+ */
+
+#include "sensor_rate.h"
+#include "test.h"
+
+static SensorLimits Limits(int minDelayUs, int fifoMax, int fifoReserved, int bufferCapacity)
+{
+    return (SensorLimits){ minDelayUs, fifoMax, fifoReserved, bufferCapacity };
+}
+
+static bool IsRate(SensorRate rate, int samplingPeriodUs, int64_t maxBatchLatencyUs)
+{
+    return rate.samplingPeriodUs == samplingPeriodUs && rate.maxBatchLatencyUs == maxBatchLatencyUs;
+}
+
+int main(void)
+{
+    // Sampling period, defaulted and clamped to the fastest supported one
+
+    SensorLimits imu = Limits(2500, 3000, 600, 256);
+
+    CHECK(ResolveSensorRate(imu, 0, 0).samplingPeriodUs == SENSOR_DEFAULT_PERIOD_US);
+    CHECK(ResolveSensorRate(imu, -1, 0).samplingPeriodUs == SENSOR_DEFAULT_PERIOD_US);
+    CHECK(ResolveSensorRate(imu, 1000, 0).samplingPeriodUs == 2500);
+    CHECK(ResolveSensorRate(imu, 5000, 0).samplingPeriodUs == 5000);
+
+    // On change sensors report no minimum delay, any period is kept
+    CHECK(ResolveSensorRate(Limits(0, 0, 0, 256), 100, 0).samplingPeriodUs == 100);
+
+    // Batch latency, limited by the reserved part of the FIFO and by the ring
+
+    CHECK(IsRate(ResolveSensorRate(Limits(2500, 3000, 600, 1024), 5000, 10000000), 5000, 600*5000LL));
+    CHECK(IsRate(ResolveSensorRate(imu, 5000, 10000000), 5000, 256*5000LL));
+    CHECK(IsRate(ResolveSensorRate(imu, 5000, 100000), 5000, 100000));
+
+    // The whole FIFO is relied upon when nothing is reserved, still within the ring
+    CHECK(IsRate(ResolveSensorRate(Limits(2500, 3000, 0, 1024), 5000, 10000000), 5000, 1024*5000LL));
+    CHECK(IsRate(ResolveSensorRate(Limits(2500, 300, 0, 1024), 5000, 10000000), 5000, 300*5000LL));
+    CHECK(IsRate(ResolveSensorRate(Limits(2500, 300, 0, 0), 5000, 10000000), 5000, 300*5000LL));
+
+    // The limit follows the clamped period, not the requested one
+    CHECK(IsRate(ResolveSensorRate(Limits(10000, 100, 100, 1024), 1000, 10000000), 10000, 100*10000LL));
+
+    // Without a FIFO, or without batching asked, events are delivered right away
+
+    CHECK(IsRate(ResolveSensorRate(Limits(2500, 0, 0, 256), 5000, 1000000), 5000, 0));
+    CHECK(IsRate(ResolveSensorRate(Limits(2500, 0, 100, 256), 5000, 1000000), 5000, 0));
+    CHECK(IsRate(ResolveSensorRate(imu, 5000, 0), 5000, 0));
+    CHECK(IsRate(ResolveSensorRate(imu, 5000, -1), 5000, 0));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,127 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+
+/*
+ * Checks the seqlock shared by the sensor and display state: a reader never
+ * sees a torn block while a writer keeps publishing, including when the
+ * writer is stopped mid-write long enough for the reader to yield.
+ */
+
+#include "seqlock.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define VALUE_COUNT     8
+#define WRITE_COUNT     200000
+
+static uint32_t sequence = 0;
+static int32_t values[VALUE_COUNT] = { 0 };
+static bool writing = true;
+
+static void Publish(int32_t value)
+{
+    uint32_t current = BeginSeqlockWrite(&sequence);
+    for (int i = 0; i < VALUE_COUNT; i++) __atomic_store_n(&values[i], value, __ATOMIC_RELAXED);
+    EndSeqlockWrite(&sequence, current);
+}
+
+static uint32_t Read(int32_t *out)
+{
+    uint32_t current = 0;
+    do {
+        current = BeginSeqlockRead(&sequence);
+        for (int i = 0; i < VALUE_COUNT; i++) out[i] = __atomic_load_n(&values[i], __ATOMIC_RELAXED);
+    } while (!EndSeqlockRead(&sequence, current));
+    return current;
+}
+
+static void *Write(void *arg)
+{
+    for (int32_t value = 1; value <= WRITE_COUNT; value++) Publish(value);
+    __atomic_store_n(&writing, false, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *WriteSlowly(void *arg)
+{
+    // Stays odd well past SEQLOCK_SPIN_LIMIT reads, the reader has to yield to let it finish
+    uint32_t current = BeginSeqlockWrite(&sequence);
+    for (int i = 0; i < VALUE_COUNT; i++) {
+        __atomic_store_n(&values[i], -1, __ATOMIC_RELAXED);
+        usleep(1000);
+    }
+    EndSeqlockWrite(&sequence, current);
+    return NULL;
+}
+
+int main(void)
+{
+    int32_t out[VALUE_COUNT] = { 0 };
+
+    // Single thread, the sequence advances by two per write and stays even
+
+    CHECK(Read(out) == 0 && out[0] == 0);
+    Publish(7);
+    CHECK(Read(out) == 2 && out[0] == 7 && out[VALUE_COUNT - 1] == 7);
+
+    // Concurrent writer, every copy holds a single write and they never go back
+
+    pthread_t writer;
+    pthread_create(&writer, NULL, Write, NULL);
+
+    bool consistent = true;
+    int32_t last = 0;
+
+    while (__atomic_load_n(&writing, __ATOMIC_ACQUIRE) && consistent) {
+        Read(out);
+        for (int i = 1; i < VALUE_COUNT; i++) {
+            if (out[i] != out[0]) consistent = false;
+        }
+        if (out[0] < last) consistent = false;
+        last = out[0];
+    }
+
+    pthread_join(writer, NULL);
+
+    CHECK(consistent);
+    CHECK(Read(out) == 2 + 2*WRITE_COUNT && out[0] == WRITE_COUNT);
+
+    // Writer stalled mid-write, the reader waits for the complete block
+
+    pthread_create(&writer, NULL, WriteSlowly, NULL);
+    while ((__atomic_load_n(&sequence, __ATOMIC_ACQUIRE) & 1) == 0) sched_yield();
+
+    CHECK(Read(out) == 4 + 2*WRITE_COUNT);
+    CHECK(out[0] == -1 && out[VALUE_COUNT - 1] == -1);
+
+    pthread_join(writer, NULL);
+
+    return TEST_RESULT();
+}
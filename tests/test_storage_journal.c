@@ -0,0 +1,112 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+
+/*
+ * Checks the storage journal: writes of the same file are coalesced into a
+ * single disk write, a failed write stays journaled for the next flush, and
+ * the journal is flushed when the game thread handles APP_CMD_PAUSE, without
+ * InitCallBacks().
+ */
+
+#include "raymob.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static int failedWrites = 0;        // Atomic, the pause flush logs from the journal thread
+
+static void CountFailedWrites(int logLevel, const char *text, va_list args)
+{
+    char message[512];
+    vsnprintf(message, sizeof(message), text, args);
+
+    if (strstr(message, "Failed to open file") != NULL) __atomic_add_fetch(&failedWrites, 1, __ATOMIC_RELAXED);
+}
+
+static bool CheckContent(const char *filepath, const char *expected)
+{
+    int size = 0;
+    char *data = ReadFromAppStorage(filepath, &size);
+    bool matches = (data != NULL) && (size == (int)strlen(expected)) && (memcmp(data, expected, size) == 0);
+
+    RL_FREE(data);
+
+    return matches;
+}
+
+int main(void)
+{
+    if (!InitMockAndroid()) return 1;
+
+    SetTraceLogLevel(LOG_WARNING);
+    SetTraceLogCallback(CountFailedWrites);
+
+    // Coalesced, the directory is missing so the single pending write fails once
+
+    CHECK(WriteToAppStorageJournaled("saves/slot.sav", "first", 5));
+    CHECK(WriteToAppStorageJournaled("saves/slot.sav", "second", 6));
+    CHECK(!IsFileExistsInAppStorage("saves/slot.sav"));
+
+    CHECK(!FlushStorageJournal());
+    CHECK(__atomic_load_n(&failedWrites, __ATOMIC_RELAXED) == 1);
+
+    // Requeued, retried by the next flush with the latest content
+
+    CHECK(!FlushStorageJournal());
+    CHECK(__atomic_load_n(&failedWrites, __ATOMIC_RELAXED) == 2);
+
+    char directory[512];
+    snprintf(directory, sizeof(directory), "%s/saves", GetMockStorageDir());
+    CHECK(mkdir(directory, 0700) == 0);
+
+    CHECK(FlushStorageJournal());
+    CHECK(CheckContent("saves/slot.sav", "second"));
+
+    // Nothing left once written
+
+    CHECK(FlushStorageJournal());
+    CHECK(__atomic_load_n(&failedWrites, __ATOMIC_RELAXED) == 2);
+
+    // Flushed by the pause command, the journal installed its handler
+
+    struct android_app *app = GetAndroidApp();
+
+    CHECK(WriteToAppStorageJournaled("pause.sav", "paused", 6));
+    CHECK(!IsFileExistsInAppStorage("pause.sav"));
+    CHECK(app->onAppCmd != NULL);
+
+    app->onAppCmd(app, APP_CMD_RESUME);
+    CHECK(!IsFileExistsInAppStorage("pause.sav"));
+
+    app->onAppCmd(app, APP_CMD_PAUSE);
+    CHECK(CheckContent("pause.sav", "paused"));
+    CHECK(__atomic_load_n(&failedWrites, __ATOMIC_RELAXED) == 2);
+
+    return TEST_RESULT();
+}
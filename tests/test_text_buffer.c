@@ -0,0 +1,177 @@
+/*
+ *  raymob License (MIT)
+ *
+ *  Copyright (c) 2023-2024 Le Juez Victor
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+/*
+ * Checks the editing of a TextBuffer at code point boundaries, directly and
+ * from the key events and input method text pushed by the Java side.
+ */
+
+#include "raymob.h"
+#include "bridge.h"
+#include "mock/android.h"
+#include "test.h"
+
+#include <string.h>
+
+#define KEYCODE_A               29
+#define KEYCODE_DPAD_LEFT       21
+#define KEYCODE_ENTER           66
+#define KEYCODE_DEL             67
+#define KEYCODE_MOVE_END        123
+
+#define EMOJI                   "\xF0\x9F\x98\x80"      // U+1F600, a surrogate pair in UTF-16
+
+#define LONG_TEXT_SIZE          100000
+
+static bool IsText(TextBuffer *buffer, const char *text)
+{
+    return strcmp(GetTextBufferText(buffer), text) == 0 && GetTextBufferLength(buffer) == strlen(text);
+}
+
+static void PushKey(int keyCode, int unicode)
+{
+    OnSoftKeyEvent(GetMockJNIEnv(), NULL, keyCode, unicode, (jchar)unicode, 0);
+}
+
+static void PushCommittedText(const char *text)
+{
+    OnSoftTextInput(GetMockJNIEnv(), NULL, NewMockByteArray(text, (int)strlen(text)), NULL);
+}
+
+static void TestEditing(void)
+{
+    TextBuffer *buffer = LoadTextBuffer("h\xC3\xA9llo");     // "héllo"
+
+    CHECK(GetTextBufferLength(buffer) == 6 && GetTextBufferCursor(buffer) == 6);
+
+    // The cursor moves by code points, and snaps to their start
+
+    MoveTextBufferCursor(buffer, -4, false);
+    CHECK(GetTextBufferCursor(buffer) == 1);
+    MoveTextBufferCursor(buffer, 1, false);
+    CHECK(GetTextBufferCursor(buffer) == 3);
+    SetTextBufferCursor(buffer, 2, false);
+    CHECK(GetTextBufferCursor(buffer) == 1);
+
+    // Multi-byte code points are inserted and deleted whole
+
+    CHECK(InsertTextBufferCodepoint(buffer, 0x1F600));
+    CHECK(IsText(buffer, "h" EMOJI "\xC3\xA9llo"));
+    CHECK(DeleteTextBufferBackward(buffer));
+    CHECK(IsText(buffer, "h\xC3\xA9llo"));
+    CHECK(DeleteTextBufferForward(buffer));
+    CHECK(IsText(buffer, "hllo"));
+
+    CHECK(!InsertTextBufferCodepoint(buffer, 0xD800));
+    CHECK(!InsertTextBufferCodepoint(buffer, 0x110000));
+
+    // Selections in any direction are replaced by the inserted text
+
+    size_t start = 0, end = 0;
+    SelectTextBufferRange(buffer, 4, 1);
+    CHECK(GetTextBufferSelection(buffer, &start, &end) && start == 1 && end == 4);
+    CHECK(InsertTextBufferString(buffer, "\xCE\xA9\xCE\xA9"));     // "ΩΩ"
+    CHECK(IsText(buffer, "h\xCE\xA9\xCE\xA9"));
+    CHECK(!GetTextBufferSelection(buffer, NULL, NULL));
+
+    // Nothing left to delete at the ends
+
+    SetTextBufferCursor(buffer, 0, false);
+    CHECK(!DeleteTextBufferBackward(buffer));
+    while (DeleteTextBufferForward(buffer));
+    CHECK(IsText(buffer, ""));
+
+    UnloadTextBuffer(buffer);
+
+    // Growing far beyond the initial capacity, with edits on both sides of the gap
+
+    buffer = LoadTextBuffer(NULL);
+    for (int i = 0; i < LONG_TEXT_SIZE/2; i++) InsertTextBufferCodepoint(buffer, 0x3B1 + i%8);
+
+    SetTextBufferCursor(buffer, LONG_TEXT_SIZE/2, false);
+    CHECK(InsertTextBufferString(buffer, "|"));
+    SetTextBufferCursor(buffer, 1, false);
+    CHECK(GetTextBufferCursor(buffer) == 0);
+
+    const char *text = GetTextBufferText(buffer);
+    CHECK(GetTextBufferLength(buffer) == LONG_TEXT_SIZE + 1);
+    CHECK(strlen(text) == LONG_TEXT_SIZE + 1 && text[LONG_TEXT_SIZE/2] == '|');
+
+    UnloadTextBuffer(buffer);
+}
+
+static void TestSoftKeyboard(void)
+{
+    TextBuffer *buffer = LoadTextBuffer("h\xCE\xA9\xCE\xA9");
+
+    // Key events, from a hardware keyboard or a simple input method
+
+    PushKey(KEYCODE_DEL, 0);
+    PushKey(KEYCODE_DPAD_LEFT, 0);
+    PushKey(KEYCODE_A, 'x');
+    PushKey(KEYCODE_MOVE_END, 0);
+    PushKey(KEYCODE_ENTER, '\n');
+
+    CHECK(SoftKeyboardEditTextBuffer(buffer));
+    CHECK(IsText(buffer, "hx\xCE\xA9\n"));
+    CHECK(!SoftKeyboardEditTextBuffer(buffer));
+
+    // Input method text, where deletions are counted in UTF-16 units
+
+    SetTextBufferCursor(buffer, 1, false);
+    PushCommittedText("ab\b\bcd\x7f");
+
+    CHECK(SoftKeyboardEditTextBuffer(buffer));
+    CHECK(IsText(buffer, "hcd\xCE\xA9\n"));
+
+    UnloadTextBuffer(buffer);
+
+    buffer = LoadTextBuffer("xa" EMOJI);
+
+    PushCommittedText("\b\b");
+    CHECK(SoftKeyboardEditTextBuffer(buffer));
+    CHECK(IsText(buffer, "xa"));
+
+    PushCommittedText(EMOJI "b\b\b\b");
+    CHECK(SoftKeyboardEditTextBuffer(buffer));
+    CHECK(IsText(buffer, "xa"));
+
+    SetTextBufferCursor(buffer, 0, false);
+    PushCommittedText("\x7f");
+    CHECK(SoftKeyboardEditTextBuffer(buffer));
+    CHECK(IsText(buffer, "a"));
+
+    UnloadTextBuffer(buffer);
+}
+
+int main(void)
+{
+    if (!InitMockAndroid()) return 1;
+
+    TestEditing();
+    TestSoftKeyboard();
+
+    return TEST_RESULT();
+}